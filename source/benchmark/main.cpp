@@ -0,0 +1,168 @@
+/*
+ * Headless evaluation benchmark.
+ *
+ * Loads the plugins like mindTree --test does, without a Qt application
+ * or GL context, builds synthetic node networks and measures how long
+ * their evaluation takes. Run it from the bin directory so the plugins
+ * are found.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "source/data/python/init.h"
+#include "data/cache_main.h"
+#include "data/profiler.h"
+#include "data/project.h"
+#include "data/properties.h"
+#include "data/python/pyutils.h"
+#include "data/reloadable.h"
+
+#include "runner.h"
+#include "scenarios.h"
+
+using namespace MindTree;
+using namespace MindTree::Benchmarks;
+
+namespace
+{
+void printUsage(const char *program)
+{
+    std::cout << "usage: " << program << " [options] [scenario ...]\n"
+              << "\n"
+              << "  --list              list the scenarios and exit\n"
+              << "  --scale N           grow graphs and meshes by N (1)\n"
+              << "  --warmup N          untimed evaluations per scenario (3)\n"
+              << "  --iterations N      minimum timed evaluations (10)\n"
+              << "  --max-iterations N  maximum timed evaluations (1000)\n"
+              << "  --min-time S        minimum seconds per scenario (0.5)\n"
+              << "  --parallel          evaluate node inputs in parallel\n"
+              << "  --json FILE         write the results as JSON\n"
+              << "  --trace FILE        write a Chrome trace of one extra, untimed\n"
+              << "                      evaluation per scenario\n"
+              << std::endl;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    RunnerOptions options;
+    int scale = 1;
+    bool list = false;
+    bool parallel = false;
+    std::string jsonPath, tracePath;
+    std::vector<std::string> selected;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if(arg == "--list") list = true;
+        else if(arg == "--parallel") parallel = true;
+        else if(arg == "--scale" && hasValue) scale = std::max(std::atoi(argv[++i]), 1);
+        else if(arg == "--warmup" && hasValue) options.warmup = std::atoi(argv[++i]);
+        else if(arg == "--iterations" && hasValue) options.minIterations = std::atoi(argv[++i]);
+        else if(arg == "--max-iterations" && hasValue) options.maxIterations = std::atoi(argv[++i]);
+        else if(arg == "--min-time" && hasValue) options.minTime = std::atof(argv[++i]);
+        else if(arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if(arg == "--trace" && hasValue) tracePath = argv[++i];
+        else if(arg.compare(0, 2, "--") == 0) {
+            std::cout << "unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        else selected.push_back(arg);
+    }
+    options.maxIterations = std::max(options.maxIterations, options.minIterations);
+
+    DataCache::init();
+    Project::create();
+    Python::init(argc, argv);
+    Python::loadIntern();
+    Python::loadPlugins();
+    PropertyConverter::freeze();
+
+    //the processor libraries are loaded once up front, watching them
+    //would load them in the background while scenarios already run
+    HotProcessorManager::load();
+
+    std::vector<Result> results;
+    bool valid = true;
+    {
+        ScenarioList scenarios = createScenarios(scale);
+
+        if(list) {
+            for(const auto &scenario : scenarios)
+                std::cout << scenario.name << ": " << scenario.description << "\n";
+        }
+        else {
+            DataCache::setParallelEvaluation(parallel);
+
+            for(const auto &scenario : scenarios) {
+                if(!selected.empty()
+                   && std::find(begin(selected), end(selected), scenario.name) == end(selected))
+                    continue;
+
+                std::cout << "running " << scenario.name << ": "
+                    << scenario.description << std::endl;
+                results.push_back(run(scenario, options));
+
+                //a scenario without output measured nothing, most likely
+                //its processors are missing
+                if(!results.back().valid) {
+                    std::cout << scenario.name << " did not produce any output" << std::endl;
+                    valid = false;
+                    break;
+                }
+
+                //profiling slows evaluation down, the trace is taken
+                //from an extra evaluation after the measured ones
+                if(!tracePath.empty()) {
+                    EvaluationProfiler::setEnabled(true);
+                    scenario.invalidate();
+                    scenario.evaluate();
+                    EvaluationProfiler::setEnabled(false);
+                }
+            }
+        }
+
+        //nodes hold python wrappers
+        Python::GILLocker locker;
+        scenarios.clear();
+    }
+
+    if(!valid) {
+        Python::finalize();
+        return 1;
+    }
+
+    if(!results.empty()) {
+        std::cout << std::endl;
+        writeText(std::cout, results);
+    }
+
+    bool success = true;
+    if(!jsonPath.empty()) {
+        std::ofstream stream(jsonPath);
+        writeJSON(stream, results);
+        if(!stream) {
+            std::cout << "could not write " << jsonPath << std::endl;
+            success = false;
+        }
+    }
+
+    if(!tracePath.empty() && !EvaluationProfiler::writeTrace(tracePath)) {
+        std::cout << "could not write " << tracePath << std::endl;
+        success = false;
+    }
+
+    Python::finalize();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+#include "data/benchmark.h"
+
+#include "runner.h"
+
+using namespace MindTree;
+using namespace MindTree::Benchmarks;
+
+namespace
+{
+//nearest rank on sorted samples
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if(sorted.empty()) return 0;
+    size_t rank = size_t(std::ceil(p / 100. * sorted.size()));
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+double median(const std::vector<double> &sorted)
+{
+    if(sorted.empty()) return 0;
+    size_t half = sorted.size() / 2;
+    if(sorted.size() % 2) return sorted[half];
+    return (sorted[half - 1] + sorted[half]) / 2;
+}
+}
+
+Result MindTree::Benchmarks::run(const Scenario &scenario, const RunnerOptions &options)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Result result;
+    result.name = scenario.name;
+    result.description = scenario.description;
+    result.unit = scenario.unit;
+    result.items = scenario.items;
+
+    for(int i = 0; i < options.warmup; ++i) {
+        scenario.invalidate();
+        scenario.evaluate();
+    }
+
+    //every evaluation is checked, a graph that stopped producing output
+    //would otherwise look very fast
+    result.valid = true;
+    std::vector<double> samples;
+    samples.reserve(options.minIterations);
+    auto measureStart = Clock::now();
+    auto benchmark = Benchmark::get("Benchmark." + scenario.name);
+    while(int(samples.size()) < options.maxIterations) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - measureStart).count();
+        if(int(samples.size()) >= options.minIterations && elapsed >= options.minTime)
+            break;
+
+        scenario.invalidate();
+        auto start = Clock::now();
+        Property output;
+        {
+            BenchmarkHandler handler(benchmark);
+            output = scenario.evaluate();
+        }
+        auto end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        result.valid = result.valid && output;
+    }
+
+    std::sort(begin(samples), end(samples));
+    result.iterations = samples.size();
+    if(samples.empty()) return result;
+
+    result.min = samples.front();
+    result.max = samples.back();
+    result.mean = std::accumulate(begin(samples), end(samples), 0.) / samples.size();
+    result.median = median(samples);
+    result.p90 = percentile(samples, 90);
+    result.p99 = percentile(samples, 99);
+
+    double variance = 0;
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for(double sample : samples) {
+        variance += (sample - result.mean) * (sample - result.mean);
+        deviations.push_back(std::abs(sample - result.median));
+    }
+    result.stddev = std::sqrt(variance / samples.size());
+    std::sort(begin(deviations), end(deviations));
+    result.mad = median(deviations);
+
+    if(result.median > 0)
+        result.throughput = result.items / (result.median / 1000.);
+
+    return result;
+}
+
+void MindTree::Benchmarks::writeText(std::ostream &stream, const std::vector<Result> &results)
+{
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+
+    stream << std::left << std::setw(16) << "scenario"
+           << std::right << std::setw(8) << "runs"
+           << std::setw(12) << "median ms"
+           << std::setw(10) << "+-mad %"
+           << std::setw(12) << "min ms"
+           << std::setw(12) << "p90 ms"
+           << std::setw(12) << "p99 ms"
+           << std::setw(16) << "throughput/s"
+           << "  unit\n";
+
+    stream << std::fixed << std::setprecision(3);
+    for(const auto &result : results) {
+        double spread = result.median > 0 ? 100. * result.mad / result.median : 0;
+        stream << std::left << std::setw(16) << result.name
+               << std::right << std::setw(8) << result.iterations
+               << std::setw(12) << result.median
+               << std::setw(10) << std::setprecision(1) << spread
+               << std::setprecision(3)
+               << std::setw(12) << result.min
+               << std::setw(12) << result.p90
+               << std::setw(12) << result.p99
+               << std::setw(16) << std::setprecision(0) << result.throughput
+               << std::setprecision(3)
+               << "  " << result.unit;
+        if(!result.valid) stream << "  (no output)";
+        stream << "\n";
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void MindTree::Benchmarks::writeJSON(std::ostream &stream, const std::vector<Result> &results)
+{
+    stream << "{\"scenarios\":[";
+    bool first = true;
+    for(const auto &result : results) {
+        if(!first) stream << ",";
+        first = false;
+
+        stream << "\n{\"name\":";
+        writeJSONString(stream, result.name);
+        stream << ",\"description\":";
+        writeJSONString(stream, result.description);
+        stream << ",\"unit\":";
+        writeJSONString(stream, result.unit);
+        stream << ",\"items\":" << result.items
+               << ",\"valid\":" << (result.valid ? "true" : "false")
+               << ",\"iterations\":" << result.iterations
+               << ",\"min\":" << result.min
+               << ",\"max\":" << result.max
+               << ",\"mean\":" << result.mean
+               << ",\"median\":" << result.median
+               << ",\"p90\":" << result.p90
+               << ",\"p99\":" << result.p99
+               << ",\"stddev\":" << result.stddev
+               << ",\"mad\":" << result.mad
+               << ",\"throughput\":" << result.throughput << "}";
+    }
+
+    //what the instrumented parts of the core measured during the run
+    stream << "\n],\"instrumentation\":";
+    Benchmark::writeRegisteredJSON(stream);
+    stream << "}\n";
+}
@@ -0,0 +1,61 @@
+#ifndef MT_BENCHMARK_RUNNER_H
+#define MT_BENCHMARK_RUNNER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "scenarios.h"
+
+namespace MindTree
+{
+namespace Benchmarks
+{
+
+struct RunnerOptions
+{
+    //untimed evaluations before measuring, they fill caches and pools
+    int warmup = 3;
+
+    //a scenario is measured at least minIterations times and at least
+    //minTime seconds, but never more than maxIterations times
+    int minIterations = 10;
+    int maxIterations = 1000;
+    double minTime = .5;
+};
+
+//milliseconds
+struct Result
+{
+    std::string name;
+    std::string description;
+    std::string unit;
+    size_t items = 0;
+    bool valid = false;
+
+    size_t iterations = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double median = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double stddev = 0;
+
+    //median absolute deviation, robust against outliers like page faults
+    //or preemption, relative to the median it tells how stable the run was
+    double mad = 0;
+
+    //items per second at the median latency
+    double throughput = 0;
+};
+
+Result run(const Scenario &scenario, const RunnerOptions &options);
+
+void writeText(std::ostream &stream, const std::vector<Result> &results);
+void writeJSON(std::ostream &stream, const std::vector<Result> &results);
+
+}
+}
+
+#endif
@@ -0,0 +1,324 @@
+#include <cmath>
+
+#include "data/cache_main.h"
+#include "data/dnspace.h"
+#include "data/project.h"
+#include "data/nodes/node_db.h"
+#include "data/nodes/containernode.h"
+#include "../plugins/datatypes/Object/object.h"
+#include "../plugins/datatypes/Object/skeleton.h"
+
+#include "scenarios.h"
+
+using namespace MindTree;
+using namespace MindTree::Benchmarks;
+
+namespace
+{
+NodePtr createNode(Scenario &scenario, DNSpace *space, const std::string &label)
+{
+    NodePtr node = NodeDataBase::createNode(label);
+    space->addNode(node);
+    scenario.nodes.push_back(node);
+    return node;
+}
+
+NodePtr createNode(Scenario &scenario, const std::string &label)
+{
+    return createNode(scenario, Project::instance()->getRootSpace(), label);
+}
+
+//invalidating the sources marks everything downstream as stale, the memo
+//cache is cleared as well so results are never reused across iterations
+std::function<void()> invalidator(std::vector<NodePtr> sources)
+{
+    return [sources] {
+        for(const auto &node : sources)
+            DataCache::invalidate(node.get());
+        DataCache::clearMemoCache();
+    };
+}
+
+std::function<Property()> evaluator(NodePtr node)
+{
+    return [node] {
+        DataCache cache(node->getOutSockets()[0]);
+        return cache.getOutput();
+    };
+}
+
+//quad grid in the xz plane with a "weight" polygon attribute that
+//rises from 0 to 1 along x
+MeshDataPtr createGrid(int resolution)
+{
+    auto mesh = std::make_shared<MeshData>();
+    auto points = std::make_shared<VertexList>();
+    auto polygons = std::make_shared<PolygonBuffer>();
+    std::vector<double> weights;
+
+    uint rowSize = resolution + 1;
+    points->reserve(rowSize * rowSize);
+    polygons->reserve(resolution * resolution, 4 * resolution * resolution);
+    weights.reserve(resolution * resolution);
+
+    for(int y = 0; y <= resolution; ++y)
+        for(int x = 0; x <= resolution; ++x)
+            points->push_back(glm::vec3(float(x) / resolution - .5f,
+                                        0,
+                                        float(y) / resolution - .5f));
+
+    for(int y = 0; y < resolution; ++y) {
+        for(int x = 0; x < resolution; ++x) {
+            uint i = y * rowSize + x;
+            polygons->addPolygon({i, i + 1, i + rowSize + 1, i + rowSize});
+            weights.push_back(double(x) / resolution);
+        }
+    }
+
+    mesh->setProperty("P", points);
+    mesh->setProperty("polygon", polygons);
+    mesh->setProperty("weight", weights);
+    return mesh;
+}
+
+//a slightly bent chain of joints, every joint one unit above its parent
+JointPtr createSkeleton(int length)
+{
+    auto root = std::make_shared<Joint>();
+    auto parent = root;
+    for(int i = 0; i < length; ++i) {
+        auto joint = std::make_shared<Joint>();
+        joint->setPosition(.1 * std::sin(i * .3), 1, .1 * std::cos(i * .3));
+        parent->addChild(joint);
+        parent = joint;
+    }
+    return root;
+}
+
+Scenario createChain(int depth)
+{
+    Scenario scenario;
+    scenario.name = "chain";
+    scenario.description = "Math.Add chain " + std::to_string(depth) + " nodes deep";
+    scenario.items = depth + 1;
+
+    NodePtr value = createNode(scenario, "Values.Float Value");
+    value->getInSockets()[0]->setProperty(1.0);
+
+    NodePtr last = value;
+    for(int i = 0; i < depth; ++i) {
+        NodePtr add = createNode(scenario, "Math.Add");
+        add->getInSockets()[0]->setCntdSocket(last->getOutSockets()[0]);
+        add->getInSockets()[1]->setProperty(1.0);
+        last = add;
+    }
+
+    scenario.invalidate = invalidator({value});
+    scenario.evaluate = evaluator(last);
+    return scenario;
+}
+
+Scenario createFanOut(int width)
+{
+    Scenario scenario;
+    scenario.name = "fanout";
+    scenario.description = "one value feeding " + std::to_string(width)
+        + " Math.Add nodes summed up by a single Math.Add";
+    scenario.items = width + 2;
+
+    NodePtr value = createNode(scenario, "Values.Float Value");
+    value->getInSockets()[0]->setProperty(1.0);
+
+    NodePtr sum = createNode(scenario, "Math.Add");
+    for(int i = 0; i < width; ++i) {
+        NodePtr add = createNode(scenario, "Math.Add");
+        add->getInSockets()[0]->setCntdSocket(value->getOutSockets()[0]);
+        add->getInSockets()[1]->setProperty(double(i));
+        sum->getInSockets().back()->setCntdSocket(add->getOutSockets()[0]);
+    }
+
+    scenario.invalidate = invalidator({value});
+    scenario.evaluate = evaluator(sum);
+    return scenario;
+}
+
+Scenario createForLoop(int iterations)
+{
+    Scenario scenario;
+    scenario.name = "for";
+    scenario.description = "General.For counting to " + std::to_string(iterations);
+    scenario.unit = "iterations";
+    scenario.items = iterations;
+
+    NodePtr loop = createNode(scenario, "General.For");
+    loop->getInSockets()[0]->setProperty(0);
+    loop->getInSockets()[1]->setProperty(iterations);
+    loop->getInSockets()[2]->setProperty(1);
+
+    auto *space = loop->getDerived<ContainerNode>()->getContainerData();
+    NodePtr add = createNode(scenario, space, "Math.Add");
+    auto inner = space->getNodes();
+
+    add->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    add->getInSockets()[1]->setProperty(1);
+    inner[2]->getInSockets()[0]->setCntdSocket(add->getOutSockets()[0]);
+    loop->getInSockets()[3]->setProperty(1);
+
+    scenario.invalidate = invalidator({add});
+    scenario.evaluate = evaluator(loop);
+    return scenario;
+}
+
+Scenario createForeachLoop(int size)
+{
+    Scenario scenario;
+    scenario.name = "foreach";
+    scenario.description = "General.Foreach over a list of " + std::to_string(size) + " floats";
+    scenario.unit = "elements";
+    scenario.items = size;
+
+    NodePtr list = createNode(scenario, "General.Create List");
+    list->getInSockets()[0]->setProperty(12.5);
+    list->getInSockets()[1]->setProperty(size);
+
+    NodePtr loop = createNode(scenario, "General.Foreach");
+    loop->getInSockets()[0]->setCntdSocket(list->getOutSockets()[0]);
+
+    auto *space = loop->getDerived<ContainerNode>()->getContainerData();
+    NodePtr add = createNode(scenario, space, "Math.Add");
+    NodePtr value = createNode(scenario, space, "Values.Int Value");
+    value->getInSockets()[0]->setProperty(2);
+    auto inner = space->getNodes();
+
+    add->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    add->getInSockets()[1]->setCntdSocket(value->getOutSockets()[0]);
+    inner[2]->getInSockets()[0]->setCntdSocket(add->getOutSockets()[0]);
+
+    scenario.invalidate = invalidator({list, add});
+    scenario.evaluate = evaluator(loop);
+    return scenario;
+}
+
+Scenario createSubdivision(int resolution, int iterations)
+{
+    Scenario scenario;
+    scenario.name = "catmullclark";
+    scenario.description = std::to_string(iterations) + " subdivisions of a "
+        + std::to_string(resolution) + "x" + std::to_string(resolution) + " grid";
+    scenario.unit = "input polygons";
+    scenario.items = resolution * resolution;
+
+    NodePtr subd = createNode(scenario, "Objects.Data.Subdivision");
+    subd->getInSockets()[0]->setProperty(createGrid(resolution));
+    subd->getInSockets()[1]->setProperty(iterations);
+
+    scenario.invalidate = invalidator({subd});
+    scenario.evaluate = evaluator(subd);
+    return scenario;
+}
+
+Scenario createFilter(int resolution)
+{
+    Scenario scenario;
+    scenario.name = "filterpolygons";
+    scenario.description = "half of a " + std::to_string(resolution) + "x"
+        + std::to_string(resolution) + " grid filtered by a polygon attribute";
+    scenario.unit = "polygons";
+    scenario.items = resolution * resolution;
+
+    NodePtr filter = createNode(scenario, "Objects.Data.Filter Polygon");
+    filter->getInSockets()[0]->setProperty(createGrid(resolution));
+    filter->getInSockets()[1]->setProperty(std::string("weight"));
+    filter->getInSockets()[2]->setProperty(.75);
+    filter->getInSockets()[3]->setProperty(.25);
+
+    scenario.invalidate = invalidator({filter});
+    scenario.evaluate = evaluator(filter);
+    return scenario;
+}
+
+Scenario createMeshing(int joints, int sides)
+{
+    Scenario scenario;
+    scenario.name = "meshing";
+    scenario.description = "tube around a chain of " + std::to_string(joints)
+        + " joints with " + std::to_string(sides) + " sides";
+    scenario.unit = "joints";
+    scenario.items = joints;
+
+    NodePtr meshing = createNode(scenario, "Objects.Data.Mesh");
+    meshing->getInSockets()[0]->setProperty(createSkeleton(joints));
+    meshing->getInSockets()[2]->setProperty(sides);
+
+    scenario.invalidate = invalidator({meshing});
+    scenario.evaluate = evaluator(meshing);
+    return scenario;
+}
+
+//the grid object and the scatter node are shared with the copy scenario
+NodePtr createScatter(Scenario &scenario, int resolution, int count)
+{
+    NodePtr object = createNode(scenario, "Objects.Object");
+    object->getInSockets()[2]->setProperty(createGrid(resolution));
+
+    NodePtr scatter = createNode(scenario, "Objects.Scatter Surface");
+    scatter->getInSockets()[0]->setCntdSocket(object->getOutSockets()[0]);
+    scatter->getInSockets()[1]->setProperty(count);
+    return scatter;
+}
+
+Scenario createScatterSurface(int resolution, int count)
+{
+    Scenario scenario;
+    scenario.name = "scattersurface";
+    scenario.description = std::to_string(count) + " points scattered on a "
+        + std::to_string(resolution) + "x" + std::to_string(resolution) + " grid";
+    scenario.unit = "points";
+    scenario.items = count;
+
+    NodePtr scatter = createScatter(scenario, resolution, count);
+
+    scenario.invalidate = invalidator({scatter});
+    scenario.evaluate = evaluator(scatter);
+    return scenario;
+}
+
+Scenario createCopy(int count)
+{
+    Scenario scenario;
+    scenario.name = "copy";
+    scenario.description = "cube copied onto " + std::to_string(count) + " scattered points";
+    scenario.unit = "copies";
+    scenario.items = count;
+
+    NodePtr scatter = createScatter(scenario, 64, count);
+
+    NodePtr cube = createNode(scenario, "Objects.Data.Cube");
+    NodePtr object = createNode(scenario, "Objects.Object");
+    object->getInSockets()[2]->setCntdSocket(cube->getOutSockets()[0]);
+
+    NodePtr copy = createNode(scenario, "Objects.Copy");
+    copy->getInSockets()[0]->setCntdSocket(object->getOutSockets()[0]);
+    copy->getInSockets()[1]->setCntdSocket(scatter->getOutSockets()[0]);
+
+    //only the copy itself is measured, the scattered points stay cached
+    scenario.invalidate = invalidator({copy});
+    scenario.evaluate = evaluator(copy);
+    return scenario;
+}
+}
+
+ScenarioList MindTree::Benchmarks::createScenarios(int scale)
+{
+    ScenarioList scenarios;
+    scenarios.push_back(createChain(1000 * scale));
+    scenarios.push_back(createFanOut(1000 * scale));
+    scenarios.push_back(createForLoop(10000 * scale));
+    scenarios.push_back(createForeachLoop(10000 * scale));
+    scenarios.push_back(createSubdivision(32 * scale, 2));
+    scenarios.push_back(createFilter(256 * scale));
+    scenarios.push_back(createMeshing(200 * scale, 8));
+    scenarios.push_back(createScatterSurface(128, 10000 * scale));
+    scenarios.push_back(createCopy(1000 * scale));
+    return scenarios;
+}
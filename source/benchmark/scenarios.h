@@ -0,0 +1,48 @@
+#ifndef MT_BENCHMARK_SCENARIOS_H
+#define MT_BENCHMARK_SCENARIOS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "data/nodes/data_node.h"
+#include "data/properties.h"
+
+namespace MindTree
+{
+namespace Benchmarks
+{
+
+/*
+ * A synthetic node network built through the node database like the
+ * editor would build it.
+ *
+ * invalidate marks everything evaluate has to recompute as stale, it is
+ * not part of the measured time. evaluate runs one top level evaluation
+ * and returns its output so it can be checked and is not optimized away.
+ */
+struct Scenario
+{
+    std::string name;
+    std::string description;
+
+    //work items one evaluation processes, throughput is reported in these
+    size_t items = 1;
+    std::string unit = "nodes";
+
+    std::function<void()> invalidate;
+    std::function<Property()> evaluate;
+
+    //keeps the graph alive for as long as the scenario exists
+    std::vector<NodePtr> nodes;
+};
+
+typedef std::vector<Scenario> ScenarioList;
+
+//graph and mesh sizes grow with scale
+ScenarioList createScenarios(int scale);
+
+}
+}
+
+#endif
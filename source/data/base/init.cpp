@@ -20,6 +20,7 @@ void MindTree::initApp(int argc, char *argv[])
     MindTree::Python::init(argc, argv);
     MindTree::Python::loadIntern();
     MindTree::Python::loadPlugins();
+    MindTree::PropertyConverter::freeze();
     MindTree::HotProcessorManager::start();
 
     MindTree::parseArguments(argc, argv);
@@ -18,6 +18,7 @@
 
 #include "data/python/wrapper.h"
 #include "data/project.h"
+#include "data/benchmark.h"
 #include "QApplication"
 #include "QDir"
 #include "iostream"
@@ -137,6 +138,7 @@ void PythonToQString::construct(PyObject *obj, BPy::converter::rvalue_from_pytho
 void MindTree::Python::loadPlugins()
 {
     MindTree::Python::GILLocker locker;
+    BenchmarkHandler handler(Benchmark::get("Plugin Loading"));
     QString dir("../plugins");
     QDir plugDir(dir);
     if(!plugDir.exists()) {
@@ -155,6 +157,7 @@ void MindTree::Python::loadPlugins()
 void MindTree::Python::loadIntern()
 {
     MindTree::Python::GILLocker locker;
+    BenchmarkHandler handler(Benchmark::get("Plugin Loading"));
     QString dir("../intern");
     QDir plugDir(dir);
     if(!plugDir.exists()) {
@@ -1,10 +1,14 @@
 #include "boost/python.hpp"
 
+#include <unordered_set>
+
 #include "data/cache_main.h"
 #include "data/nodes/node_db.h"
 #include "data/nodes/containernode.h"
 #include "data/nodes/arraynode.h"
 #include "data/dnspace.h"
+#include "data/threadpool.h"
+#include "data/python/pyutils.h"
 #include "create_list_node.h"
 
 #include "basics.h"
@@ -25,7 +29,7 @@ void regContainer()
 
     auto stepIn = [] (DataCache *cache) {
         const auto *cont = cache->getNode()->getDerivedConst<ContainerNode>();
-        DataCache contCache;
+        DataCache contCache(cache->getContext());
         contCache.setNode(cont->getOutputs());
         int i = 0;
         for(auto *out : cont->getOutSockets()) {
@@ -38,7 +42,7 @@ void regContainer()
     auto stepOut = [] (DataCache *cache) {
         const auto *node = cache->getNode()->getDerivedConst<SocketNode>();
         const auto *container = node->getContainer();
-        DataCache contCache;
+        DataCache contCache(cache->getContext());
         contCache.setNode(container);
         int i = 0;
         for(auto *out : node->getOutSockets()) {
@@ -52,6 +56,176 @@ void regContainer()
     DataCache::addGenericProcessor(new GenericCacheProcessor("INSOCKETS", stepOut));
 }
 
+namespace
+{
+//the body nodes that have to be evaluated again in every iteration, these
+//are the ones downstream of the looped inputs and of the given static
+//inputs. Everything else in the body is loop invariant
+std::vector<const DNode*> getStepDependentNodes(const LoopNode *loop,
+                                                std::vector<const DoutSocket*> staticInputs)
+{
+    auto nodes = loop->getContainerData()->getNodes();
+    const DNode *loopOutputs = nodes[2].get();
+
+    std::unordered_set<const DNode*> dependent{nodes[1].get()};
+    std::vector<const DNode*> stack;
+    auto follow = [&] (const DoutSocket *out) {
+        for(const auto *in : out->getCntdSockets())
+            if(dependent.insert(in->getNode()).second)
+                stack.push_back(in->getNode());
+    };
+
+    if(!staticInputs.empty()) dependent.insert(nodes[0].get());
+    for(const auto *out : staticInputs) follow(out);
+    for(const auto *out : nodes[1]->getOutSockets()) follow(out);
+
+    while(!stack.empty()) {
+        const DNode *node = stack.back();
+        stack.pop_back();
+        if(node == loopOutputs) continue;
+
+        //nested containers are evaluated in the same context, nested
+        //loops bring their own
+        if(node->getBuildInType() == DNode::CONTAINER
+           && !dynamic_cast<const LoopNode*>(node)) {
+            const DNode *inputs = node->getDerivedConst<ContainerNode>()->getInputs();
+            if(inputs && dependent.insert(inputs).second) stack.push_back(inputs);
+        }
+        else if(node->getBuildInType() == DNode::SOCKETNODE) {
+            const DNode *container = node->getDerivedConst<SocketNode>()->getContainer();
+            if(container && container != loop && dependent.insert(container).second)
+                stack.push_back(container);
+        }
+
+        for(const auto *out : node->getOutSockets()) follow(out);
+    }
+
+    return std::vector<const DNode*>(begin(dependent), end(dependent));
+}
+
+int socketIndex(const std::vector<DinSocket*> &sockets, const DSocket *socket)
+{
+    auto it = std::find(begin(sockets), end(sockets), socket);
+    if(it == end(sockets)) return -1;
+    return std::distance(begin(sockets), it);
+}
+
+int socketIndex(const std::vector<DoutSocket*> &sockets, const DSocket *socket)
+{
+    auto it = std::find(begin(sockets), end(sockets), socket);
+    if(it == end(sockets)) return -1;
+    return std::distance(begin(sockets), it);
+}
+
+/*
+ * One variable a loop carries from one iteration into the next.
+ *
+ * looped is the socket inside the loop the body reads the current value
+ * from, next the input on the loop outputs the body writes the value for
+ * the next iteration to. initial and output index the sockets on the loop
+ * node itself.
+ */
+struct LoopedVariable
+{
+    const DSocket *looped;
+    const DSocket *next;
+    int initial;
+    int output;
+};
+
+std::vector<LoopedVariable> getLoopedVariables(const LoopNode *loop)
+{
+    const auto *looped = loop->getLoopedInputs();
+
+    std::vector<LoopedVariable> variables;
+    for(const auto *out : looped->getOutSockets()) {
+        if(out->getType() == "VARIABLE") continue;
+
+        const DSocket *next = looped->getPartnerSocket(out);
+        const DSocket *initial = loop->getSocketOnContainer(out);
+        const DSocket *output = next ? loop->getSocketOnContainer(next) : nullptr;
+        variables.push_back({out,
+                             next,
+                             initial ? socketIndex(loop->getInSockets(), initial) : -1,
+                             output ? socketIndex(loop->getOutSockets(), output) : -1});
+    }
+    return variables;
+}
+
+/*
+ * Evaluates a loop body iteration by iteration in an isolated frame.
+ *
+ * The frame keeps the outputs of the body to itself, so iterations never
+ * touch the shared output cache. Only the step dependent nodes are cleared
+ * before an iteration, loop invariant subgraphs are evaluated once and
+ * reused by all iterations.
+ */
+class LoopFrame
+{
+public:
+    LoopFrame(DataCache *cache, std::vector<const DoutSocket*> staticInputs)
+        : _cache(cache),
+          _loop(cache->getNode()->getDerivedConst<LoopNode>()),
+          _context(_loop, true, cache->getContext()),
+          _variables(getLoopedVariables(_loop)),
+          _dependent(getStepDependentNodes(_loop, staticInputs))
+    {
+        //the state starts with what is connected to the loop node
+        _state.resize(_variables.size());
+        for(size_t i = 0; i < _variables.size(); ++i) {
+            if(_variables[i].initial < 0) continue;
+            _state[i] = cache->getData(_variables[i].initial);
+            _context.addData(i, _state[i]);
+        }
+    }
+
+    //evaluates an input on the loop outputs for the current iteration
+    Property evaluate(const DSocket *socket)
+    {
+        const auto *node = socket->getNode();
+        DataCache c(&_context);
+        c.setNode(node);
+        c.setType(socket->getType());
+        return c.getData(socketIndex(node->getInSockets(), socket));
+    }
+
+    //drops what the previous iteration computed from its state
+    void beginIteration(int step)
+    {
+        _context.setStep(step);
+        _context.clearOutputs(_dependent);
+    }
+
+    //all variables are advanced together, every one of them sees the
+    //values of the previous iteration
+    void advance()
+    {
+        std::vector<Property> next(_variables.size());
+        for(size_t i = 0; i < _variables.size(); ++i)
+            if(_variables[i].next) next[i] = evaluate(_variables[i].next);
+
+        _state = std::move(next);
+        for(size_t i = 0; i < _state.size(); ++i)
+            _context.addData(i, _state[i]);
+    }
+
+    void pushOutputs()
+    {
+        for(size_t i = 0; i < _variables.size(); ++i)
+            if(_variables[i].output >= 0)
+                _cache->pushData(_state[i], _variables[i].output);
+    }
+
+private:
+    DataCache *_cache;
+    const LoopNode *_loop;
+    LoopCache _context;
+    std::vector<LoopedVariable> _variables;
+    std::vector<const DNode*> _dependent;
+    std::vector<Property> _state;
+};
+}
+
 void regForLoop()
 {
     auto decorator =
@@ -71,45 +245,64 @@ void regForLoop()
         int endval = cache->getData(1).getData<int>();
         int stepval = cache->getData(2).getData<int>();
 
-        LoopCache c(node);
-
-        const auto *out = cache->getStart();
-
-        auto loopoutnode = node->getContainerData()->getNodes()[2];
-        auto outsockets = node->getOutSockets();
-        const auto bout = begin(outsockets);
-        const auto eout = end(outsockets);
-        int outindex = std::distance(bout, std::find(bout, eout, out));
-        DataCache loopCache(&c);
-        loopCache.setType(out->getType());
-        loopCache.setNode(loopoutnode.get());
-        for(int i = startval; i < endval; i += stepval) {
-            c.setStep(i);
-            c.addData(outindex, loopCache.getData(outindex));
+        //only the step socket of the static inputs changes between
+        //iterations
+        const auto *stepSocket = node->getSocketInContainer(node->getInSockets()[2]);
+        LoopFrame frame(cache, {stepSocket->toOut()});
+        if(stepval > 0) {
+            for(int i = startval; i < endval; i += stepval) {
+                EvaluationArena::Rewind rewind;
+                frame.beginIteration(i);
+                frame.advance();
+            }
         }
-        cache->pushData(loopCache.getData(outindex), outindex);
+        frame.pushOutputs();
     };
 
     auto loopinproc = [](DataCache *cache) {
-        SocketNode *ls = cache->getStart()
-            ->getNode()->getDerived<SocketNode>();
-        auto *container = ls->getContainer();
-        auto *stepSocket = container->getInSockets()[2];
-
-        if(container->getSocketOnContainer(cache->getStart()) == stepSocket) {
-            const auto *loopCache = static_cast<const LoopCache*>(cache->getContext());
-            cache->pushData(loopCache->getStep());
+        const auto *ls = cache->getNode()->getDerivedConst<SocketNode>();
+        const auto *container = ls->getContainer();
+        auto *context = cache->getContext();
+        const auto &ins = container->getInSockets();
+
+        //the step socket of for loops is the current iteration, the other
+        //inputs are evaluated where the loop node itself is evaluated
+        const DSocket *stepSocket = nullptr;
+        if(container->getType() == "FOR" && ins.size() > 2) stepSocket = ins[2];
+
+        //inputs of foreach nodes that aren't lists are not mapped, they
+        //appear on the static inputs in the same order
+        std::vector<int> unmapped;
+        if(container->getType() == "FOREACH") {
+            for(size_t i = 0; i < ins.size(); ++i) {
+                auto type = ins[i]->getType();
+                if(type != "VARIABLE" && type.toStr().find("LIST:") == std::string::npos)
+                    unmapped.push_back(i);
+            }
         }
-        else{
-            DataCache c;
-            c.setNode(container);
-            c.setType(c.getStart()->getType());
-            auto outsockets = cache->getNode()->getOutSockets();
-            for(size_t i = 3; i < outsockets.size(); ++i) {
-                auto *out = outsockets[i];
+        size_t nextUnmapped = 0;
+
+        DataCache c(context ? context->getParent() : nullptr);
+        c.setNode(container);
+        int i = 0;
+        for(const auto *out : ls->getOutSockets()) {
+            if(out->getType() == "VARIABLE") {
+                ++i;
+                continue;
+            }
+
+            const DSocket *on = container->getSocketOnContainer(out);
+            int index = on ? socketIndex(ins, on) : -1;
+            if(!on && nextUnmapped < unmapped.size()) index = unmapped[nextUnmapped++];
+
+            if(on && on == stepSocket && context) {
+                cache->pushData(static_cast<LoopCache*>(context)->getStep(), i);
+            }
+            else if(index >= 0) {
                 c.setType(out->getType());
-                cache->pushData(c.getData(i));
+                cache->pushData(c.getData(index), i);
             }
+            ++i;
         }
     };
 
@@ -117,10 +310,10 @@ void regForLoop()
         auto *node = cache->getNode()->getDerivedConst<LoopSocketNode>();
         auto *loopCache = static_cast<LoopCache*>(cache->getContext());
         int i = 0;
-        DataCache c;
+        DataCache c(loopCache ? loopCache->getParent() : nullptr);
         for (auto *out : node->getOutSockets()) {
             if(out->getType() == "VARIABLE") continue;
-            Property prop = loopCache->getData(i);
+            Property prop = loopCache ? loopCache->getData(i) : Property();
             if(prop) {
                 cache->pushData(prop);
             } else {
@@ -157,13 +350,51 @@ void regWhileLoop()
 
     NodeDataBase::registerNodeType(std::move(decorator));
 
+    //the condition is checked against the current state before every
+    //iteration, the state of the last iteration is the result. Max
+    //Iterations bounds loops that never converge
     auto whileproc = [](DataCache *cache) {
-
+        const WhileNode *node = cache->getNode()->getDerivedConst<WhileNode>();
+        int maxIterations = cache->getData(0).getData<int>();
+
+        //nothing on the static inputs changes between iterations
+        LoopFrame frame(cache, {});
+        const auto *condition = node->getOutputs()->getInSockets()[0];
+        for(int i = 0; i < maxIterations; ++i) {
+            EvaluationArena::Rewind rewind;
+            frame.beginIteration(i);
+            Property prop = frame.evaluate(condition);
+            if(!prop || !prop.getData<bool>()) break;
+            frame.advance();
+        }
+        frame.pushOutputs();
     };
 
     DataCache::addGenericProcessor(new GenericCacheProcessor("WHILE", whileproc));
 }
 
+namespace
+{
+//for, foreach and while loops keep their iteration state in isolated
+//frames, other loops keep it in the shared output cache and bodies
+//containing them can't be evaluated concurrently
+bool hasNestedLoops(const DNSpace *space)
+{
+    for(const auto &node : space->getNodes()) {
+        if(node->getBuildInType() != DNode::CONTAINER) continue;
+        if(dynamic_cast<const LoopNode*>(node.get())
+           && node->getType() != "FOR"
+           && node->getType() != "FOREACH"
+           && node->getType() != "WHILE")
+            return true;
+
+        const auto *container = node->getDerivedConst<ContainerNode>();
+        if(hasNestedLoops(container->getContainerData())) return true;
+    }
+    return false;
+}
+}
+
 void regForeachLoop()
 {
     auto decorator =
@@ -177,7 +408,6 @@ void regForeachLoop()
 
     auto foreachproc = [](DataCache *cache) {
         const auto *fornode = cache->getNode()->getDerivedConst<ForeachNode>();
-        LoopCache loopCache(fornode);
 
         //catch all vectors
         std::vector<Property> vectors;
@@ -186,24 +416,59 @@ void regForeachLoop()
             if(!vec.isList()) continue;
             vectors.push_back(vec);
         }
+        if(vectors.empty()) return;
 
-        //actual foreach
+        //only lists as long as the first one are iterated
         size_t size = vectors[0].size();
-        DataCache c(&loopCache);
-        for(size_t i = 0; i < size; ++i) {
-            int j = 0;
-            for(const auto &vec : vectors) {
-                if(vec.size() != size) continue;
-                auto prop = Property::getItem(vec, i);
-                loopCache.addData(j, prop);
-                auto t = prop.getType();
-                c.setType(t);
+        std::vector<size_t> iterated;
+        for(size_t i = 0; i < vectors.size(); ++i)
+            if(vectors[i].size() == size) iterated.push_back(i);
+
+        //every iteration evaluates the body in its own isolated context,
+        //so iterations don't see each other's results and can run
+        //concurrently. Results go into presized lists first
+        std::vector<std::vector<Property>> results(vectors.size());
+        for(size_t i : iterated) results[i].resize(size);
+
+        auto iterate = [&] (size_t start, size_t end) {
+            for(size_t i = start; i < end; ++i) {
+                EvaluationArena::Rewind rewind;
+                LoopCache loopCache(fornode, true, cache->getContext());
+                for(size_t j = 0; j < iterated.size(); ++j)
+                    loopCache.addData(j, Property::getItem(vectors[iterated[j]], i));
+
+                DataCache c(&loopCache);
                 c.setNode(fornode->getOutputs());
-                Property::setItem(vectors[j], i, c.getData(j));
-                ++j;
+                for(size_t j = 0; j < iterated.size(); ++j) {
+                    c.setType(loopCache.getData(j).getType());
+                    results[iterated[j]][i] = c.getData(j);
+                }
+            }
+        };
+
+        if(DataCache::isParallelEvaluation()
+           && size > 1
+           && !hasNestedLoops(fornode->getContainerData())) {
+            auto &pool = ThreadPool::instance();
+            size_t grainSize = std::max<size_t>(size / (8 * (pool.getThreadCount() + 1)), 1);
+
+            //python processors need the GIL on the worker threads
+            if(Py_IsInitialized() && PyGILState_Check()) {
+                Python::GILReleaser releaser;
+                pool.parallelFor(size, iterate, grainSize);
+            }
+            else {
+                pool.parallelFor(size, iterate, grainSize);
             }
-
         }
+        else {
+            iterate(0, size);
+        }
+
+        for(size_t i : iterated)
+            for(size_t j = 0; j < size; ++j)
+                Property::setItem(vectors[i], j, results[i][j]);
+
         for(auto vec : vectors) {
             cache->pushData(vec);
         }
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "arena.h"
+
+using namespace MindTree;
+
+namespace
+{
+//an arena keeps at most this much memory between two evaluations
+const size_t MAX_RETAINED_SIZE = 16 * 1024 * 1024;
+
+thread_local EvaluationArena *currentArena = nullptr;
+
+EvaluationArena& threadArena()
+{
+    thread_local EvaluationArena arena;
+    return arena;
+}
+}
+
+EvaluationArena::EvaluationArena(size_t blockSize)
+    : _blockSize(blockSize), _current(0), _offset(0), _used(0)
+{
+}
+
+EvaluationArena::~EvaluationArena()
+{
+}
+
+void EvaluationArena::addBlock(size_t minSize)
+{
+    //blocks grow so a long evaluation only needs a few of them
+    size_t size = _blocks.empty() ? _blockSize : _blocks.back().size * 2;
+    size = std::max(size, minSize);
+
+    Block block;
+    block.data.reset(new char[size]);
+    block.size = size;
+    _blocks.push_back(std::move(block));
+    _current = _blocks.size() - 1;
+    _offset = 0;
+}
+
+void* EvaluationArena::allocate(size_t bytes, size_t alignment)
+{
+    if(!bytes) bytes = 1;
+
+    //after a rewind the blocks following the current one are reused
+    for(; _current < _blocks.size(); ++_current, _offset = 0) {
+        const Block &block = _blocks[_current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t aligned = (base + _offset + alignment - 1) & ~uintptr_t(alignment - 1);
+        size_t offset = aligned - base;
+        if(offset + bytes <= block.size) {
+            _offset = offset + bytes;
+            _used += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    //new blocks come from new[] and are aligned for any fundamental type
+    addBlock(bytes + alignment);
+    return allocate(bytes, alignment);
+}
+
+void EvaluationArena::release()
+{
+    //the next run gets one block big enough for everything this run needed
+    size_t reserved = getBytesReserved();
+    if(_blocks.size() > 1 || reserved > MAX_RETAINED_SIZE) {
+        _blocks.clear();
+        _blockSize = std::min(std::max(_blockSize, reserved), MAX_RETAINED_SIZE);
+    }
+    _current = 0;
+    _offset = 0;
+    _used = 0;
+}
+
+EvaluationArena::Mark EvaluationArena::mark() const
+{
+    return Mark{_current, _offset, _used};
+}
+
+void EvaluationArena::rewind(const Mark &mark)
+{
+    _current = mark.block;
+    _offset = mark.offset;
+    _used = mark.used;
+}
+
+size_t EvaluationArena::getBytesUsed() const
+{
+    return _used;
+}
+
+size_t EvaluationArena::getBytesReserved() const
+{
+    size_t size = 0;
+    for(const Block &block : _blocks)
+        size += block.size;
+    return size;
+}
+
+EvaluationArena* EvaluationArena::current()
+{
+    return currentArena;
+}
+
+EvaluationArena::Scope::Scope()
+    : _outermost(!currentArena)
+{
+    if(_outermost) currentArena = &threadArena();
+}
+
+EvaluationArena::Scope::~Scope()
+{
+    if(!_outermost) return;
+
+    currentArena->release();
+    currentArena = nullptr;
+}
+
+EvaluationArena::Rewind::Rewind()
+    : _arena(currentArena), _mark(_arena ? _arena->mark() : Mark{0, 0, 0})
+{
+}
+
+EvaluationArena::Rewind::~Rewind()
+{
+    if(_arena) _arena->rewind(_mark);
+}
@@ -0,0 +1,159 @@
+#ifndef MT_ARENA_H
+#define MT_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace MindTree
+{
+
+/*
+ * Monotonic memory arena.
+ *
+ * Allocations bump a pointer through a list of blocks and are never
+ * freed one by one, release hands everything back at once. The first
+ * block is kept, so an arena that gets reused does not touch the heap
+ * again unless it needs more memory than before.
+ *
+ * Every thread owns one arena that is active while a Scope exists on
+ * that thread. The evaluation of a node network opens a scope for its
+ * whole duration, temporaries of nested evaluations come from the arena
+ * and are dropped together when the outermost scope closes. Loops open a
+ * Rewind for every iteration so the arena doesn't grow with the number
+ * of iterations.
+ */
+class EvaluationArena
+{
+public:
+    EvaluationArena(size_t blockSize=64 * 1024);
+    ~EvaluationArena();
+
+    EvaluationArena(const EvaluationArena&) = delete;
+    EvaluationArena& operator=(const EvaluationArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment=alignof(std::max_align_t));
+    void release();
+
+    //rewinding to a mark hands back everything allocated after it, none
+    //of that memory may still be in use
+    struct Mark {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+    Mark mark() const;
+    void rewind(const Mark &mark);
+
+    size_t getBytesUsed() const;
+    size_t getBytesReserved() const;
+
+    //the arena of the calling thread if a scope is open, nullptr otherwise
+    static EvaluationArena* current();
+
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool _outermost;
+    };
+
+    //rewinds the arena of the calling thread to where it was when the
+    //Rewind was created, does nothing without an open scope
+    class Rewind
+    {
+    public:
+        Rewind();
+        ~Rewind();
+
+        Rewind(const Rewind&) = delete;
+        Rewind& operator=(const Rewind&) = delete;
+
+    private:
+        EvaluationArena *_arena;
+        Mark _mark;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void addBlock(size_t minSize);
+
+    //blocks after the current one are kept when rewinding
+    std::vector<Block> _blocks;
+    size_t _blockSize;
+    size_t _current;
+    size_t _offset;
+    size_t _used;
+};
+
+/*
+ * STL allocator drawing from an arena, without an arena it falls back
+ * to the heap. Copies of containers always go to the heap as they might
+ * outlive the arena.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator(EvaluationArena *arena=nullptr) : _arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.getArena()) {}
+
+    T* allocate(size_t n)
+    {
+        if(_arena)
+            return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t)
+    {
+        if(!_arena) ::operator delete(p);
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const
+    {
+        return ArenaAllocator();
+    }
+
+    EvaluationArena* getArena() const
+    {
+        return _arena;
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return _arena == other.getArena();
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return _arena != other.getArena();
+    }
+
+private:
+    EvaluationArena *_arena;
+};
+
+}
+
+#endif
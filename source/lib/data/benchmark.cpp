@@ -0,0 +1,522 @@
+#include "iomanip"
+#include "fstream"
+#include "algorithm"
+#include "cmath"
+#include "deque"
+#include "map"
+#include "unordered_map"
+
+#include "benchmark.h"
+
+using namespace MindTree;
+
+namespace
+{
+//events per thread kept for the trace, later events are dropped
+const size_t TRACE_CAPACITY = 1 << 18;
+
+/*
+ * Only the owning thread adds events, the mutex is only contended while
+ * the trace is written or cleared. The events are allocated as they come
+ * in and released with the trace.
+ */
+struct ThreadTrace {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t dropped = 0;
+    uint32_t thread = 0;
+};
+
+std::atomic<bool> tracing{false};
+const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+thread_local int benchmarkDepth = 0;
+
+std::mutex registryMutex;
+std::map<std::string, std::shared_ptr<Benchmark>> registry;
+
+std::mutex traceMutex;
+std::vector<std::shared_ptr<ThreadTrace>> threadTraces;
+
+//names are interned so trace events stay readable after their
+//benchmark is gone
+std::deque<std::string> traceNames;
+std::unordered_map<std::string, uint32_t> traceNameIndices;
+
+uint32_t internName(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    auto it = traceNameIndices.find(name);
+    if(it != end(traceNameIndices)) return it->second;
+
+    uint32_t index = traceNames.size();
+    traceNames.push_back(name);
+    traceNameIndices[name] = index;
+    return index;
+}
+
+const uint32_t benchmarkCategory = internName("benchmark");
+uint32_t traceThreadCount = 0;
+
+//traces outlive their threads until the trace is cleared
+ThreadTrace& getThreadTrace()
+{
+    thread_local std::shared_ptr<ThreadTrace> trace;
+    if(!trace) {
+        trace = std::make_shared<ThreadTrace>();
+        std::lock_guard<std::mutex> lock(traceMutex);
+        trace->thread = traceThreadCount++;
+        threadTraces.push_back(trace);
+    }
+    return *trace;
+}
+
+//releases the events of every thread and forgets finished threads,
+//expects traceMutex to be held
+void releaseTraces()
+{
+    for(const auto &trace : threadTraces) {
+        std::lock_guard<std::mutex> lock(trace->mutex);
+        std::vector<TraceEvent>().swap(trace->events);
+        trace->dropped = 0;
+    }
+
+    threadTraces.erase(std::remove_if(begin(threadTraces), end(threadTraces),
+                                      [] (const std::shared_ptr<ThreadTrace> &trace) {
+                                          return trace.use_count() == 1;
+                                      }),
+                       end(threadTraces));
+}
+
+int64_t toNanoseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+double toMilliseconds(double nanoseconds)
+{
+    return nanoseconds / 1e6;
+}
+
+//four buckets per power of two, values below 4ns get their own bucket
+int getBucket(uint64_t nanoseconds)
+{
+    if(nanoseconds < 4) return nanoseconds;
+
+    int exponent = 63;
+    while(!(nanoseconds >> exponent)) --exponent;
+    int sub = (nanoseconds >> (exponent - 2)) & 3;
+    return (exponent - 1) * 4 + sub;
+}
+
+double getBucketCenter(int bucket)
+{
+    if(bucket < 4) return bucket;
+
+    int exponent = bucket / 4 + 1;
+    int sub = bucket % 4;
+    return std::ldexp(4.5 + sub, exponent - 2);
+}
+
+void atomicMin(std::atomic<uint64_t> &value, uint64_t other)
+{
+    uint64_t current = value.load(std::memory_order_relaxed);
+    while(other < current
+          && !value.compare_exchange_weak(current, other, std::memory_order_relaxed));
+}
+
+void atomicMax(std::atomic<uint64_t> &value, uint64_t other)
+{
+    uint64_t current = value.load(std::memory_order_relaxed);
+    while(other > current
+          && !value.compare_exchange_weak(current, other, std::memory_order_relaxed));
+}
+}
+
+void MindTree::writeJSONString(std::ostream &stream, const std::string &str)
+{
+    static const char *hex = "0123456789abcdef";
+    stream << '"';
+    for(char c : str) {
+        switch(c) {
+        case '"': stream << "\\\""; break;
+        case '\\': stream << "\\\\"; break;
+        case '\n': stream << "\\n"; break;
+        case '\r': stream << "\\r"; break;
+        case '\t': stream << "\\t"; break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20)
+                stream << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+            else
+                stream << c;
+        }
+    }
+    stream << '"';
+}
+
+BenchmarkHandler::BenchmarkHandler(std::weak_ptr<Benchmark> benchmark) :
+    _benchmark(benchmark.lock()), _sampled(false)
+{
+    if(!_benchmark) return;
+
+    _sampled = _benchmark->sample();
+    ++benchmarkDepth;
+    if(_sampled) _start = std::chrono::steady_clock::now();
+}
+
+BenchmarkHandler::~BenchmarkHandler()
+{
+    if(!_benchmark) return;
+
+    --benchmarkDepth;
+    if(_sampled)
+        _benchmark->record(_start, std::chrono::steady_clock::now(), benchmarkDepth);
+}
+
+Benchmark::Benchmark(std::string name) :
+    _name(name),
+    _traceName(internName(name)),
+    _calls(0),
+    _samples(0),
+    _total(0),
+    _min(UINT64_MAX),
+    _max(0),
+    _sampling(1),
+    _hasCallback(false)
+{
+    for(auto &bucket : _histogram) bucket = 0;
+}
+
+std::string Benchmark::getName() const
+{
+    return _name;
+}
+
+void Benchmark::addBenchmark(std::weak_ptr<Benchmark> benchmark)
+{
+    if(benchmark.expired())
+        return;
+
+    std::lock_guard<std::mutex> lock(_structureLock);
+    _benchmarks.push_back(benchmark);
+}
+
+std::vector<std::shared_ptr<Benchmark>> Benchmark::getBenchmarks() const
+{
+    std::lock_guard<std::mutex> lock(_structureLock);
+    std::vector<std::shared_ptr<Benchmark>> benchmarks;
+    for(const auto &bench : _benchmarks) {
+        auto ptr = bench.lock();
+        if(ptr) benchmarks.push_back(ptr);
+    }
+    return benchmarks;
+}
+
+void Benchmark::setCallback(std::function<void(Benchmark *)> cb)
+{
+    std::lock_guard<std::mutex> lock(_structureLock);
+    _callback = cb;
+    _hasCallback = bool(cb);
+}
+
+void Benchmark::setSampling(uint32_t interval)
+{
+    _sampling = std::max<uint32_t>(interval, 1);
+}
+
+uint32_t Benchmark::getSampling() const
+{
+    return _sampling;
+}
+
+bool Benchmark::sample()
+{
+    uint64_t call = _calls.fetch_add(1, std::memory_order_relaxed);
+    return call % _sampling.load(std::memory_order_relaxed) == 0;
+}
+
+void Benchmark::record(std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end,
+                       int depth)
+{
+    uint64_t duration = toNanoseconds(end - start);
+    _samples.fetch_add(1, std::memory_order_relaxed);
+    _total.fetch_add(duration, std::memory_order_relaxed);
+    atomicMin(_min, duration);
+    atomicMax(_max, duration);
+    _histogram[getBucket(duration)].fetch_add(1, std::memory_order_relaxed);
+
+    if(tracing.load(std::memory_order_relaxed))
+        addTraceEvent({_traceName,
+                       benchmarkCategory,
+                       uint32_t(depth),
+                       toNanoseconds(start - traceEpoch),
+                       int64_t(duration),
+                       int64_t(duration),
+                       0});
+
+    if(_hasCallback.load(std::memory_order_relaxed)) {
+        std::function<void(Benchmark*)> callback;
+        {
+            std::lock_guard<std::mutex> lock(_structureLock);
+            callback = _callback;
+        }
+        if(callback) callback(this);
+    }
+}
+
+void Benchmark::addSample(uint64_t nanoseconds)
+{
+    _calls.fetch_add(1, std::memory_order_relaxed);
+    auto end = std::chrono::steady_clock::now();
+    record(end - std::chrono::nanoseconds(nanoseconds), end, benchmarkDepth);
+}
+
+void Benchmark::reset()
+{
+    _calls = 0;
+    _samples = 0;
+    _total = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+    for(auto &bucket : _histogram) bucket = 0;
+
+    for(auto bench : getBenchmarks())
+        bench->reset();
+
+    std::lock_guard<std::mutex> lock(_structureLock);
+    _benchmarks.erase(std::remove_if(begin(_benchmarks),
+                                     end(_benchmarks),
+                                     [] (const std::weak_ptr<Benchmark> &bench) {
+                                         return bench.expired();
+                                     }), end(_benchmarks));
+}
+
+int Benchmark::getNumCalls() const
+{
+    return _calls;
+}
+
+//benchmarks that are never measured themselves report their children
+uint64_t Benchmark::getTotalNanoseconds() const
+{
+    if(_samples) return _total;
+
+    uint64_t total = 0;
+    for(const auto &bench : getBenchmarks())
+        total += bench->getTotalNanoseconds();
+    return total;
+}
+
+double Benchmark::getPercentile(double percentile) const
+{
+    uint64_t samples = 0;
+    for(const auto &bucket : _histogram) samples += bucket;
+    if(!samples) return 0;
+
+    uint64_t target = std::max<uint64_t>(std::ceil(percentile / 100. * samples), 1);
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += _histogram[i];
+        if(seen >= target) {
+            double value = getBucketCenter(i);
+            value = std::max(value, double(_min.load()));
+            value = std::min(value, double(_max.load()));
+            return toMilliseconds(value);
+        }
+    }
+    return toMilliseconds(_max);
+}
+
+Benchmark::Statistics Benchmark::getStatistics() const
+{
+    Statistics stats;
+    stats.calls = _calls;
+    stats.samples = _samples;
+    stats.total = toMilliseconds(getTotalNanoseconds());
+
+    if(!stats.samples) {
+        for(const auto &bench : getBenchmarks())
+            stats.calls = std::max<uint64_t>(stats.calls, bench->getNumCalls());
+        if(stats.calls) stats.mean = stats.total / stats.calls;
+        return stats;
+    }
+
+    stats.mean = stats.total / stats.samples;
+    stats.min = toMilliseconds(_min);
+    stats.max = toMilliseconds(_max);
+    stats.p50 = getPercentile(50);
+    stats.p90 = getPercentile(90);
+    stats.p99 = getPercentile(99);
+    return stats;
+}
+
+void Benchmark::writeText(std::ostream &stream, int depth) const
+{
+    auto stats = getStatistics();
+    if(stats.calls == 0)
+        return;
+
+    auto name = std::string(depth * 2, ' ') + _name + "(" + std::to_string(stats.calls) + "):";
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+    stream << std::setw(40) << std::left << name << std::right
+           << std::fixed << std::setprecision(2) << stats.mean;
+    if(stats.samples)
+        stream << " min " << stats.min
+               << " p50 " << stats.p50
+               << " p99 " << stats.p99
+               << " max " << stats.max;
+    stream << std::endl;
+    stream.flags(flags);
+    stream.precision(precision);
+
+    for(const auto &bench : getBenchmarks())
+        bench->writeText(stream, depth + 1);
+}
+
+void Benchmark::writeJSON(std::ostream &stream) const
+{
+    auto stats = getStatistics();
+    stream << "{\"name\":";
+    writeJSONString(stream, _name);
+    stream << ",\"calls\":" << stats.calls
+           << ",\"samples\":" << stats.samples
+           << ",\"total\":" << stats.total
+           << ",\"mean\":" << stats.mean
+           << ",\"min\":" << stats.min
+           << ",\"max\":" << stats.max
+           << ",\"p50\":" << stats.p50
+           << ",\"p90\":" << stats.p90
+           << ",\"p99\":" << stats.p99
+           << ",\"children\":[";
+
+    bool first = true;
+    for(const auto &bench : getBenchmarks()) {
+        if(!first) stream << ",";
+        first = false;
+        bench->writeJSON(stream);
+    }
+    stream << "]}";
+}
+
+std::shared_ptr<Benchmark> Benchmark::get(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto &bench = registry[name];
+    if(!bench) bench = std::make_shared<Benchmark>(name);
+    return bench;
+}
+
+std::vector<std::shared_ptr<Benchmark>> Benchmark::getRegistered()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<std::shared_ptr<Benchmark>> benchmarks;
+    for(const auto &entry : registry)
+        benchmarks.push_back(entry.second);
+    return benchmarks;
+}
+
+void Benchmark::writeRegisteredText(std::ostream &stream)
+{
+    for(const auto &bench : getRegistered())
+        bench->writeText(stream);
+}
+
+void Benchmark::writeRegisteredJSON(std::ostream &stream)
+{
+    stream << "[";
+    bool first = true;
+    for(const auto &bench : getRegistered()) {
+        if(!first) stream << ",";
+        first = false;
+        bench->writeJSON(stream);
+    }
+    stream << "]";
+}
+
+void Benchmark::setTracing(bool enabled)
+{
+    tracing = enabled;
+}
+
+bool Benchmark::isTracing()
+{
+    return tracing;
+}
+
+void Benchmark::clearTrace()
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    releaseTraces();
+}
+
+uint32_t Benchmark::internTraceName(const std::string &name)
+{
+    return internName(name);
+}
+
+int64_t Benchmark::getTraceTime(std::chrono::steady_clock::time_point time)
+{
+    return toNanoseconds(time - traceEpoch);
+}
+
+void Benchmark::addTraceEvent(const TraceEvent &event)
+{
+    ThreadTrace &trace = getThreadTrace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    if(trace.events.size() < TRACE_CAPACITY)
+        trace.events.push_back(event);
+    else
+        ++trace.dropped;
+}
+
+void Benchmark::writeTrace(std::ostream &stream)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+
+    //timestamps and durations are in microseconds
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    size_t dropped = 0;
+    for(const auto &trace : threadTraces) {
+        std::lock_guard<std::mutex> traceLock(trace->mutex);
+        dropped += trace->dropped;
+        for(const TraceEvent &event : trace->events) {
+            if(!first) stream << ",";
+            first = false;
+
+            stream << "\n{\"name\":";
+            writeJSONString(stream, traceNames[event.name]);
+            stream << ",\"cat\":";
+            writeJSONString(stream, traceNames[event.category]);
+            stream << ",\"ph\":\"X\",\"pid\":0"
+                   << ",\"tid\":" << trace->thread
+                   << ",\"ts\":" << event.start / 1e3
+                   << ",\"dur\":" << event.duration / 1e3;
+            if(event.category == benchmarkCategory)
+                stream << ",\"args\":{\"depth\":" << event.depth << "}}";
+            else
+                stream << ",\"args\":{\"self\":" << event.self / 1e3
+                       << ",\"bytes\":" << event.bytes << "}}";
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\""
+           << ",\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+
+    releaseTraces();
+}
+
+bool Benchmark::writeTrace(const std::string &path)
+{
+    std::ofstream stream(path);
+    if(!stream) return false;
+
+    writeTrace(stream);
+    return bool(stream);
+}
+
+std::ostream& MindTree::operator<<(std::ostream &stream, const MindTree::Benchmark &benchmark)
+{
+    benchmark.writeText(stream);
+    return stream;
+}
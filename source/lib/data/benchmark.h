@@ -0,0 +1,164 @@
+#ifndef MT_BENCHMARK_H
+#define MT_BENCHMARK_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace MindTree { class Benchmark; }
+
+namespace MindTree
+{
+std::ostream& operator<<(std::ostream &stream, const MindTree::Benchmark &benchmark);
+
+//writes str as a quoted JSON string, control characters are escaped
+void writeJSONString(std::ostream &stream, const std::string &str);
+
+/*
+ * One timed call in the trace. Times are nanoseconds, start is relative
+ * to the trace epoch. Benchmark scopes record their nesting depth on the
+ * calling thread, other events the time spent in the call itself and
+ * the bytes it produced.
+ */
+struct TraceEvent {
+    uint32_t name;
+    uint32_t category;
+    uint32_t depth;
+    int64_t start;
+    int64_t duration;
+    int64_t self;
+    uint64_t bytes;
+};
+
+/*
+ * Timing statistics for one instrumented piece of code.
+ *
+ * Benchmarks are measured by BenchmarkHandler scopes and can be measured
+ * from any number of threads at once, recording only touches atomics.
+ * Besides call count and mean, min and max every benchmark keeps a
+ * histogram with four buckets per power of two of nanoseconds that
+ * percentiles are estimated from.
+ *
+ * Benchmarks form a hierarchy through addBenchmark, a benchmark that is
+ * never measured itself reports the time of its children.
+ *
+ * With a sampling interval of n only every nth call is timed, the calls
+ * in between are only counted.
+ *
+ * While tracing is enabled every timed call is also written to a buffer
+ * of the calling thread, writeTrace exports all of them as Chrome trace
+ * event JSON. Other instrumentation like the EvaluationProfiler adds its
+ * events to the same buffers, so everything ends up on one timeline.
+ * The buffers grow with the events they hold and are released once the
+ * trace was written or cleared.
+ */
+class Benchmark
+{
+public:
+    //milliseconds
+    struct Statistics {
+        uint64_t calls = 0;
+        uint64_t samples = 0;
+        double total = 0;
+        double mean = 0;
+        double min = 0;
+        double max = 0;
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+    };
+
+    Benchmark(std::string name);
+    void addBenchmark(std::weak_ptr<Benchmark> benchmark);
+    std::vector<std::shared_ptr<Benchmark>> getBenchmarks() const;
+    std::string getName() const;
+    void reset();
+    void setCallback(std::function<void(Benchmark *)> cb);
+    int getNumCalls() const;
+
+    void setSampling(uint32_t interval);
+    uint32_t getSampling() const;
+
+    //records a duration in nanoseconds that was measured elsewhere, like
+    //on the gpu. Its trace event ends when it is added
+    void addSample(uint64_t nanoseconds);
+
+    Statistics getStatistics() const;
+    double getPercentile(double percentile) const;
+
+    void writeText(std::ostream &stream, int depth=0) const;
+    void writeJSON(std::ostream &stream) const;
+
+    //named benchmarks shared across the application, created on first use
+    static std::shared_ptr<Benchmark> get(const std::string &name);
+    static std::vector<std::shared_ptr<Benchmark>> getRegistered();
+    static void writeRegisteredText(std::ostream &stream);
+    static void writeRegisteredJSON(std::ostream &stream);
+
+    static void setTracing(bool tracing);
+    static bool isTracing();
+    static void clearTrace();
+    //hands over all events recorded so far, the next trace starts empty
+    static void writeTrace(std::ostream &stream);
+    static bool writeTrace(const std::string &path);
+
+    //names and categories of trace events are interned once
+    static uint32_t internTraceName(const std::string &name);
+    static int64_t getTraceTime(std::chrono::steady_clock::time_point time);
+    //adds an event to the calling thread's buffer, whether tracing is
+    //enabled or not
+    static void addTraceEvent(const TraceEvent &event);
+
+private:
+    friend class BenchmarkHandler;
+    friend std::ostream& operator<<(std::ostream &stream, const Benchmark &benchmark);
+
+    static const int BUCKET_COUNT = 256;
+
+    bool sample();
+    void record(std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end,
+                int depth);
+    uint64_t getTotalNanoseconds() const;
+
+    const std::string _name;
+    const uint32_t _traceName;
+    std::function<void(Benchmark*)> _callback;
+
+    std::atomic<uint64_t> _calls;
+    std::atomic<uint64_t> _samples;
+    std::atomic<uint64_t> _total;
+    std::atomic<uint64_t> _min;
+    std::atomic<uint64_t> _max;
+    std::atomic<uint32_t> _sampling;
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> _histogram;
+
+    //only guards the hierarchy and the callback, never taken while
+    //measuring unless a callback is set
+    mutable std::mutex _structureLock;
+    std::atomic<bool> _hasCallback;
+    std::vector<std::weak_ptr<Benchmark>> _benchmarks;
+};
+
+class BenchmarkHandler
+{
+public:
+    BenchmarkHandler(std::weak_ptr<Benchmark> benchmark);
+    ~BenchmarkHandler();
+
+private:
+    std::shared_ptr<Benchmark> _benchmark;
+    std::chrono::steady_clock::time_point _start;
+    bool _sampled;
+};
+
+}
+
+#endif
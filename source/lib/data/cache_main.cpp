@@ -17,21 +17,30 @@
 */
 
 #include "iostream"
+#include "chrono"
+#include "cmath"
+#include "condition_variable"
+#include "exception"
 
 #include "data/dnspace.h"
 #include "data/nodes/containernode.h"
 #include "data/signal.h"
 #include "data/debuglog.h"
+#include "data/profiler.h"
+#include "data/threadpool.h"
+#include "data/python/pyutils.h"
 
 #include "cache_main.h"
 
+//#define DEBUG_CACHE
+
 using namespace MindTree;
 
 TypeDispatcher<SocketType, AbstractCacheProcessor::CacheList> DataCache::processors;
 AbstractCacheProcessor::CacheList DataCache::_genericProcessors;
 
-CacheContext::CacheContext(const LoopNode* node)
-    : _node(node)
+CacheContext::CacheContext(const LoopNode* node, bool isolated, CacheContext *parent)
+    : _node(node), _parent(parent), _isolated(isolated)
 {
 }
 
@@ -62,7 +71,7 @@ Property CacheContext::getData(size_t i)
 Property CacheContext::getData(const DoutSocket *socket)
 {
     //find index
-    auto outsockets = getNode()->getLoopedInputs()->getOutSockets();
+    const auto &outsockets = getNode()->getLoopedInputs()->getOutSockets();
     auto outiter = std::find(begin(outsockets), end(outsockets), socket);
     if (outiter == end(outsockets))
         return Property();
@@ -76,8 +85,42 @@ const LoopNode* CacheContext::getNode()
     return _node;
 }
 
-LoopCache::LoopCache(const MindTree::LoopNode *node)
-    : CacheContext(node), stepValue(0), startValue(0), endValue(0)
+bool CacheContext::isIsolated() const
+{
+    return _isolated;
+}
+
+void CacheContext::setOutput(const DNode *node, size_t index, OutputCache::PropertyPtr prop)
+{
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    auto &outputs = _outputs[node];
+    if(outputs.size() <= index)
+        outputs.resize(index + 1);
+    outputs[index] = std::move(prop);
+}
+
+OutputCache::Outputs CacheContext::getOutputs(const DNode *node) const
+{
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    auto it = _outputs.find(node);
+    if(it == end(_outputs)) return OutputCache::Outputs();
+    return it->second;
+}
+
+void CacheContext::clearOutputs(const std::vector<const DNode*> &nodes)
+{
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    for(const auto *node : nodes)
+        _outputs.erase(node);
+}
+
+CacheContext* CacheContext::getParent() const
+{
+    return _parent;
+}
+
+LoopCache::LoopCache(const MindTree::LoopNode *node, bool isolated, CacheContext *parent)
+    : CacheContext(node, isolated, parent), stepValue(0), startValue(0), endValue(0)
 {
 }
 
@@ -88,9 +131,11 @@ LoopCache::~LoopCache()
 void LoopCache::setStep(int step)
 {
     stepValue = step;
+    if(isIsolated()) return;
+
     auto nodes = getNode()->getContainerData()->getNodes();
-    DataCache::invalidate(nodes[0].get()); //static inputs
-    DataCache::invalidate(nodes[1].get()); //looped inputs
+    DataCache::invalidate(nodes[0].get(), getNode()); //static inputs
+    DataCache::invalidate(nodes[1].get(), getNode()); //looped inputs
 }
 
 int LoopCache::getStep()const
@@ -99,7 +144,7 @@ int LoopCache::getStep()const
 }
 
 AbstractCacheProcessor::AbstractCacheProcessor(SocketType st, NodeType nt) :
-    m_socketType(st), m_nodeType(nt)
+    m_socketType(st), m_nodeType(nt), m_memoizable(false)
 {
 }
 
@@ -117,6 +162,16 @@ const NodeType& AbstractCacheProcessor::getNodeType() const
     return m_nodeType;
 }
 
+bool AbstractCacheProcessor::isMemoizable() const
+{
+    return m_memoizable.load(std::memory_order_relaxed);
+}
+
+void AbstractCacheProcessor::setMemoizable(bool memoizable)
+{
+    m_memoizable = memoizable;
+}
+
 CacheProcessor::CacheProcessor(SocketType st, NodeType nt, std::function<void(DataCache*)> fn)
     : AbstractCacheProcessor(st, nt), processor(fn)
 {
@@ -131,26 +186,40 @@ void CacheProcessor::operator()(DataCache* cache)
     processor(cache);
 }
 
-std::unordered_map<const DNode*, std::vector<Property>> DataCache::_cachedOutputs;
-std::recursive_mutex DataCache::_cachedOutputsMutex;
+OutputCache DataCache::_cachedOutputs;
+MemoCache DataCache::_memoCache;
+std::vector<int> DataCache::_memoizableTypes;
+std::atomic<uint64_t> DataCache::_generation{0};
 std::recursive_mutex DataCache::_processorMutex;
+std::atomic<bool> DataCache::_parallelEvaluation{false};
+std::atomic<size_t> DataCache::_cacheBudget{size_t(2) * 1024 * 1024 * 1024};
+std::shared_timed_mutex DataCache::_evaluationMutex;
+
 DataCache::DataCache(CacheContext *context)
     : node(nullptr),
+    cachedInputs(InputList::allocator_type(EvaluationArena::current())),
     startsocket(nullptr),
+    _evaluationGeneration(_generation),
     _context(context)
 {
 }
 
 DataCache::DataCache(const DNode *node, DataType t, CacheContext *context)
-    : node(node), type(t), _context(context)
+    : node(node),
+    cachedInputs(InputList::allocator_type(EvaluationArena::current())),
+    type(t),
+    _evaluationGeneration(_generation),
+    _context(context)
 {
     cacheInputs();
 }
 
 DataCache::DataCache(const DoutSocket *socket, CacheContext *context)
     : node(socket->getNode()),
+    cachedInputs(InputList::allocator_type(EvaluationArena::current())),
     type(socket->getType()),
     startsocket(socket),
+    _evaluationGeneration(_generation),
     _context(context)
 {
     cacheInputs();
@@ -162,6 +231,8 @@ DataCache::DataCache(const DataCache &other)
     cachedInputs(other.cachedInputs),
     type(other.type),
     startsocket(other.startsocket),
+    _evaluationGeneration(other._evaluationGeneration),
+    _outputs(other._outputs),
     _context(other._context)
 {
 }
@@ -174,6 +245,7 @@ void DataCache::init()
 {
     Signal::getHandler<DNode*>().connect("nodeDeleted", [] (DNode* node) {
         DataCache::invalidate(node);
+        DataCache::invalidateNode(node);
     }).detach();
 }
 
@@ -191,60 +263,97 @@ void DataCache::invalidateNode(const DNode *node)
 {
     if(!node) return;
 
-    {
-        std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-        auto cacheIter = _cachedOutputs.find(node);
-        if(cacheIter == end(_cachedOutputs))
-            return;
-
-        _cachedOutputs.erase(cacheIter);
-    }
+    _cachedOutputs.erase(node);
 }
 
-void DataCache::invalidate(const DNode *node)
+/*
+ * Invalidation does not erase anything, it stamps the node and everything
+ * downstream of it with a new generation. Cached outputs from an
+ * evaluation that started before that generation are considered stale
+ * when they are read.
+ * Every node is visited at most once per invalidation. Nodes that are
+ * already stale are stamped but not followed, everything downstream of
+ * them went stale with them.
+ * If a scope is given the invalidation does not leave that container.
+ */
+void DataCache::invalidate(const DNode *node, const ContainerNode *scope)
 {
-    invalidateNode(node);
+    if(!node) return;
+
+    const uint64_t generation = ++_generation;
+    std::vector<const DNode*> stack;
+
+    auto mark = [&stack, generation] (const DNode *n) {
+        if(n->getCacheGeneration() >= generation) return;
 
-    //recursively invalidate everything following this node
-    for(const auto *out : node->getOutSockets()) {
-        for(const auto *ins : out->getCntdSockets()) {
-            DNode* n = ins->getNode();
-            if(n->getBuildInType() == DNode::SOCKETNODE) {
-                ContainerNode *cnode = dynamic_cast<SocketNode*>(n)->getContainer();
-                invalidateNode(cnode);
-                for(auto cout : cnode->getOutSockets()) {
-                    for(auto *cntdOnCont : cout->getCntdSockets()) {
-                        invalidate(cntdOnCont->getNode());
-                    }
+        bool stale = false;
+        if(n->getBuildInType() == DNode::NODE) {
+            auto entry = _cachedOutputs.get(n);
+            stale = entry.outputs && entry.generation < n->getCacheGeneration();
+        }
+
+        n->setCacheGeneration(generation);
+        if(!stale) stack.push_back(n);
+    };
+
+    mark(node);
+    while(!stack.empty()) {
+        const DNode *n = stack.back();
+        stack.pop_back();
+
+        for(const DSocket *out : *n->getOutSocketLlist()) {
+            for(const auto *ins : out->toOut()->getCntdSockets()) {
+                DNode* cntd = ins->getNode();
+                if(cntd->getBuildInType() != DNode::SOCKETNODE) {
+                    mark(cntd);
+                    continue;
                 }
-            } else {
-                invalidate(ins->getNode());
+
+                ContainerNode *cnode = cntd->getDerived<SocketNode>()->getContainer();
+                if(cnode == scope) continue;
+
+                if(cnode->getCacheGeneration() >= generation) continue;
+                cnode->setCacheGeneration(generation);
+                for(auto cout : cnode->getOutSockets())
+                    for(auto *cntdOnCont : cout->getCntdSockets())
+                        mark(cntdOnCont->getNode());
             }
         }
-    }
 
-    if(node->getBuildInType() == DNode::CONTAINER) {
-        const auto *contnode = node->getDerivedConst<ContainerNode>();
-        auto *contData = contnode->getContainerData();
-        if(contData)
-            for (const auto n : contnode->getContainerData()->getNodes())
-                invalidate(n.get());
+        if(n->getBuildInType() == DNode::CONTAINER) {
+            auto *contData = n->getDerivedConst<ContainerNode>()->getContainerData();
+            if(contData)
+                for (const auto &contained : contData->getNodes())
+                    mark(contained.get());
+        }
     }
-
 }
 
 bool DataCache::isCached(const DNode *node)
 {
-    std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-    bool cached = (_cachedOutputs.find(node) != end(_cachedOutputs))
-        && (!_cachedOutputs[node].empty());
-    return cached;
+    auto entry = _cachedOutputs.get(node);
+    return entry.outputs
+        && !entry.outputs->empty()
+        && entry.generation >= node->getCacheGeneration();
+}
+
+bool DataCache::hasOutputs(const DNode *node, CacheContext *context)
+{
+    if(context && context->isIsolated())
+        return !context->getOutputs(node).empty();
+    return isCached(node);
+}
+
+bool DataCache::isIsolated() const
+{
+    return _context && _context->isIsolated();
 }
 
 void DataCache::start(const DoutSocket *socket)
 {
     startsocket = socket;
     cachedInputs.clear();
+    _outputs.reset();
     if(socket) {
         node = socket->getNode();
         type = socket->getType();
@@ -257,27 +366,128 @@ int DataCache::getTypeID() const
     return  type.id();
 }
 
-std::vector<Property>& DataCache::_getCachedOutputs()
+Property DataCache::getCachedData(const DNode *node, int output)
 {
-    return getCachedOutputs(node);
+    auto entry = _cachedOutputs.get(node);
+    const auto &outputs = entry.outputs;
+    size_t i = output;
+    if(!outputs
+       || entry.generation < node->getCacheGeneration()
+       || output < 0
+       || i >= outputs->size()
+       || !(*outputs)[i])
+        return Property();
+    return *(*outputs)[i];
 }
 
-Property DataCache::getCachedData(const DNode *node, int output)
+OutputCache::Statistics DataCache::getCacheStatistics()
 {
-    std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-    auto it = _cachedOutputs.find(node);
-    if(it == end(_cachedOutputs)
-       || it->second.size() <= output)
-        return Property();
-    return it->second[output];
+    return _cachedOutputs.getStatistics();
 }
 
-std::vector<Property>& DataCache::getCachedOutputs(const DNode *node)
+void DataCache::resetCacheStatistics()
 {
-    std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-    if(_cachedOutputs.find(node) == end(_cachedOutputs))
-        _cachedOutputs.insert({node, std::vector<Property>()});
-    return _cachedOutputs[node];
+    _cachedOutputs.resetStatistics();
+}
+
+void DataCache::setCacheBudget(size_t bytes)
+{
+    _cacheBudget = bytes;
+}
+
+size_t DataCache::getCacheBudget()
+{
+    return _cacheBudget;
+}
+
+//evaluations in flight hold the evaluation lock shared, eviction only
+//happens when no evaluation is running. top level caches take a
+//reference to their outputs before they release the lock, an eviction
+//in between can drop the entry but not the result they return
+size_t DataCache::evictCache(const DNode *keep)
+{
+    size_t budget = _cacheBudget;
+    if(!budget || _cachedOutputs.getBytes() <= budget) return 0;
+
+    std::unique_lock<std::shared_timed_mutex> lock(_evaluationMutex, std::try_to_lock);
+    if(!lock.owns_lock()) return 0;
+
+    size_t count = _cachedOutputs.evict(budget, [keep] (const DNode *n, const OutputCache::Entry &entry) {
+        if(n == keep) return HUGE_VAL;
+        if(entry.generation < n->getCacheGeneration()) return -1.0;
+        return entry.cost / std::max<size_t>(entry.bytes, 1);
+    });
+#ifdef DEBUG_CACHE
+    dbout("evicted " << count << " cached outputs");
+#endif
+    return count;
+}
+
+std::vector<std::pair<const DNode*, OutputCache::Entry>> DataCache::getCacheUsage()
+{
+    return _cachedOutputs.getEntries();
+}
+
+void DataCache::setMemoizable(NodeType type, bool memoizable)
+{
+    std::lock_guard<std::recursive_mutex> lock(_processorMutex);
+    auto it = std::find(begin(_memoizableTypes), end(_memoizableTypes), type.id());
+    if(memoizable && it == end(_memoizableTypes))
+        _memoizableTypes.push_back(type.id());
+    else if(!memoizable && it != end(_memoizableTypes))
+        _memoizableTypes.erase(it);
+
+    for(auto &p : processors)
+        for(auto &p_ : p.second)
+            if(p_.second && p_.second->getNodeType().id() == type.id())
+                p_.second->setMemoizable(memoizable);
+}
+
+bool DataCache::isMemoizable(NodeType type)
+{
+    std::lock_guard<std::recursive_mutex> lock(_processorMutex);
+    return std::find(begin(_memoizableTypes), end(_memoizableTypes), type.id())
+        != end(_memoizableTypes);
+}
+
+void DataCache::setMemoBudget(size_t bytes)
+{
+    _memoCache.setBudget(bytes);
+}
+
+size_t DataCache::getMemoBudget()
+{
+    return _memoCache.getBudget();
+}
+
+MemoCache::Statistics DataCache::getMemoStatistics()
+{
+    return _memoCache.getStatistics();
+}
+
+void DataCache::clearMemoCache()
+{
+    _memoCache.clear();
+    _memoCache.resetStatistics();
+}
+
+//evaluates all inputs and combines their content hashes,
+//fails if any input can't be hashed
+bool DataCache::computeMemoKey(MemoCache::Key &key, MemoCache::Inputs &inputs)
+{
+    size_t seed = node->getType().id();
+    hashCombine(seed, type.id());
+
+    size_t count = node->getInSockets().size();
+    inputs.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        inputs.push_back(getData(i));
+        if(!inputs.back().hash(seed))
+            return false;
+    }
+
+    key = seed;
+    return true;
 }
 
 DataType DataCache::getType() const
@@ -294,7 +504,8 @@ void DataCache::addProcessor(AbstractCacheProcessor *proc)
     if (processors.find(st) == processors.end())
         processors[st] = AbstractCacheProcessor::CacheList();
 
-    processors[st][nt] = std::unique_ptr<AbstractCacheProcessor>(proc);
+    proc->setMemoizable(isMemoizable(nt));
+    processors[st][nt] = std::shared_ptr<AbstractCacheProcessor>(proc);
 }
 
 void DataCache::removeProcessor(AbstractCacheProcessor *proc)
@@ -305,7 +516,8 @@ void DataCache::removeProcessor(AbstractCacheProcessor *proc)
 
 void DataCache::addGenericProcessor(GenericCacheProcessor *proc)
 {
-    _genericProcessors[proc->getNodeType()] = std::unique_ptr<AbstractCacheProcessor>(proc);
+    std::lock_guard<std::recursive_mutex> lock(_processorMutex);
+    _genericProcessors[proc->getNodeType()] = std::shared_ptr<AbstractCacheProcessor>(proc);
 }
 
 std::vector<AbstractCacheProcessor*> DataCache::getProcessors()
@@ -323,7 +535,7 @@ std::vector<AbstractCacheProcessor*> DataCache::getProcessors()
 //is connected by just taking the property of the input socket
 void DataCache::cache(const DinSocket *socket)
 {
-    auto insockets = node->getInSockets();
+    const auto &insockets = node->getInSockets();
 
     int index = std::distance(begin(insockets),
                               std::find(begin(insockets),
@@ -353,27 +565,24 @@ void DataCache::_pushInputData(Property prop, int index)
 
 void DataCache::pushData(Property prop, int index)
 {
-    std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-    auto &outputs = _getCachedOutputs();
-
-    size_t i = index;
-    if (index < 0 || i == outputs.size()) {
-        outputs.push_back(prop);
+    if(isIsolated()) {
+        auto outputs = _context->getOutputs(node);
+        size_t i = index < 0 ? outputs.size() : index;
+        _context->setOutput(node, i, std::make_shared<const Property>(std::move(prop)));
         return;
     }
 
-    if(static_cast<size_t>(index) < outputs.size()) {
-        outputs.resize(index + 1); 
-    }
-
-    outputs[index] = prop;
+    _cachedOutputs.set(node,
+                       index,
+                       std::make_shared<const Property>(std::move(prop)),
+                       _evaluationGeneration);
 }
 
 //returns the value of the input socket at index i
 Property DataCache::getData(int index)
 {
     size_t i = index;
-    auto insockets = node->getInSockets();
+    const auto &insockets = node->getInSockets();
 
     if (i >= insockets.size()) 
         return Property();
@@ -388,13 +597,20 @@ Property DataCache::getData(int index)
 
 Property DataCache::getOutput(int index)
 {
-    std::lock_guard<std::recursive_mutex> lock(_cachedOutputsMutex);
-    auto &outputs = _getCachedOutputs();
-    size_t i = index;
-    if(i >= outputs.size())
-        return Property();
-
-    return outputs[index];
+    if(isIsolated()) {
+        auto outputs = _context->getOutputs(node);
+        size_t i = index;
+        if(index < 0 || i >= outputs.size() || !outputs[i])
+            return Property();
+        return *outputs[i];
+    }
+    if(_outputs) {
+        size_t i = index;
+        if(index < 0 || i >= _outputs->size() || !(*_outputs)[i])
+            return Property();
+        return *(*_outputs)[i];
+    }
+    return getCachedData(node, index);
 }
 
 Property DataCache::getOutput(DoutSocket* socket)
@@ -443,52 +659,410 @@ void DataCache::setStart(const DoutSocket *socket)
     startsocket = socket;
 }
 
+void DataCache::setParallelEvaluation(bool parallel)
+{
+    _parallelEvaluation = parallel;
+}
+
+bool DataCache::isParallelEvaluation()
+{
+    return _parallelEvaluation;
+}
+
+ThreadPool& DataCache::getThreadPool()
+{
+    return ThreadPool::instance();
+}
+
+namespace
+{
+struct CacheTask {
+    const DoutSocket *socket = nullptr;
+    std::vector<size_t> dependents;
+    std::atomic<int> pendingInputs{0};
+    bool deferred = false;
+    bool visited = false;
+};
+
+struct CacheEvaluation {
+    std::vector<std::unique_ptr<CacheTask>> tasks;
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    //first failure of any task, rethrown on the waiting thread
+    std::exception_ptr error;
+    PyObject *pyType = nullptr;
+    PyObject *pyValue = nullptr;
+    PyObject *pyTraceback = nullptr;
+};
+
+//counts a task as finished however it leaves runCacheTask
+class FinishCacheTask
+{
+public:
+    FinishCacheTask(CacheEvaluation &evaluation)
+        : _evaluation(evaluation)
+    {
+    }
+
+    ~FinishCacheTask()
+    {
+        if(--_evaluation.remaining == 0) {
+            std::lock_guard<std::mutex> lock(_evaluation.mutex);
+            _evaluation.finished.notify_all();
+        }
+    }
+
+private:
+    CacheEvaluation &_evaluation;
+};
+
+void setCacheError(CacheEvaluation &evaluation, std::exception_ptr error, bool python)
+{
+    std::lock_guard<std::mutex> lock(evaluation.mutex);
+    if(evaluation.error) return;
+    evaluation.error = error;
+
+    //the python error indicator lives in the worker's thread state, move
+    //it over so the waiting thread can report it
+    if(python) {
+        MindTree::Python::GILLocker locker;
+        PyErr_Fetch(&evaluation.pyType, &evaluation.pyValue, &evaluation.pyTraceback);
+    }
+}
+
+void runCacheTask(ThreadPool &pool,
+                  std::shared_ptr<CacheEvaluation> evaluation,
+                  size_t index,
+                  CacheContext *context)
+{
+    FinishCacheTask finish(*evaluation);
+    auto &task = *evaluation->tasks[index];
+    try {
+        DataCache cache(task.socket, context);
+    } catch(const BPy::error_already_set&) {
+        setCacheError(*evaluation, std::current_exception(), true);
+    } catch(...) {
+        setCacheError(*evaluation, std::current_exception(), false);
+    }
+
+    for(size_t dependent : task.dependents) {
+        auto &next = *evaluation->tasks[dependent];
+        if(--next.pendingInputs == 0 && !next.deferred)
+            pool.submit([&pool, evaluation, dependent, context] {
+                runCacheTask(pool, evaluation, dependent, context);
+            });
+    }
+}
+}
+
+//builds the dependency graph of everything upstream of this node and
+//caches independent nodes concurrently, the processor of this node then
+//finds all its inputs already cached
+void DataCache::cacheInputsParallel()
+{
+    auto evaluation = std::make_shared<CacheEvaluation>();
+    auto &tasks = evaluation->tasks;
+    std::unordered_map<const DNode*, int> taskIndices;
+
+    //cached nodes are leaves, socket nodes depend on their container's
+    //context and are left to the serial evaluation with everything
+    //downstream of them
+    std::function<int(const DoutSocket*)> addTask = [&](const DoutSocket *out) {
+        const DNode *n = out->getNode();
+        auto it = taskIndices.find(n);
+        if(it != end(taskIndices)) return it->second;
+
+        if(hasOutputs(n, _context)) {
+            taskIndices[n] = -1;
+            return -1;
+        }
+
+        int index = tasks.size();
+        taskIndices[n] = index;
+        tasks.push_back(std::make_unique<CacheTask>());
+        tasks[index]->socket = out;
+
+        bool deferred = n->getBuildInType() == DNode::SOCKETNODE;
+        for(const auto *in : n->getInSockets()) {
+            const DoutSocket *cntd = in->getCntdSocket();
+            if(!cntd) continue;
+
+            int dep = addTask(cntd);
+            if(dep < 0) continue;
+
+            //cyclic connection, leave it to the serial evaluation
+            if(!tasks[dep]->visited) {
+                deferred = true;
+                continue;
+            }
+
+            deferred = deferred || tasks[dep]->deferred;
+            tasks[dep]->dependents.push_back(index);
+            ++tasks[index]->pendingInputs;
+        }
+        tasks[index]->deferred = deferred;
+        tasks[index]->visited = true;
+        return index;
+    };
+
+    for(const auto *in : node->getInSockets())
+        if(in->getCntdSocket())
+            addTask(in->getCntdSocket());
+
+    std::vector<size_t> ready;
+    size_t count = 0;
+    for(size_t i = 0; i < tasks.size(); ++i) {
+        if(tasks[i]->deferred) continue;
+        ++count;
+        if(tasks[i]->pendingInputs == 0) ready.push_back(i);
+    }
+
+    if(count < 2) return;
+
+    evaluation->remaining = count;
+    auto &pool = getThreadPool();
+    CacheContext *context = _context;
+    for(size_t index : ready)
+        pool.submit([&pool, evaluation, index, context] {
+            runCacheTask(pool, evaluation, index, context);
+        });
+
+    auto wait = [&evaluation] {
+        std::unique_lock<std::mutex> lock(evaluation->mutex);
+        evaluation->finished.wait(lock, [&evaluation] {
+            return evaluation->remaining == 0;
+        });
+    };
+
+    //python processors need the GIL on the worker threads
+    if(Py_IsInitialized() && PyGILState_Check()) {
+        Python::GILReleaser releaser;
+        wait();
+    }
+    else {
+        wait();
+    }
+
+    if(evaluation->error) {
+        if(evaluation->pyType) {
+            MindTree::Python::GILLocker locker;
+            PyErr_Restore(evaluation->pyType, evaluation->pyValue, evaluation->pyTraceback);
+        }
+        std::rethrow_exception(evaluation->error);
+    }
+}
+
+namespace
+{
+thread_local int evaluationDepth = 0;
+thread_local double nestedEvaluationTime = 0;
+
+struct EvaluationDepth {
+    EvaluationDepth() { ++evaluationDepth; }
+    ~EvaluationDepth() { --evaluationDepth; }
+};
+
+//measures the time spent in a processor with and without the time
+//spent evaluating its inputs, the clock is read once on either end
+class EvaluationTimer
+{
+public:
+    EvaluationTimer()
+        : _start(std::chrono::steady_clock::now()),
+        _outerNestedTime(nestedEvaluationTime),
+        _selfTime(0),
+        _inclusiveTime(0),
+        _stopped(false)
+    {
+        nestedEvaluationTime = 0;
+    }
+
+    ~EvaluationTimer()
+    {
+        if(!_stopped) stop();
+        nestedEvaluationTime = _outerNestedTime + _inclusiveTime;
+    }
+
+    void stop()
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start;
+        _inclusiveTime = elapsed.count();
+        _selfTime = _inclusiveTime - nestedEvaluationTime;
+        _stopped = true;
+    }
+
+    std::chrono::steady_clock::time_point getStart() const
+    {
+        return _start;
+    }
+
+    double getSelfTime() const
+    {
+        return _selfTime;
+    }
+
+    double getInclusiveTime() const
+    {
+        return _inclusiveTime;
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+    double _outerNestedTime;
+    double _selfTime;
+    double _inclusiveTime;
+    bool _stopped;
+};
+}
+
 void DataCache::cacheInputs()
 {
-    if(isCached(node))
+    bool toplevel = !evaluationDepth && !ThreadPool::isWorkerThread();
+    std::shared_lock<std::shared_timed_mutex> lock(_evaluationMutex, std::defer_lock);
+    if(toplevel) lock.lock();
+
+    if(hasOutputs(node, _context)) {
+        EvaluationProfiler::recordHit(node);
+        if(toplevel && !isIsolated()) _outputs = _cachedOutputs.get(node).outputs;
         return;
+    }
+
+    {
+        //only the outermost scope on this thread releases the arena,
+        //after every nested cache is gone
+        EvaluationArena::Scope arena;
+        EvaluationDepth depth;
+        runProcessor();
+    }
+
+    if(!toplevel) return;
+
+    if(!isIsolated()) _outputs = _cachedOutputs.get(node).outputs;
+    lock.unlock();
+    evictCache(node);
+}
+
+void DataCache::callProcessor(AbstractCacheProcessor &processor,
+                              std::chrono::steady_clock::time_point inputStart)
+{
+    EvaluationTimer timer;
+    processor(this);
+    timer.stop();
+    if(!isIsolated()) _cachedOutputs.setCost(node, timer.getSelfTime());
+
+    if(EvaluationProfiler::isEnabled()) {
+        size_t bytes = 0;
+        if(!isIsolated()) {
+            auto entry = _cachedOutputs.get(node);
+            if(entry.generation == _evaluationGeneration) bytes = entry.bytes;
+        }
+        //inputs cached concurrently or for the memo key were evaluated
+        //before the processor ran, serially they are part of it
+        std::chrono::duration<double> inputTime = timer.getStart() - inputStart;
+        EvaluationProfiler::recordCall(node,
+                                       inputStart,
+                                       timer.getSelfTime(),
+                                       timer.getInclusiveTime() + inputTime.count(),
+                                       bytes);
+    }
+}
 
-    auto ntype = node->getType();
+void DataCache::runProcessor()
+{
+    _evaluationGeneration = _generation;
+    cachedInputs.reserve(node->getInSockets().size());
+
+    auto inputStart = EvaluationProfiler::isEnabled()
+        ? std::chrono::steady_clock::now()
+        : std::chrono::steady_clock::time_point();
+    //only the outermost cache on this thread schedules the upstream
+    //graph, nested ones would walk the same graph again on every level
+    if(_parallelEvaluation && evaluationDepth == 1 && !ThreadPool::isWorkerThread())
+        cacheInputsParallel();
+
+    const auto &ntype = node->getType();
     unsigned long nodeTypeID = ntype.id();
-    std::string nodeName = node->getNodeName();
 
-    const auto &genericProcessor = _genericProcessors[ntype];
+    std::shared_ptr<AbstractCacheProcessor> genericProcessor;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_processorMutex);
+        auto it = _genericProcessors.find(ntype);
+        if(it != end(_genericProcessors))
+            genericProcessor = it->second;
+    }
     if(genericProcessor) {
-        (*genericProcessor)(this);
+        callProcessor(*genericProcessor, inputStart);
         return;
     }
 
-    std::lock_guard<std::recursive_mutex> lock(_processorMutex);
-    if(processors.find(type) == processors.end()){
-        std::cout<< "no processors defined for this data type ("
-                 << type.toStr()
-                 << " id:"
-                 << type.id()
-                 << ")"
-                 << std::endl;
-        return;
-    }
-    const auto &list = processors[type];
-    if(list.find(ntype) == list.end()){
-        std::cout<< "no processors defined for this node type ("
-                 << node->getType().toStr()
-                 << " id:"
-                 <<nodeTypeID
-                 <<")"
-                 << " on node: "
-                 << nodeName
-                 << std::endl;
-        return;
+    //only hold the lock for the lookup so processors can run concurrently,
+    //the shared_ptr keeps the processor alive if it gets replaced meanwhile
+    std::shared_ptr<AbstractCacheProcessor> datacache;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_processorMutex);
+        if(processors.find(type) == processors.end()){
+            std::cout<< "no processors defined for this data type ("
+                     << type.toStr()
+                     << " id:"
+                     << type.id()
+                     << ")"
+                     << std::endl;
+            return;
+        }
+        const auto &list = processors[type];
+        if(list.find(ntype) == list.end()){
+            std::cout<< "no processors defined for this node type ("
+                     << node->getType().toStr()
+                     << " id:"
+                     <<nodeTypeID
+                     <<")"
+                     << " on node: "
+                     << node->getNodeName()
+                     << std::endl;
+            return;
+        }
+        datacache = list.at(node->getType());
     }
-    const auto &datacache = list.at(node->getType());
     if(!datacache) {
         std::cout<<"Node Type ID:" << nodeTypeID << std::endl;
         std::cout<<"Socket Type ID:" << type.id() << std::endl;
         return;
     }
-    (*datacache)(this);
+
+    MemoCache::Key key;
+    MemoCache::Signature signature{node->getType().id(), type.id()};
+    MemoCache::Inputs inputs;
+    bool memoize = datacache->isMemoizable() && computeMemoKey(key, inputs);
+    OutputCache::Outputs outputs;
+    if(memoize && _memoCache.find(key, signature, inputs, outputs)) {
+        for(size_t i = 0; i < outputs.size(); ++i) {
+            if(isIsolated()) _context->setOutput(node, i, outputs[i]);
+            else _cachedOutputs.set(node, i, outputs[i], _evaluationGeneration);
+        }
+        EvaluationProfiler::recordHit(node);
+#ifdef DEBUG_CACHE
+        dbout("reused memoized outputs: " << node->getNodeName());
+#endif
+        return;
+    }
+
+    callProcessor(*datacache, inputStart);
+
+    if(memoize && isIsolated()) {
+        outputs = _context->getOutputs(node);
+        if(!outputs.empty()) _memoCache.insert(key, signature, inputs, outputs);
+    }
+    else if(memoize) {
+        auto entry = _cachedOutputs.get(node);
+        if(entry.outputs && entry.generation == _evaluationGeneration)
+            _memoCache.insert(key, signature, inputs, *entry.outputs);
+    }
+
     std::string status = "done caching caching: " + node->getNodeName();
     MT_SIGNAL_EMITTER("STATUSUPDATE", status);
+#ifdef DEBUG_CACHE
     dbout(status);
-
+#endif
 }
@@ -20,8 +20,14 @@
 
 #define CACHE_MAIN_PD1QWTW9
 
+#include "chrono"
 #include "mutex"
+#include "shared_mutex"
+#include "atomic"
 #include "data/type.h"
+#include "data/arena.h"
+#include "data/output_cache.h"
+#include "data/memo_cache.h"
 #include "data/nodes/data_node_socket.h"
 #include "data/nodes/containernode.h"
 
@@ -34,7 +40,7 @@ class DataCache;
 class CacheContext
 {
 public:
-    CacheContext(const LoopNode *node);
+    CacheContext(const LoopNode *node, bool isolated=false, CacheContext *parent=nullptr);
     virtual ~CacheContext();
 
     void addData(size_t index, Property prop);
@@ -42,18 +48,38 @@ public:
     Property getData(size_t i);
     virtual const LoopNode* getNode();
 
+    //an isolated context keeps the outputs of the nodes evaluated in it
+    //to itself instead of the shared output cache, several of them can
+    //evaluate the same nodes at once
+    bool isIsolated() const;
+    void setOutput(const DNode *node, size_t index, OutputCache::PropertyPtr prop);
+    OutputCache::Outputs getOutputs(const DNode *node) const;
+
+    //drops the outputs of the given nodes, only this context is affected
+    void clearOutputs(const std::vector<const DNode*> &nodes);
+
+    //the context the loop node itself is evaluated in, its inputs have to
+    //be evaluated there as well
+    CacheContext* getParent() const;
+
 private:
     const LoopNode *_node;
+    CacheContext *_parent;
     std::vector<Property> _data;
 
+    const bool _isolated;
+    mutable std::mutex _outputsMutex;
+    std::unordered_map<const DNode*, OutputCache::Outputs> _outputs;
 };
 
 class LoopCache : public CacheContext
 {
 public:
-    LoopCache(const LoopNode *node);
+    LoopCache(const LoopNode *node, bool isolated=false, CacheContext *parent=nullptr);
     ~LoopCache();
 
+    //isolated loops clear the step dependent outputs themselves, shared
+    //ones invalidate the loop body in the output cache
     void setStep(int step);
     int getStep()const;
 
@@ -64,7 +90,7 @@ private:
 class AbstractCacheProcessor
 {
 public:
-    typedef TypeDispatcher<NodeType, std::unique_ptr<AbstractCacheProcessor>> CacheList;
+    typedef TypeDispatcher<NodeType, std::shared_ptr<AbstractCacheProcessor>> CacheList;
 
     AbstractCacheProcessor(SocketType st, NodeType nt);
     virtual ~AbstractCacheProcessor();
@@ -74,9 +100,15 @@ public:
     const SocketType& getSocketType() const;
     const NodeType& getNodeType() const;
 
+    //mirrors DataCache::isMemoizable for the node type so evaluations
+    //don't have to look it up
+    bool isMemoizable() const;
+    void setMemoizable(bool memoizable);
+
 private:
     SocketType m_socketType;
     NodeType m_nodeType;
+    std::atomic<bool> m_memoizable;
 };
 
 class CacheProcessor : public AbstractCacheProcessor
@@ -97,6 +129,8 @@ public:
         CacheProcessor("", nt, fn) {}
 };
 
+class ThreadPool;
+
 class DataCache
 {
 public:
@@ -130,31 +164,74 @@ public:
     static void removeProcessor(AbstractCacheProcessor *proc);
     static void addGenericProcessor(GenericCacheProcessor *proc);
     static std::vector<AbstractCacheProcessor*> getProcessors();
-    static void invalidate(const DNode *node);
+    static void invalidate(const DNode *node, const ContainerNode *scope=nullptr);
     static bool isCached(const DNode *node);
 
     CacheContext* getContext();
     void setContext(CacheContext *context);
     static Property getCachedData(const DNode *node, int output=0);
 
+    //independent inputs are cached concurrently and foreach loops
+    //without nested loops run their iterations concurrently
+    static void setParallelEvaluation(bool parallel);
+    static bool isParallelEvaluation();
+
+    static OutputCache::Statistics getCacheStatistics();
+    static void resetCacheStatistics();
+
+    //the output cache is trimmed to the budget after every top level
+    //evaluation, stale and cheap to recompute outputs go first.
+    //a budget of 0 disables eviction
+    static void setCacheBudget(size_t bytes);
+    static size_t getCacheBudget();
+    static size_t evictCache(const DNode *keep=nullptr);
+    static std::vector<std::pair<const DNode*, OutputCache::Entry>> getCacheUsage();
+
+    //processors of memoizable node types only depend on their inputs,
+    //their results are reused for inputs with identical content
+    static void setMemoizable(NodeType type, bool memoizable=true);
+    static bool isMemoizable(NodeType type);
+    static void setMemoBudget(size_t bytes);
+    static size_t getMemoBudget();
+    static MemoCache::Statistics getMemoStatistics();
+    static void clearMemoCache();
+
 private:
     static void invalidateNode(const DNode *node);
-    std::vector<Property>& _getCachedOutputs();
-    static std::vector<Property>& getCachedOutputs(const DNode *node);
+    static ThreadPool& getThreadPool();
+    static bool hasOutputs(const DNode *node, CacheContext *context);
+    bool isIsolated() const;
     void _pushInputData(Property prop, int index = -1);
 
     void cacheInputs();
+    void runProcessor();
+    void callProcessor(AbstractCacheProcessor &processor,
+                       std::chrono::steady_clock::time_point inputStart);
+    void cacheInputsParallel();
+    bool computeMemoKey(MemoCache::Key &key, MemoCache::Inputs &inputs);
     void cache(const DinSocket *socket);
 
     const DNode *node;
     static TypeDispatcher<SocketType, AbstractCacheProcessor::CacheList> processors;
     static AbstractCacheProcessor::CacheList _genericProcessors;
-    std::vector<Property> cachedInputs;
+    //nested caches only live for one evaluation, their inputs come from
+    //the evaluation arena
+    typedef std::vector<Property, ArenaAllocator<Property>> InputList;
+    InputList cachedInputs;
     SocketType type;
     const DoutSocket *startsocket;
-    static std::unordered_map<const DNode*, std::vector<Property>> _cachedOutputs;
-    static std::recursive_mutex _cachedOutputsMutex;
+    static OutputCache _cachedOutputs;
+    static MemoCache _memoCache;
+    static std::vector<int> _memoizableTypes;
+    static std::atomic<uint64_t> _generation;
+    uint64_t _evaluationGeneration;
+    //the outputs of a top level evaluation, read from here so an
+    //eviction after the evaluation can't take them away
+    OutputCache::OutputsPtr _outputs;
     static std::recursive_mutex _processorMutex;
+    static std::atomic<bool> _parallelEvaluation;
+    static std::atomic<size_t> _cacheBudget;
+    static std::shared_timed_mutex _evaluationMutex;
 
     CacheContext *_context;
 };
@@ -75,9 +75,11 @@ DNSpace::DNSpace(const DNSpace &space)
 DNSpace::~DNSpace()
 {
     //try to clear all links before deleting nodes
-    for(auto node : getNodes())
-        for(auto *socket : node->getInSockets())
+    for(auto node : getNodes()) {
+        DinSocketList ins = node->getInSockets();
+        for(auto *socket : ins)
             socket->clearLink();
+    }
 
     for(auto node : getNodes())
         removeNode(node);
@@ -0,0 +1,127 @@
+#include "data/properties.h"
+
+#include "memo_cache.h"
+
+using namespace MindTree;
+
+MemoCache::MemoCache(size_t budget)
+    : _bytes(0), _budget(budget), _hits(0), _misses(0), _collisions(0), _evictions(0)
+{
+}
+
+namespace {
+bool equalInputs(const MemoCache::Inputs &lhs, const MemoCache::Inputs &rhs)
+{
+    if(lhs.size() != rhs.size()) return false;
+    for(size_t i = 0; i < lhs.size(); ++i)
+        if(!lhs[i].equals(rhs[i]))
+            return false;
+    return true;
+}
+}
+
+bool MemoCache::find(Key key,
+                     const Signature &signature,
+                     const Inputs &inputs,
+                     OutputCache::Outputs &outputs)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _index.find(key);
+    if(it == end(_index)) {
+        ++_misses;
+        return false;
+    }
+
+    if(!(it->second->signature == signature)
+       || !equalInputs(it->second->inputs, inputs)) {
+        ++_collisions;
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+    _items.splice(begin(_items), _items, it->second);
+    outputs = it->second->outputs;
+    return true;
+}
+
+void MemoCache::insert(Key key,
+                       const Signature &signature,
+                       const Inputs &inputs,
+                       const OutputCache::Outputs &outputs)
+{
+    //the inputs are kept alive with the result
+    size_t bytes = 0;
+    for(const auto &prop : inputs)
+        bytes += prop.getByteSize();
+    for(const auto &prop : outputs)
+        if(prop) bytes += prop->getByteSize();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(bytes > _budget) return;
+
+    auto it = _index.find(key);
+    if(it != end(_index)) {
+        _bytes -= it->second->bytes;
+        _items.erase(it->second);
+    }
+
+    _items.push_front(Item{key, signature, inputs, outputs, bytes});
+    _index[key] = begin(_items);
+    _bytes += bytes;
+    evict();
+}
+
+void MemoCache::evict()
+{
+    while(_bytes > _budget && !_items.empty()) {
+        const Item &oldest = _items.back();
+        _bytes -= oldest.bytes;
+        _index.erase(oldest.key);
+        _items.pop_back();
+        ++_evictions;
+    }
+}
+
+void MemoCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _items.clear();
+    _index.clear();
+    _bytes = 0;
+}
+
+void MemoCache::setBudget(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = budget;
+    evict();
+}
+
+size_t MemoCache::getBudget() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+MemoCache::Statistics MemoCache::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Statistics stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.collisions = _collisions;
+    stats.evictions = _evictions;
+    stats.entries = _items.size();
+    stats.bytes = _bytes;
+    return stats;
+}
+
+void MemoCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hits = 0;
+    _misses = 0;
+    _collisions = 0;
+    _evictions = 0;
+}
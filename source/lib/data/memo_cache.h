@@ -0,0 +1,94 @@
+#ifndef MT_MEMO_CACHE_H
+#define MT_MEMO_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "data/output_cache.h"
+#include "data/properties.h"
+
+namespace MindTree
+{
+
+/*
+ * Memoized processor results keyed on a hash of the node type, the
+ * requested socket type and the content of every input. The node type,
+ * socket type and inputs are stored with the result and compared on
+ * every hit, a hash collision counts as a miss.
+ *
+ * Entries are kept in least recently used order, whenever the stored
+ * outputs exceed the byte budget the oldest entries are dropped.
+ */
+class MemoCache
+{
+public:
+    typedef uint64_t Key;
+    typedef std::vector<Property> Inputs;
+
+    //ids of the node type and socket type a result was computed for
+    struct Signature {
+        int nodeType;
+        int socketType;
+
+        bool operator==(const Signature &other) const
+        {
+            return nodeType == other.nodeType && socketType == other.socketType;
+        }
+    };
+
+    struct Statistics {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t collisions;
+        uint64_t evictions;
+        size_t entries;
+        size_t bytes;
+    };
+
+    MemoCache(size_t budget=256 * 1024 * 1024);
+
+    bool find(Key key,
+              const Signature &signature,
+              const Inputs &inputs,
+              OutputCache::Outputs &outputs);
+    void insert(Key key,
+                const Signature &signature,
+                const Inputs &inputs,
+                const OutputCache::Outputs &outputs);
+    void clear();
+
+    void setBudget(size_t budget);
+    size_t getBudget() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    struct Item {
+        Key key;
+        Signature signature;
+        Inputs inputs;
+        OutputCache::Outputs outputs;
+        size_t bytes;
+    };
+    typedef std::list<Item> ItemList;
+
+    void evict();
+
+    mutable std::mutex _mutex;
+    ItemList _items;
+    std::unordered_map<Key, ItemList::iterator> _index;
+    size_t _bytes;
+    size_t _budget;
+
+    uint64_t _hits;
+    uint64_t _misses;
+    uint64_t _collisions;
+    uint64_t _evictions;
+};
+
+}
+
+#endif
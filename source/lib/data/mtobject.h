@@ -21,7 +21,7 @@ public:
 
     PropertyMap getProperties()const;
     virtual void setProperty(const std::string&, Property value);
-    void rmProperty(const std::string &name);
+    virtual void rmProperty(const std::string &name);
     bool hasProperty(const std::string &name) const;
 
 private:
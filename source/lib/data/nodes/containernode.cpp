@@ -437,6 +437,9 @@ WhileNode::WhileNode(bool raw)
     setType("WHILE");
     if(!raw)
     {
+        auto *maxIterations = new DinSocket("Max Iterations", "INTEGER", this);
+        maxIterations->setProperty(1000);
+        addMappedSocket(maxIterations);
         new DinSocket("Condition", "BOOLEAN", getOutputs());
     }
 }
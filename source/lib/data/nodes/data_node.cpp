@@ -29,6 +29,7 @@
 using namespace MindTree;
 
 unsigned short DNode::count = 1;
+std::atomic<uint64_t> DNode::_uniqueCount{1};
 std::unordered_map<unsigned short, NodePtr>LoadNodeIDMapper::loadIDMapper;
 std::unordered_map<DNode*, DNode*> CopyNodeMapper::nodeMap;
 std::vector<std::function<NodePtr()>> DNode::newNodeDecorator;
@@ -74,6 +75,7 @@ DNode::DNode(std::string name)
           lastsocket(nullptr),
           varcnt(0),
           ID(count++),
+          _uniqueID(_uniqueCount++),
           nodeName(name),
           _signalLiveTime(new Signal::LiveTimeTracker(this)),
           _buildInType(NODE)
@@ -85,6 +87,7 @@ DNode::DNode(const DNode& node)
     space(nullptr),
     varcnt(0),
     ID(count++),
+    _uniqueID(_uniqueCount++),
     nodeName(node.nodeName),
     type(node.getType()),
     _signalLiveTime(new Signal::LiveTimeTracker(this)),
@@ -104,7 +107,9 @@ DNode::DNode(const DNode& node)
 DNode::~DNode()
 {
     MT_CUSTOM_SIGNAL_EMITTER("nodeDeleted", this);
-    for (auto *in : getInSockets())
+    //clearing a link can remove variable sockets, iterate over a copy
+    DinSocketList ins = getInSockets();
+    for (auto *in : ins)
         in->clearLink();
 
     for (auto *out : getOutSockets())
@@ -117,6 +122,18 @@ DNode::~DNode()
         delete socket;
 }
 
+uint64_t DNode::getCacheGeneration() const
+{
+    return _cacheGeneration;
+}
+
+void DNode::setCacheGeneration(uint64_t generation) const
+{
+    uint64_t current = _cacheGeneration;
+    while(current < generation
+          && !_cacheGeneration.compare_exchange_weak(current, generation));
+}
+
 DNode::BuildInType DNode::getBuildInType() const
 {
     return _buildInType;
@@ -256,10 +273,12 @@ void DNode::addSocket(DSocket *socket)
     setSocketIDName(socket);
     if(socket->getDir()== DSocket::IN) {
         inSockets.push_back(socket);
+        typedInSockets.push_back(socket->toIn());
         MT_CUSTOM_BOUND_SIGNAL_EMITTER(_signalLiveTime.get(), "inSocketAdded");
     }
     else {
         outSockets.push_back(socket);
+        typedOutSockets.push_back(socket->toOut());
         MT_CUSTOM_BOUND_SIGNAL_EMITTER(_signalLiveTime.get(), "outSocketAdded");
     }
 
@@ -299,11 +318,13 @@ void DNode::removeSocket(DSocket *socket)
     if(!socket)return;
     if(socket->getDir() == DSocket::IN) {
         auto it = std::find(inSockets.begin(), inSockets.end(), socket);
+        typedInSockets.erase(typedInSockets.begin() + std::distance(inSockets.begin(), it));
         inSockets.erase(it);
         delete socket;
     }
     else {
         auto it = std::find(outSockets.begin(), outSockets.end(), socket);
+        typedOutSockets.erase(typedOutSockets.begin() + std::distance(outSockets.begin(), it));
         outSockets.erase(it);
         delete socket;
     }
@@ -365,7 +386,8 @@ void DNode::createNewVarSocket_(DSocket::SocketDir dir)
 
 void DNode::clearSocketLinks()
 {
-    for(DinSocket *socket : getInSockets())
+    DinSocketList ins = getInSockets();
+    for(DinSocket *socket : ins)
        socket->clearLink();
 }
 
@@ -384,12 +406,14 @@ void DNode::setID(unsigned short value)
     ID = value;
 }
 
-DoutSocketList DNode::getOutSockets() const
+uint64_t DNode::getUniqueID() const
+{
+    return _uniqueID;
+}
+
+const DoutSocketList& DNode::getOutSockets() const
 {
-    DoutSocketList out;
-    for(DSocket *socket : outSockets)
-        out.push_back(socket->toOut());
-    return out;
+    return typedOutSockets;
 }
 
 DSocketList *DNode::getOutSocketLlist() const
@@ -401,12 +425,9 @@ void DNode::setOutSockets(DoutSocketList value)
 {
 }
 
-DinSocketList DNode::getInSockets() const
+const DinSocketList& DNode::getInSockets() const
 {
-    DinSocketList in;
-    for(DSocket *socket : inSockets)
-        in.push_back(socket->toIn());
-    return in;
+    return typedInSockets;
 }
 
 DSocketList* DNode::getInSocketLlist()    const
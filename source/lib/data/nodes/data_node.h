@@ -26,6 +26,8 @@
 #include "data/signal.h"
 #include "data/mtobject.h"
 
+#include "atomic"
+#include "cstdint"
 #include "functional"
 #include "memory"
 
@@ -113,9 +115,13 @@ public:
 
     unsigned short getID() const;
     void setID(unsigned short value);
+
+    //unlike the id this is never reused or changed by loading, it
+    //identifies the node for as long as the process runs
+    uint64_t getUniqueID() const;
     void setOutSockets(DoutSocketList value);
-    DoutSocketList getOutSockets() const;
-    DinSocketList getInSockets() const;
+    const DoutSocketList& getOutSockets() const;
+    const DinSocketList& getInSockets() const;
     DSocketList* getInSocketLlist() const;
     DSocketList *getOutSocketLlist() const;
     void setInSockets(DinSocketList value);
@@ -140,6 +146,10 @@ public:
     DNode *createFuncNode(std::string filepath);
     static DNode *dropNode(std::string filepath);
 
+    //generation of the last invalidation of this node's cached outputs
+    uint64_t getCacheGeneration() const;
+    void setCacheGeneration(uint64_t generation) const;
+
 protected:
     inline void setBuildInType(BuildInType t)
     {
@@ -159,13 +169,20 @@ private:
     int varcnt;
     unsigned short ID;
     static unsigned short count;
+    const uint64_t _uniqueID;
+    static std::atomic<uint64_t> _uniqueCount;
     std::string nodeName;
     mutable DSocketList outSockets;
     mutable DSocketList inSockets;
+    //the same sockets as above, kept in sync so they can be handed out
+    //without building a new list on every call
+    DoutSocketList typedOutSockets;
+    DinSocketList typedInSockets;
     NodeType type;
     Vec2i pos;
 
     std::unique_ptr<Signal::LiveTimeTracker> _signalLiveTime;
+    mutable std::atomic<uint64_t> _cacheGeneration{0};
 };
 
 template<class C>
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cmath>
+
+#include "data/properties.h"
+
+#include "output_cache.h"
+
+using namespace MindTree;
+
+OutputCache::OutputCache()
+    : _writes(0), _erases(0), _contentions(0), _evictions(0), _bytes(0)
+{
+}
+
+size_t OutputCache::getShardIndex(const void *ptr)
+{
+    auto address = reinterpret_cast<uintptr_t>(ptr);
+    return ((address >> 4) ^ (address >> 12)) % SHARD_COUNT;
+}
+
+OutputCache::Shard& OutputCache::getShard(const DNode *node)
+{
+    return _shards[getShardIndex(node)];
+}
+
+const OutputCache::Shard& OutputCache::getShard(const DNode *node) const
+{
+    return const_cast<OutputCache*>(this)->getShard(node);
+}
+
+std::unique_lock<std::shared_timed_mutex> OutputCache::lockShard(Shard &shard)
+{
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex, std::try_to_lock);
+    if(!lock.owns_lock()) {
+        ++_contentions;
+        lock.lock();
+    }
+    return lock;
+}
+
+void OutputCache::addPayload(const PropertyPtr &prop)
+{
+    const void *id = prop ? prop->getPayloadId() : nullptr;
+    if(!id) return;
+
+    auto &shard = _payloads[getShardIndex(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.payloads.find(id);
+    if(it != shard.payloads.end()) {
+        ++it->second.references;
+        return;
+    }
+
+    //a referenced payload stays alive, its address can't be reused
+    size_t bytes = prop->getByteSize();
+    shard.payloads[id] = Payload{bytes, 1};
+    _bytes += bytes;
+}
+
+void OutputCache::removePayload(const PropertyPtr &prop)
+{
+    const void *id = prop ? prop->getPayloadId() : nullptr;
+    if(!id) return;
+
+    auto &shard = _payloads[getShardIndex(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.payloads.find(id);
+    if(it == shard.payloads.end() || --it->second.references) return;
+
+    _bytes -= it->second.bytes;
+    shard.payloads.erase(it);
+}
+
+void OutputCache::removePayloads(const Entry &entry)
+{
+    if(!entry.outputs) return;
+    for(const auto &prop : *entry.outputs)
+        removePayload(prop);
+}
+
+OutputCache::Entry OutputCache::get(const DNode *node) const
+{
+    const auto &shard = getShard(node);
+    shard.reads.fetch_add(1, std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.map.find(node);
+    if(it == shard.map.end())
+        return Entry{OutputsPtr(), 0, 0, 0};
+    return it->second;
+}
+
+bool OutputCache::contains(const DNode *node) const
+{
+    auto entry = get(node);
+    return entry.outputs && !entry.outputs->empty();
+}
+
+void OutputCache::set(const DNode *node, int index, PropertyPtr prop, uint64_t generation)
+{
+    _writes.fetch_add(1, std::memory_order_relaxed);
+    size_t propBytes = prop ? prop->getByteSize() : 0;
+
+    auto &shard = getShard(node);
+    auto lock = lockShard(shard);
+
+    auto &entry = shard.map[node];
+    if(!entry.outputs || entry.generation != generation) {
+        removePayloads(entry);
+        entry = Entry{std::make_shared<Outputs>(), generation, 0, 0};
+    }
+    else if(entry.outputs.use_count() > 1) {
+        //a reader holds on to the list, it gets a copy to keep
+        entry.outputs = std::make_shared<Outputs>(*entry.outputs);
+    }
+    else {
+        //readers only take the list under the shard lock, make sure their
+        //last access happened before writing to it
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    auto &outputs = const_cast<Outputs&>(*entry.outputs);
+    size_t i = index;
+    if(index < 0 || i == outputs.size())
+        outputs.push_back(prop);
+    else {
+        if(i >= outputs.size())
+            outputs.resize(i + 1);
+        else if(outputs[i]) {
+            entry.bytes -= outputs[i]->getByteSize();
+            removePayload(outputs[i]);
+        }
+        outputs[i] = prop;
+    }
+
+    entry.bytes += propBytes;
+    addPayload(prop);
+}
+
+void OutputCache::setCost(const DNode *node, double cost)
+{
+    auto &shard = getShard(node);
+    auto lock = lockShard(shard);
+
+    auto it = shard.map.find(node);
+    if(it != shard.map.end())
+        it->second.cost = cost;
+}
+
+bool OutputCache::erase(const DNode *node)
+{
+    auto &shard = getShard(node);
+    auto lock = lockShard(shard);
+
+    auto it = shard.map.find(node);
+    if(it == shard.map.end())
+        return false;
+
+    _erases.fetch_add(1, std::memory_order_relaxed);
+    removePayloads(it->second);
+    shard.map.erase(it);
+    return true;
+}
+
+void OutputCache::clear()
+{
+    for(auto &shard : _shards) {
+        auto lock = lockShard(shard);
+        for(const auto &entry : shard.map)
+            removePayloads(entry.second);
+        shard.map.clear();
+    }
+}
+
+std::vector<std::pair<const DNode*, OutputCache::Entry>> OutputCache::getEntries() const
+{
+    std::vector<std::pair<const DNode*, Entry>> entries;
+    for(const auto &shard : _shards) {
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+        entries.insert(end(entries), shard.map.begin(), shard.map.end());
+    }
+    return entries;
+}
+
+size_t OutputCache::getBytes() const
+{
+    return _bytes;
+}
+
+//drops the entries with the lowest score until the cache fits into
+//budget, returns the number of evicted entries
+size_t OutputCache::evict(size_t budget, EvictionScore score)
+{
+    if(_bytes <= budget) return 0;
+
+    typedef std::pair<double, std::pair<const DNode*, Entry>> Candidate;
+    std::vector<Candidate> candidates;
+    for(const auto &entry : getEntries()) {
+        double s = score(entry.first, entry.second);
+        if(!std::isinf(s) || s < 0)
+            candidates.push_back(Candidate(s, entry));
+    }
+
+    std::sort(begin(candidates), end(candidates),
+              [] (const Candidate &lhs, const Candidate &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    size_t count = 0;
+    for(const auto &candidate : candidates) {
+        //payloads shared with other entries stay, so the total is
+        //checked again after every evicted entry
+        if(_bytes <= budget) break;
+
+        const DNode *node = candidate.second.first;
+        auto &shard = getShard(node);
+        auto lock = lockShard(shard);
+        auto it = shard.map.find(node);
+        if(it == shard.map.end()) continue;
+
+        removePayloads(it->second);
+        shard.map.erase(it);
+        ++count;
+    }
+
+    _evictions += count;
+    return count;
+}
+
+OutputCache::Statistics OutputCache::getStatistics() const
+{
+    Statistics stats;
+    stats.reads = 0;
+    for(const auto &shard : _shards)
+        stats.reads += shard.reads.load(std::memory_order_relaxed);
+    stats.writes = _writes;
+    stats.erases = _erases;
+    stats.contentions = _contentions;
+    stats.evictions = _evictions;
+    stats.bytes = _bytes;
+    return stats;
+}
+
+void OutputCache::resetStatistics()
+{
+    for(auto &shard : _shards)
+        shard.reads = 0;
+    _writes = 0;
+    _erases = 0;
+    _contentions = 0;
+    _evictions = 0;
+}
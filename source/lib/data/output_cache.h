@@ -0,0 +1,127 @@
+#ifndef MT_OUTPUT_CACHE_H
+#define MT_OUTPUT_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace MindTree
+{
+class DNode;
+class Property;
+
+/*
+ * Concurrent storage for the cached outputs of every node.
+ *
+ * Nodes are spread over a fixed number of shards, each guarded by its own
+ * reader/writer lock, so readers only ever contend with writers to the
+ * same shard. Reads are not lock-free, the shared lock is only held for
+ * the lookup and was cheaper than copying snapshots on every write.
+ *
+ * Writes change an output list in place as long as no reader holds on to
+ * it, a reader's list is never affected by later writes.
+ *
+ * Every entry is stamped with the generation its evaluation started in,
+ * writes of a different generation replace the entry instead of adding
+ * to it.
+ *
+ * Entries also track the bytes held by their outputs and the time it took
+ * to compute them, evict() uses both to bring the cache back under a
+ * memory budget. Outputs of different nodes often share their payload,
+ * the total only counts every payload once.
+ */
+class OutputCache
+{
+public:
+    typedef std::shared_ptr<const Property> PropertyPtr;
+    typedef std::vector<PropertyPtr> Outputs;
+    typedef std::shared_ptr<const Outputs> OutputsPtr;
+
+    struct Entry {
+        OutputsPtr outputs;
+        uint64_t generation;
+        size_t bytes;
+        double cost;
+    };
+
+    struct Statistics {
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t erases;
+        uint64_t contentions;
+        uint64_t evictions;
+        size_t bytes;
+    };
+
+    //entries with the lowest score are evicted first,
+    //an infinite score keeps the entry
+    typedef std::function<double(const DNode*, const Entry&)> EvictionScore;
+
+    OutputCache();
+
+    Entry get(const DNode *node) const;
+    bool contains(const DNode *node) const;
+
+    void set(const DNode *node, int index, PropertyPtr prop, uint64_t generation=0);
+    void setCost(const DNode *node, double cost);
+    bool erase(const DNode *node);
+    void clear();
+
+    std::vector<std::pair<const DNode*, Entry>> getEntries() const;
+    size_t getBytes() const;
+    size_t evict(size_t budget, EvictionScore score);
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    typedef std::unordered_map<const DNode*, Entry> Map;
+
+    static const size_t SHARD_COUNT = 64;
+
+    //reads are counted per shard so they don't share a cache line
+    struct alignas(64) Shard {
+        Map map;
+        mutable std::shared_timed_mutex mutex;
+        mutable std::atomic<uint64_t> reads{0};
+    };
+
+    //the cached outputs referencing a payload
+    struct Payload {
+        size_t bytes;
+        size_t references;
+    };
+
+    struct alignas(64) PayloadShard {
+        std::unordered_map<const void*, Payload> payloads;
+        std::mutex mutex;
+    };
+
+    static size_t getShardIndex(const void *ptr);
+    Shard& getShard(const DNode *node);
+    const Shard& getShard(const DNode *node) const;
+    std::unique_lock<std::shared_timed_mutex> lockShard(Shard &shard);
+
+    void addPayload(const PropertyPtr &prop);
+    void removePayload(const PropertyPtr &prop);
+    void removePayloads(const Entry &entry);
+
+    std::array<Shard, SHARD_COUNT> _shards;
+    std::array<PayloadShard, SHARD_COUNT> _payloads;
+
+    std::atomic<uint64_t> _writes;
+    std::atomic<uint64_t> _erases;
+    std::atomic<uint64_t> _contentions;
+    std::atomic<uint64_t> _evictions;
+    std::atomic<size_t> _bytes;
+};
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "data/nodes/data_node.h"
+#include "data/benchmark.h"
+
+#include "profiler.h"
+
+using namespace MindTree;
+
+namespace
+{
+//the statistics of a node on one thread and its interned trace names
+struct NodeProfile {
+    EvaluationProfiler::NodeStatistics statistics;
+    uint32_t traceName;
+    uint32_t traceCategory;
+};
+
+typedef std::unordered_map<EvaluationProfiler::NodeID, NodeProfile> ProfileMap;
+typedef std::unordered_map<EvaluationProfiler::NodeID, EvaluationProfiler::NodeStatistics> StatisticsMap;
+
+//the mutex is only contended while a report merges the buffers
+struct ThreadProfile {
+    std::mutex mutex;
+    ProfileMap nodes;
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadProfile>> threadProfiles;
+
+//profiles outlive their threads until the next reset
+ThreadProfile& getThreadProfile()
+{
+    thread_local std::shared_ptr<ThreadProfile> profile = [] {
+        auto profile = std::make_shared<ThreadProfile>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadProfiles.push_back(profile);
+        return profile;
+    }();
+    return *profile;
+}
+
+NodeProfile& getNodeProfile(ProfileMap &nodes, const DNode *node)
+{
+    auto it = nodes.find(node->getUniqueID());
+    if(it != end(nodes)) return it->second;
+
+    auto &profile = nodes[node->getUniqueID()];
+    profile.statistics.name = node->getNodeName();
+    profile.statistics.type = node->getType().toStr();
+    profile.traceName = Benchmark::internTraceName(profile.statistics.name);
+    profile.traceCategory = Benchmark::internTraceName(profile.statistics.type);
+    return profile;
+}
+
+StatisticsMap mergeStatistics()
+{
+    StatisticsMap merged;
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for(const auto &profile : threadProfiles) {
+        std::lock_guard<std::mutex> lock(profile->mutex);
+        for(const auto &entry : profile->nodes) {
+            const auto &node = entry.second.statistics;
+            auto it = merged.find(entry.first);
+            if(it == end(merged)) {
+                merged.insert(std::make_pair(entry.first, node));
+                continue;
+            }
+
+            auto &stats = it->second;
+            stats.calls += node.calls;
+            stats.hits += node.hits;
+            stats.misses += node.misses;
+            stats.selfTime += node.selfTime;
+            stats.inclusiveTime += node.inclusiveTime;
+            stats.bytes += node.bytes;
+        }
+    }
+    return merged;
+}
+
+int64_t toNanoseconds(double seconds)
+{
+    return int64_t(seconds * 1e9);
+}
+}
+
+std::atomic<bool> EvaluationProfiler::_enabled{false};
+
+void EvaluationProfiler::setEnabled(bool enabled)
+{
+    if(enabled && !_enabled) reset();
+    _enabled = enabled;
+}
+
+void EvaluationProfiler::reset()
+{
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for(const auto &profile : threadProfiles) {
+            std::lock_guard<std::mutex> lock(profile->mutex);
+            profile->nodes.clear();
+        }
+
+        //only the registry still refers to the profiles of finished threads
+        threadProfiles.erase(std::remove_if(begin(threadProfiles), end(threadProfiles),
+                                            [] (const std::shared_ptr<ThreadProfile> &profile) {
+                                                return profile.use_count() == 1;
+                                            }),
+                             end(threadProfiles));
+    }
+
+    Benchmark::clearTrace();
+}
+
+void EvaluationProfiler::recordHit(const DNode *node)
+{
+    if(!isEnabled()) return;
+
+    auto &profile = getThreadProfile();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    ++getNodeProfile(profile.nodes, node).statistics.hits;
+}
+
+void EvaluationProfiler::recordCall(const DNode *node,
+                                    std::chrono::steady_clock::time_point startTime,
+                                    double selfTime,
+                                    double inclusiveTime,
+                                    size_t bytes)
+{
+    if(!isEnabled()) return;
+
+    TraceEvent event;
+    {
+        auto &profile = getThreadProfile();
+        std::lock_guard<std::mutex> lock(profile.mutex);
+        auto &nodeProfile = getNodeProfile(profile.nodes, node);
+        auto &stats = nodeProfile.statistics;
+        ++stats.calls;
+        ++stats.misses;
+        stats.selfTime += selfTime;
+        stats.inclusiveTime += inclusiveTime;
+        stats.bytes += bytes;
+
+        event = {nodeProfile.traceName,
+                 nodeProfile.traceCategory,
+                 0,
+                 Benchmark::getTraceTime(startTime),
+                 toNanoseconds(inclusiveTime),
+                 toNanoseconds(selfTime),
+                 bytes};
+    }
+    Benchmark::addTraceEvent(event);
+}
+
+std::vector<std::pair<EvaluationProfiler::NodeID, EvaluationProfiler::NodeStatistics>> EvaluationProfiler::getStatistics()
+{
+    auto statistics = mergeStatistics();
+    return std::vector<std::pair<NodeID, NodeStatistics>>(begin(statistics), end(statistics));
+}
+
+void EvaluationProfiler::writeTrace(std::ostream &stream)
+{
+    Benchmark::writeTrace(stream);
+}
+
+bool EvaluationProfiler::writeTrace(const std::string &path)
+{
+    return Benchmark::writeTrace(path);
+}
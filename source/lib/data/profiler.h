@@ -0,0 +1,84 @@
+#ifndef MT_PROFILER_H
+#define MT_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MindTree
+{
+class DNode;
+
+/*
+ * Records where the time of node network evaluations goes.
+ *
+ * For every node it counts processor calls, cache hits and misses and
+ * sums up the time spent in the processor with (inclusive) and without
+ * (self) the evaluation of its inputs. Every processor call is also added
+ * to the Benchmark trace, writeTrace exports it together with the traced
+ * benchmarks as Chrome trace event JSON to load in chrome://tracing.
+ *
+ * Every thread records into its own buffer, the buffers are only merged
+ * when statistics are requested. Nodes are identified by their unique
+ * id, their name is taken when a thread first sees them.
+ *
+ * While disabled, recording costs one relaxed atomic load.
+ */
+class EvaluationProfiler
+{
+public:
+    struct NodeStatistics {
+        std::string name;
+        std::string type;
+        uint64_t calls = 0;
+
+        //hits count outputs found in the output cache or reused from
+        //the memo cache, misses count every time the processor had to run
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        //seconds
+        double selfTime = 0;
+        double inclusiveTime = 0;
+
+        size_t bytes = 0;
+    };
+
+    static void setEnabled(bool enabled);
+    static inline bool isEnabled()
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    //drops everything recorded so far, including the trace
+    static void reset();
+
+    //DNode::getUniqueID, never reused while the process runs
+    typedef uint64_t NodeID;
+
+    static void recordHit(const DNode *node);
+    //every call is also a miss. the inclusive time starts when the
+    //evaluation of the inputs started
+    static void recordCall(const DNode *node,
+                           std::chrono::steady_clock::time_point startTime,
+                           double selfTime,
+                           double inclusiveTime,
+                           size_t bytes);
+
+    static std::vector<std::pair<NodeID, NodeStatistics>> getStatistics();
+
+    //same as Benchmark::writeTrace
+    static void writeTrace(std::ostream &stream);
+    static bool writeTrace(const std::string &path);
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+}
+
+#endif
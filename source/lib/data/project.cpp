@@ -1,6 +1,7 @@
 #include "fstream"
 #include "data/signal.h"
 #include "data/io.h"
+#include "data/benchmark.h"
 #include "project.h"
 
 using namespace MindTree;
@@ -26,6 +27,9 @@ Project::Project(std::string filename) noexcept
 
 DNSpace* Project::fromFile(std::string filename)
 {
+    static auto benchmark = Benchmark::get("Project Loading");
+    BenchmarkHandler handler(benchmark);
+
     IO::InStream stream(filename);
     auto space = new DNSpace();
     stream >> *space;
@@ -112,6 +116,9 @@ void Project::unregisterItem(std::string idname)
 
 void Project::save()
 {
+    static auto benchmark = Benchmark::get("Project Saving");
+    BenchmarkHandler handler(benchmark);
+
     IO::OutStream stream(filename);
     stream << *root_scene;
 }
@@ -17,6 +17,7 @@
 */
 
 #include "source/data/python/init.h"
+#include "algorithm"
 #include "exception"
 #include "glm/glm.hpp"
 #include "iostream"
@@ -41,28 +42,164 @@ PROPERTY_TYPE_INFO(glm::vec3, "VECTOR3D");
 PROPERTY_TYPE_INFO(glm::vec4, "COLOR");
 PROPERTY_TYPE_INFO(glm::mat4, "MAT4");
 
-TypeDispatcher<DataType, ConverterList> PropertyConverter::_converters;
+PropertyConverter::ConverterTable PropertyConverter::_converters;
+std::deque<ConverterFunctor> PropertyConverter::_functors;
+std::unique_ptr<const PropertyConverter::ConverterTable> PropertyConverter::_publishedTable;
+std::vector<std::unique_ptr<const PropertyConverter::ConverterTable>> PropertyConverter::_retiredTables;
+std::atomic<const PropertyConverter::ConverterTable*> PropertyConverter::_frozenTable{nullptr};
+std::mutex PropertyConverter::_hazardMutex;
+PropertyConverter::HazardSlot *PropertyConverter::_hazardSlots = nullptr;
 std::shared_timed_mutex PropertyConverter::converter_mutex_;
 
+//slots are never freed, a thread that exits hands its slot to the next one
+std::atomic<const PropertyConverter::ConverterTable*>& PropertyConverter::getHazard()
+{
+    struct SlotOwner {
+        HazardSlot *slot = nullptr;
+
+        SlotOwner()
+        {
+            std::lock_guard<std::mutex> lock(_hazardMutex);
+            for(HazardSlot *s = _hazardSlots; s; s = s->next) {
+                bool used = false;
+                if(s->used.compare_exchange_strong(used, true)) {
+                    slot = s;
+                    return;
+                }
+            }
+            slot = new HazardSlot;
+            slot->next = _hazardSlots;
+            _hazardSlots = slot;
+        }
+
+        ~SlotOwner()
+        {
+            slot->table = nullptr;
+            slot->used = false;
+        }
+    };
+
+    thread_local SlotOwner owner;
+    return owner.slot->table;
+}
+
+//has to be called with the converter lock held
+void PropertyConverter::publish(bool frozen)
+{
+    if(_publishedTable) _retiredTables.push_back(std::move(_publishedTable));
+    if(frozen) _publishedTable.reset(new ConverterTable(_converters));
+    _frozenTable.store(_publishedTable.get());
+
+    //a reader that announced a retired table before the new one was
+    //stored still holds it, everything else can go
+    std::lock_guard<std::mutex> lock(_hazardMutex);
+    auto inUse = [] (const std::unique_ptr<const ConverterTable> &table) {
+        for(HazardSlot *slot = _hazardSlots; slot; slot = slot->next)
+            if(slot->table.load() == table.get()) return true;
+        return false;
+    };
+    _retiredTables.erase(std::remove_if(begin(_retiredTables), end(_retiredTables),
+                                        [&inUse] (const std::unique_ptr<const ConverterTable> &table) {
+                                            return !inUse(table);
+                                        }),
+                         end(_retiredTables));
+}
+
 void PropertyConverter::registerConverter(DataType from, DataType to, ConverterFunctor fn)
 {
     std::unique_lock<std::shared_timed_mutex> lock(converter_mutex_);
-    _converters[from][to] = fn;
+    //functors are never destroyed, so pointers handed out by find stay
+    //valid even if a converter gets replaced
+    _functors.push_back(fn);
+    _converters[key(from, to)] = &_functors.back();
+
+    if(_frozenTable.load(std::memory_order_relaxed)) publish(true);
 }
 
-bool PropertyConverter::isConvertible(DataType from, DataType to)
+void PropertyConverter::unregisterConverter(DataType from, DataType to)
 {
-    std::shared_lock<std::shared_timed_mutex> lock(converter_mutex_);
-    auto fn = _converters[from][to];
-    if(fn)
-        return true;
-    return false;
+    std::unique_lock<std::shared_timed_mutex> lock(converter_mutex_);
+    if(!_converters.erase(key(from, to))) return;
+
+    if(_frozenTable.load(std::memory_order_relaxed)) publish(true);
+}
+
+void PropertyConverter::freeze()
+{
+    std::unique_lock<std::shared_timed_mutex> lock(converter_mutex_);
+    if(_frozenTable.load(std::memory_order_relaxed)) return;
+
+    publish(true);
 }
 
-ConverterFunctor PropertyConverter::get(DataType from, DataType to)
+void PropertyConverter::unfreeze()
 {
+    std::unique_lock<std::shared_timed_mutex> lock(converter_mutex_);
+    if(!_frozenTable.load(std::memory_order_relaxed)) return;
+
+    publish(false);
+}
+
+bool PropertyConverter::isFrozen()
+{
+    return _frozenTable.load(std::memory_order_acquire);
+}
+
+const ConverterFunctor* PropertyConverter::find(const DataType &from, const DataType &to)
+{
+    if(_frozenTable.load(std::memory_order_relaxed)) {
+        //the table is only safe to use once the announcement is visible
+        //and it is still the published one
+        auto &hazard = getHazard();
+        const ConverterTable *table = _frozenTable.load();
+        for(;;) {
+            hazard.store(table);
+            const ConverterTable *current = _frozenTable.load();
+            if(current == table) break;
+            table = current;
+        }
+
+        const ConverterFunctor *fn = nullptr;
+        if(table) {
+            auto it = table->find(key(from, to));
+            if(it != table->end()) fn = it->second;
+        }
+        hazard.store(nullptr);
+        if(table) return fn;
+    }
+
     std::shared_lock<std::shared_timed_mutex> lock(converter_mutex_);
-    return _converters[from][to];
+    auto it = _converters.find(key(from, to));
+    return it != _converters.end() ? it->second : nullptr;
+}
+
+bool PropertyConverter::isConvertible(const DataType &from, const DataType &to)
+{
+    return find(from, to);
+}
+
+ConverterFunctor PropertyConverter::get(const DataType &from, const DataType &to)
+{
+    const ConverterFunctor *fn = find(from, to);
+    if(!fn) return ConverterFunctor();
+    return *fn;
+}
+
+std::atomic<size_t> Property::_sharedCopies{0};
+std::atomic<size_t> Property::_payloadCopies{0};
+
+Property::CopyStatistics Property::getCopyStatistics()
+{
+    CopyStatistics stats;
+    stats.shared = _sharedCopies;
+    stats.copied = _payloadCopies;
+    return stats;
+}
+
+void Property::resetCopyStatistics()
+{
+    _sharedCopies = 0;
+    _payloadCopies = 0;
 }
 
 Property::Property()
@@ -185,6 +322,33 @@ const MindTree::DataType& Property::getType() const
     return type_;
 }
 
+bool Property::hash(size_t &seed) const
+{
+    hashCombine(seed, type_.id());
+    if(!data_) return true;
+    return traits_->hashData(seed);
+}
+
+bool Property::equals(const Property &other) const
+{
+    if(type_.id() != other.type_.id()) return false;
+    if(data_ == other.data_) return true;
+    if(!data_ || !other.data_) return false;
+    return traits_->equalData(other);
+}
+
+size_t Property::getByteSize() const
+{
+    if(!data_) return sizeof(Property);
+    return sizeof(Property) + traits_->getByteSize();
+}
+
+const void* Property::getPayloadId() const
+{
+    if(!data_) return nullptr;
+    return traits_->getPayloadId();
+}
+
 BPy::object Property::toPython() const
 {
     if(!data_) {
@@ -193,6 +357,34 @@ BPy::object Property::toPython() const
     return traits_->pyconverter();
 }
 
+bool PropertyHash<PropertyMap>::hash(const PropertyMap &value, size_t &seed)
+{
+    hashCombine(seed, value.size());
+    for(const auto &info : value) {
+        PropertyHash<std::string>::hash(info.first, seed);
+        if(!info.second.hash(seed))
+            return false;
+    }
+    return true;
+}
+
+bool PropertyEqual<PropertyMap>::equal(const PropertyMap &lhs, const PropertyMap &rhs)
+{
+    if(lhs.size() != rhs.size()) return false;
+    for(auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
+        if(l->first != r->first || !l->second.equals(r->second))
+            return false;
+    return true;
+}
+
+size_t PropertySize<PropertyMap>::size(const PropertyMap &value)
+{
+    size_t bytes = sizeof(PropertyMap);
+    for(const auto &info : value)
+        bytes += PropertySize<std::string>::size(info.first) + info.second.getByteSize();
+    return bytes;
+}
+
 PropertyMap::PropertyMap(std::initializer_list<Info> init)
 {
     _properties.insert(std::begin(_properties), init);
@@ -20,8 +20,15 @@
 
 #define PROPERTIES_K7LMQN2D
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
 #include <vector>
 #include <shared_mutex>
@@ -38,11 +45,13 @@ namespace MindTree
 
 class Property;
 
+//the DataType of every T is built once, typed access then only compares
+//the integer ids of two DataTypes
 template<typename T>
 class PropertyTypeInfo
 {
 public:
-    static DataType getType()
+    static const DataType& getType()
     {
         return _type;
     }
@@ -55,9 +64,10 @@ template<typename T>
 class PropertyTypeInfo<std::vector<T>>
 {
 public:
-    static DataType getType()
+    static const DataType& getType()
     {
-        return "LIST:" + PropertyTypeInfo<T>::getType().toStr();
+        static const DataType type("LIST:" + PropertyTypeInfo<T>::getType().toStr());
+        return type;
     }
 };
 
@@ -65,9 +75,9 @@ template<typename T>
 class PropertyTypeInfo<std::shared_ptr<std::vector<T>>>
 {
 public:
-    static DataType getType()
+    static const DataType& getType()
     {
-        return "LIST:" + PropertyTypeInfo<T>::getType().toStr();
+        return PropertyTypeInfo<std::vector<T>>::getType();
     }
 };
 
@@ -75,18 +85,61 @@ public:
     template<> const MindTree::DataType MindTree::PropertyTypeInfo<TYPE>::_type{STR}
 
 typedef std::function<void(void*, void*)> ConverterFunctor;
-typedef TypeDispatcher<DataType, ConverterFunctor> ConverterList;
 
+/*
+ * Converters are registered while the plugins are loaded and looked up
+ * on every typed access of a property with a different type.
+ *
+ * Until freeze is called lookups share a lock with registration,
+ * afterwards they read an immutable table without any locking.
+ * Converters registered after freeze (e.g. when plugins are reloaded)
+ * publish a new table. Readers announce the table they are using in a
+ * per thread slot, superseded tables are deleted once no slot refers to
+ * them anymore.
+ */
 class PropertyConverter
 {
 public:
     static void registerConverter(DataType from, DataType to, ConverterFunctor fn);
-    static bool isConvertible(DataType from, DataType to);
-    static ConverterFunctor get(DataType from, DataType to);
+    static void unregisterConverter(DataType from, DataType to);
+    static bool isConvertible(const DataType &from, const DataType &to);
+    static ConverterFunctor get(const DataType &from, const DataType &to);
+
+    //nullptr if there is no converter, the functor stays valid for the
+    //lifetime of the program
+    static const ConverterFunctor* find(const DataType &from, const DataType &to);
+
+    static void freeze();
+    //goes back to locked lookups, mostly for tests that have to restore
+    //the state they found
+    static void unfreeze();
+    static bool isFrozen();
 
 private:
+    typedef std::unordered_map<uint64_t, const ConverterFunctor*> ConverterTable;
+
+    struct HazardSlot {
+        std::atomic<const ConverterTable*> table{nullptr};
+        std::atomic<bool> used{true};
+        HazardSlot *next = nullptr;
+    };
+
+    static std::atomic<const ConverterTable*>& getHazard();
+    static void publish(bool frozen);
+
+    static uint64_t key(const DataType &from, const DataType &to)
+    {
+        return (uint64_t(uint32_t(from.id())) << 32) | uint32_t(to.id());
+    }
+
     static std::shared_timed_mutex converter_mutex_;
-    static TypeDispatcher<DataType, ConverterList> _converters;
+    static ConverterTable _converters;
+    static std::deque<ConverterFunctor> _functors;
+    static std::unique_ptr<const ConverterTable> _publishedTable;
+    static std::vector<std::unique_ptr<const ConverterTable>> _retiredTables;
+    static std::atomic<const ConverterTable*> _frozenTable;
+    static std::mutex _hazardMutex;
+    static HazardSlot *_hazardSlots;
 };
 
 class PropertyDataBase
@@ -100,7 +153,7 @@ class PropertyData : public PropertyDataBase
 {
 public:
     PropertyData(){}
-    PropertyData(T data) : data(data) {}
+    PropertyData(T data) : data(std::move(data)) {}
     PropertyData(const PropertyData &prop) : data(prop.data){}
     ~PropertyData() {}
 
@@ -153,6 +206,184 @@ struct isSTDVectorTrait<std::vector<T>> {
     static const bool value = true;
 };
 
+inline void hashCombine(size_t &seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+//content hashes used to memoize processor results,
+//types that can't be hashed return false
+template<typename T, typename Enable=void>
+struct PropertyHash {
+    static bool hash(const T&, size_t&) { return false; }
+};
+
+template<typename T>
+struct PropertyHash<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+    static bool hash(const T &value, size_t &seed)
+    {
+        hashCombine(seed, std::hash<T>()(value));
+        return true;
+    }
+};
+
+template<>
+struct PropertyHash<std::string> {
+    static bool hash(const std::string &value, size_t &seed)
+    {
+        hashCombine(seed, std::hash<std::string>()(value));
+        return true;
+    }
+};
+
+template<typename T, typename C>
+struct PropertyGLMHash {
+    static bool hash(const T &value, size_t &seed)
+    {
+        const auto *components = reinterpret_cast<const C*>(&value);
+        for(size_t i = 0; i < sizeof(T) / sizeof(C); ++i)
+            PropertyHash<C>::hash(components[i], seed);
+        return true;
+    }
+};
+
+template<> struct PropertyHash<glm::vec2> : public PropertyGLMHash<glm::vec2, float> {};
+template<> struct PropertyHash<glm::ivec2> : public PropertyGLMHash<glm::ivec2, int> {};
+template<> struct PropertyHash<glm::vec3> : public PropertyGLMHash<glm::vec3, float> {};
+template<> struct PropertyHash<glm::vec4> : public PropertyGLMHash<glm::vec4, float> {};
+template<> struct PropertyHash<glm::mat4> : public PropertyGLMHash<glm::mat4, float> {};
+
+template<typename T>
+struct PropertyHash<std::vector<T>> {
+    static bool hash(const std::vector<T> &value, size_t &seed)
+    {
+        hashCombine(seed, value.size());
+        for(const auto &item : value)
+            if(!PropertyHash<T>::hash(item, seed))
+                return false;
+        return true;
+    }
+};
+
+template<typename T>
+struct PropertyHash<std::shared_ptr<std::vector<T>>> {
+    static bool hash(const std::shared_ptr<std::vector<T>> &value, size_t &seed)
+    {
+        if(!value) {
+            hashCombine(seed, 0);
+            return true;
+        }
+        return PropertyHash<std::vector<T>>::hash(*value, seed);
+    }
+};
+
+//the address of shared data says nothing about its content, a new
+//object can be allocated where a freed one lived. types that can be
+//hashed by content specialize this
+template<typename T>
+struct PropertyHash<std::shared_ptr<T>> {
+    static bool hash(const std::shared_ptr<T>&, size_t&) { return false; }
+};
+
+//content comparison behind every memoized hash, a memoized result is only
+//reused if all inputs compare equal. only hashable types need to compare
+template<typename T, typename Enable=void>
+struct PropertyEqual {
+    static bool equal(const T&, const T&) { return false; }
+};
+
+template<typename T>
+struct PropertyValueEqual {
+    static bool equal(const T &lhs, const T &rhs) { return lhs == rhs; }
+};
+
+template<typename T>
+struct PropertyEqual<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    : public PropertyValueEqual<T> {};
+
+template<> struct PropertyEqual<std::string> : public PropertyValueEqual<std::string> {};
+template<> struct PropertyEqual<glm::vec2> : public PropertyValueEqual<glm::vec2> {};
+template<> struct PropertyEqual<glm::ivec2> : public PropertyValueEqual<glm::ivec2> {};
+template<> struct PropertyEqual<glm::vec3> : public PropertyValueEqual<glm::vec3> {};
+template<> struct PropertyEqual<glm::vec4> : public PropertyValueEqual<glm::vec4> {};
+template<> struct PropertyEqual<glm::mat4> : public PropertyValueEqual<glm::mat4> {};
+
+template<typename T>
+struct PropertyEqual<std::vector<T>> {
+    static bool equal(const std::vector<T> &lhs, const std::vector<T> &rhs)
+    {
+        if(lhs.size() != rhs.size()) return false;
+        for(size_t i = 0; i < lhs.size(); ++i)
+            if(!PropertyEqual<T>::equal(lhs[i], rhs[i]))
+                return false;
+        return true;
+    }
+};
+
+template<typename T>
+struct PropertyEqual<std::shared_ptr<std::vector<T>>> {
+    static bool equal(const std::shared_ptr<std::vector<T>> &lhs,
+                      const std::shared_ptr<std::vector<T>> &rhs)
+    {
+        if(lhs == rhs) return true;
+        if(!lhs || !rhs) return false;
+        return PropertyEqual<std::vector<T>>::equal(*lhs, *rhs);
+    }
+};
+
+//approximate number of bytes held by a property's payload
+template<typename T>
+struct PropertySize {
+    static size_t size(const T&) { return sizeof(T); }
+};
+
+template<>
+struct PropertySize<std::string> {
+    static size_t size(const std::string &value)
+    {
+        return sizeof(std::string) + value.capacity();
+    }
+};
+
+template<typename T>
+struct PropertySize<std::vector<T>> {
+    static size_t size(const std::vector<T> &value)
+    {
+        size_t bytes = sizeof(std::vector<T>) + (value.capacity() - value.size()) * sizeof(T);
+        if(std::is_trivially_copyable<T>::value)
+            return bytes + value.size() * sizeof(T);
+
+        for(const auto &item : value)
+            bytes += PropertySize<T>::size(item);
+        return bytes;
+    }
+};
+
+template<typename T>
+struct PropertySize<std::shared_ptr<T>> {
+    static size_t size(const std::shared_ptr<T> &value)
+    {
+        if(!value) return sizeof(value);
+        return sizeof(value) + PropertySize<T>::size(*value);
+    }
+};
+
+//identifies the memory a payload lives in, properties holding the
+//same shared object all point to it
+template<typename T>
+struct PropertyPayload {
+    static const void* id(const T &value) { return &value; }
+};
+
+template<typename T>
+struct PropertyPayload<std::shared_ptr<T>> {
+    static const void* id(const std::shared_ptr<T> &value)
+    {
+        if(!value) return &value;
+        return value.get();
+    }
+};
+
 struct PropertyDataTraits {
     PropertyDataTraits(Property *self) : self_(self) {}
 
@@ -162,11 +393,17 @@ struct PropertyDataTraits {
     virtual BPy::object pyconverter() = 0;
 
     virtual void writeData(IO::OutStream&, const Property&) = 0;
+    virtual bool hashData(size_t &seed) const = 0;
+    virtual bool equalData(const Property &other) const = 0;
+    virtual size_t getByteSize() const = 0;
+    virtual const void* getPayloadId() const = 0;
+    virtual const std::type_info& getTypeInfo() const = 0;
 
     //vector traits
     virtual Property createList(int cnt, Property def) const = 0;
     virtual Property getItem(int) const = 0;
     virtual void setItem(int index, Property) = 0;
+    virtual Property gatherItems(const std::vector<uint32_t> &indices) const = 0;
     virtual size_t getSize() const = 0;
     virtual bool isList() const = 0;
 
@@ -200,10 +437,20 @@ public:
     Property clone()const;
     static Property createPropertyFromPython(const BPy::object &pyobj);
 
+    //copies of a property share their payload, it is only duplicated
+    //when one of them asks for mutable access through getDataRef
+    struct CopyStatistics {
+        size_t shared = 0;
+        size_t copied = 0;
+    };
+
+    static CopyStatistics getCopyStatistics();
+    static void resetCopyStatistics();
+
     template<typename T,
         typename std::enable_if<!std::is_same<T, Property*>::value>::type* = nullptr>
     void setData(T d){
-        data_ = std::make_unique<PropertyData<T>>(d);
+        data_ = std::make_shared<PropertyData<T>>(std::move(d));
         setMetaData<T>();
     }
 
@@ -221,13 +468,14 @@ public:
         if (!data_) return T();
 
         //initialize on demand with default value
-        if(PropertyTypeInfo<T>::getType() != type_) {
-            if(!PropertyConverter::isConvertible(PropertyTypeInfo<T>::getType(), type_))
+        const DataType &type = PropertyTypeInfo<T>::getType();
+        if(type != type_) {
+            const ConverterFunctor *converter = PropertyConverter::find(type_, type);
+            if(!converter)
                 return T();
 
-            auto converter = PropertyConverter::get(type_, PropertyTypeInfo<T>::getType());
             T converted;
-            converter(data_.get(), reinterpret_cast<void*>(&converted));
+            (*converter)(data_.get(), reinterpret_cast<void*>(&converted));
 
             return converted;
         }
@@ -240,7 +488,13 @@ public:
     {
         //initialize on demand with default value
         if(!data_) {
-            data_ = std::make_unique<PropertyData<T>>();
+            data_ = std::make_shared<PropertyData<T>>();
+        }
+        //copy on write
+        else if(data_.use_count() > 1) {
+            data_ = std::make_shared<PropertyData<T>>(
+                *reinterpret_cast<PropertyData<T>*>(data_.get()));
+            ++_payloadCopies;
         }
         return reinterpret_cast<PropertyData<T>*>(data_.get())->getData();
     }
@@ -255,11 +509,37 @@ public:
 
     BPy::object toPython() const;
     const MindTree::DataType& getType() const;
+
+    //combines the type and content into seed,
+    //returns false if the content can't be hashed
+    bool hash(size_t &seed) const;
+    //compares the content the same way hash() digests it
+    bool equals(const Property &other) const;
+    size_t getByteSize() const;
+
+    //identifies the payload, copies share it until one of them is written to
+    inline const void* getDataId() const
+    {
+        return data_.get();
+    }
+
+    //identifies the memory the payload lives in, unlike getDataId this is
+    //the same for different properties holding the same shared object
+    const void* getPayloadId() const;
+
     inline operator bool() const
     {
         return data_.get();
     }
 
+    //true if the payload is exactly a T, several C++ types share the
+    //same DataType so getType alone can't tell
+    template<typename T>
+    bool holds() const
+    {
+        return data_ && traits_ && traits_->getTypeInfo() == typeid(T);
+    }
+
     inline bool isList() const
     {
         if(!traits_) return false;
@@ -278,6 +558,13 @@ public:
         list.traits_->setItem(index, value);
     }
 
+    //builds a new list of the same type with list[indices[i]] at i
+    inline static Property gatherItems(const Property &list, const std::vector<uint32_t> &indices)
+    {
+        if(!list.isList()) return Property();
+        return list.traits_->gatherItems(indices);
+    }
+
     inline size_t size() const
     {
         if(!isList()) {
@@ -302,15 +589,19 @@ private:
 
     friend IO::OutStream& MindTree::operator<<(IO::OutStream& stream, const Property &prop);
 
-    std::unique_ptr<PropertyDataBase> data_;
+    std::shared_ptr<PropertyDataBase> data_;
     std::unique_ptr<PropertyDataTraits> traits_;
     DataType type_;
+
+    static std::atomic<size_t> _sharedCopies;
+    static std::atomic<size_t> _payloadCopies;
 };
 
 template<typename T>
 struct PropertyListTraits {
     static Property getItem(const Property &, int) { return Property(); }
     static void setItem(Property &, int, Property) {}
+    static Property gatherItems(const Property &, const std::vector<uint32_t> &) { return Property(); }
     static size_t getSize(const Property &) { return 1; }
     static bool isList() { return false; }
     static Property createList(int cnt, Property def)
@@ -328,7 +619,7 @@ struct PropertyListTraits<std::vector<T>> {
     static Property getItem(const Property &self, int index)
     {
         const auto &vec = self.getDataRef<std::vector<T>>();
-        if(index >= vec.size())
+        if(size_t(index) >= vec.size())
             return Property();
 
         return vec.at(index);
@@ -337,12 +628,22 @@ struct PropertyListTraits<std::vector<T>> {
     static void setItem(Property &self, int index, Property value)
     {
         auto &vec = self.getDataRef<std::vector<T>>();
-        if(vec.size() <= index)
+        if(vec.size() <= size_t(index))
             vec.resize(index + 1);
 
         vec[index] = value.getData<T>();
     }
 
+    static Property gatherItems(const Property &self, const std::vector<uint32_t> &indices)
+    {
+        const auto &vec = self.getDataRef<std::vector<T>>();
+        std::vector<T> items(indices.size());
+        for(size_t i = 0; i < indices.size(); ++i)
+            if(indices[i] < vec.size())
+                items[i] = vec[indices[i]];
+        return items;
+    }
+
     static size_t getSize(const Property &self)
     {
         return self.getDataRef<std::vector<T>>().size();
@@ -357,7 +658,7 @@ struct PropertyListTraits<std::shared_ptr<std::vector<T>>> {
     static Property getItem(const Property &self, int index)
     {
         const auto &vec = self.getDataRef<std::shared_ptr<std::vector<T>>>();
-        if(index >= vec->size())
+        if(size_t(index) >= vec->size())
             return Property();
 
         return vec->at(index);
@@ -366,12 +667,22 @@ struct PropertyListTraits<std::shared_ptr<std::vector<T>>> {
     static void setItem(Property &self, int index, Property value)
     {
         auto &vec = self.getDataRef<std::shared_ptr<std::vector<T>>>();
-        if(vec->size() <= index)
+        if(vec->size() <= size_t(index))
             vec->resize(index + 1);
 
         (*vec)[index] = value.getData<T>();
     }
 
+    static Property gatherItems(const Property &self, const std::vector<uint32_t> &indices)
+    {
+        const auto &vec = self.getDataRef<std::shared_ptr<std::vector<T>>>();
+        auto items = std::make_shared<std::vector<T>>(indices.size());
+        for(size_t i = 0; i < indices.size(); ++i)
+            if(indices[i] < vec->size())
+                (*items)[i] = (*vec)[indices[i]];
+        return items;
+    }
+
     static size_t getSize(const Property &self)
     {
         return self.getDataRef<std::shared_ptr<std::vector<T>>>()->size();
@@ -387,7 +698,10 @@ struct PropertyTypeTraits : public PropertyDataTraits {
     PropertyTypeTraits(Property *self) : PropertyDataTraits(self) {}
     void cloneData(Property &other) override
     {
-        other.setData<T>(self_->getData<T>());
+        if(&other == self_) return;
+        other.data_ = self_->data_;
+        other.setMetaData<T>();
+        ++Property::_sharedCopies;
     }
 
     void moveData(Property &other) override
@@ -406,6 +720,33 @@ struct PropertyTypeTraits : public PropertyDataTraits {
         return PyConverter<T>::pywrap(self_->getData<T>());
     }
 
+    bool hashData(size_t &seed) const override
+    {
+        return PropertyHash<T>::hash(static_cast<const Property*>(self_)->getDataRef<T>(), seed);
+    }
+
+    bool equalData(const Property &other) const override
+    {
+        return other.holds<T>()
+            && PropertyEqual<T>::equal(static_cast<const Property*>(self_)->getDataRef<T>(),
+                                       other.getDataRef<T>());
+    }
+
+    size_t getByteSize() const override
+    {
+        return PropertySize<T>::size(static_cast<const Property*>(self_)->getDataRef<T>());
+    }
+
+    const void* getPayloadId() const override
+    {
+        return PropertyPayload<T>::id(static_cast<const Property*>(self_)->getDataRef<T>());
+    }
+
+    const std::type_info& getTypeInfo() const override
+    {
+        return typeid(T);
+    }
+
     Property createList(int cnt, Property def) const override
     {
         return PropertyListTraits<T>::createList(cnt, def);
@@ -421,6 +762,11 @@ struct PropertyTypeTraits : public PropertyDataTraits {
         return PropertyListTraits<T>::setItem(*self_, index, value);
     }
 
+    Property gatherItems(const std::vector<uint32_t> &indices) const override
+    {
+        return PropertyListTraits<T>::gatherItems(*self_, indices);
+    }
+
     size_t getSize() const override
     {
         return PropertyListTraits<T>::getSize(*self_);
@@ -472,6 +818,21 @@ private:
 
 //typedef std::unordered_map<std::string, Property> PropertyMap;
 
+template<>
+struct PropertyHash<PropertyMap> {
+    static bool hash(const PropertyMap &value, size_t &seed);
+};
+
+template<>
+struct PropertyEqual<PropertyMap> {
+    static bool equal(const PropertyMap &lhs, const PropertyMap &rhs);
+};
+
+template<>
+struct PropertySize<PropertyMap> {
+    static size_t size(const PropertyMap &value);
+};
+
 namespace IO {
 template <typename T>
 struct Writer {
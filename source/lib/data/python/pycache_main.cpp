@@ -19,6 +19,8 @@
 #include "data/properties.h"
 #include "data/dnspace.h"
 #include "data/nodes/data_node.h"
+#include "data/profiler.h"
+#include "pyutils.h"
 #include "pycache_main.h"
 
 MindTree::PyCacheProcessor::PyCacheProcessor(SocketType st, NodeType nt, BPy::object obj)
@@ -32,6 +34,8 @@ MindTree::PyCacheProcessor::~PyCacheProcessor()
 
 void MindTree::PyCacheProcessor::operator()(MindTree::DataCache* cache)
 {
+    //processors may run on the evaluation thread pool
+    MindTree::Python::GILLocker locker;
     processor(BPy::ptr(cache));
 }
 
@@ -105,6 +109,86 @@ void MindTree::wrap_DataCache_invalidate(DNodePyWrapper *node)
     MindTree::DataCache::invalidate(node->getWrapped<DNode>());
 }
 
+BPy::dict MindTree::wrap_DataCache_getCacheStatistics()
+{
+    auto stats = DataCache::getCacheStatistics();
+    BPy::dict dict;
+    dict["reads"] = stats.reads;
+    dict["writes"] = stats.writes;
+    dict["erases"] = stats.erases;
+    dict["contentions"] = stats.contentions;
+    dict["evictions"] = stats.evictions;
+    dict["bytes"] = stats.bytes;
+    return dict;
+}
+
+size_t MindTree::wrap_DataCache_evictCache()
+{
+    return DataCache::evictCache();
+}
+
+BPy::list MindTree::wrap_DataCache_getCacheUsage()
+{
+    auto usage = DataCache::getCacheUsage();
+    std::sort(begin(usage), end(usage), [] (const auto &lhs, const auto &rhs) {
+        return lhs.second.bytes > rhs.second.bytes;
+    });
+
+    BPy::list list;
+    for(const auto &entry : usage) {
+        BPy::dict dict;
+        dict["node"] = entry.first->getNodeName();
+        dict["bytes"] = entry.second.bytes;
+        dict["cost"] = entry.second.cost;
+        dict["stale"] = entry.second.generation < entry.first->getCacheGeneration();
+        list.append(dict);
+    }
+    return list;
+}
+
+void MindTree::wrap_DataCache_setMemoizable(std::string ntype, bool memoizable)
+{
+    DataCache::setMemoizable(NodeType(ntype), memoizable);
+}
+
+BPy::dict MindTree::wrap_DataCache_getMemoStatistics()
+{
+    auto stats = DataCache::getMemoStatistics();
+    BPy::dict dict;
+    dict["hits"] = stats.hits;
+    dict["misses"] = stats.misses;
+    dict["collisions"] = stats.collisions;
+    dict["evictions"] = stats.evictions;
+    dict["entries"] = stats.entries;
+    dict["bytes"] = stats.bytes;
+    return dict;
+}
+
+//slowest nodes first
+BPy::list MindTree::wrap_DataCache_getProfile()
+{
+    auto profile = EvaluationProfiler::getStatistics();
+    std::sort(begin(profile), end(profile), [] (const auto &lhs, const auto &rhs) {
+        return lhs.second.selfTime > rhs.second.selfTime;
+    });
+
+    BPy::list list;
+    for(const auto &entry : profile) {
+        const auto &stats = entry.second;
+        BPy::dict dict;
+        dict["node"] = stats.name;
+        dict["type"] = stats.type;
+        dict["calls"] = stats.calls;
+        dict["hits"] = stats.hits;
+        dict["misses"] = stats.misses;
+        dict["selfTime"] = stats.selfTime;
+        dict["inclusiveTime"] = stats.inclusiveTime;
+        dict["bytes"] = stats.bytes;
+        list.append(dict);
+    }
+    return list;
+}
+
 void MindTree::wrap_DataCache()
 {
     BPy::class_<MindTree::DataCache>("_DataCache", BPy::no_init)
@@ -113,6 +197,42 @@ void MindTree::wrap_DataCache()
         .def("invalidate", &wrap_DataCache_invalidate)
         .staticmethod("addProcessor")
         .staticmethod("invalidate")
+        .def("setParallelEvaluation", &DataCache::setParallelEvaluation)
+        .staticmethod("setParallelEvaluation")
+        .def("isParallelEvaluation", &DataCache::isParallelEvaluation)
+        .staticmethod("isParallelEvaluation")
+        .def("getCacheStatistics", &wrap_DataCache_getCacheStatistics)
+        .staticmethod("getCacheStatistics")
+        .def("resetCacheStatistics", &DataCache::resetCacheStatistics)
+        .staticmethod("resetCacheStatistics")
+        .def("getCacheUsage", &wrap_DataCache_getCacheUsage)
+        .staticmethod("getCacheUsage")
+        .def("setCacheBudget", &DataCache::setCacheBudget)
+        .staticmethod("setCacheBudget")
+        .def("getCacheBudget", &DataCache::getCacheBudget)
+        .staticmethod("getCacheBudget")
+        .def("evictCache", &wrap_DataCache_evictCache)
+        .staticmethod("evictCache")
+        .def("setMemoizable", &wrap_DataCache_setMemoizable)
+        .staticmethod("setMemoizable")
+        .def("setMemoBudget", &DataCache::setMemoBudget)
+        .staticmethod("setMemoBudget")
+        .def("getMemoBudget", &DataCache::getMemoBudget)
+        .staticmethod("getMemoBudget")
+        .def("getMemoStatistics", &wrap_DataCache_getMemoStatistics)
+        .staticmethod("getMemoStatistics")
+        .def("clearMemoCache", &DataCache::clearMemoCache)
+        .staticmethod("clearMemoCache")
+        .def("setProfiling", &EvaluationProfiler::setEnabled)
+        .staticmethod("setProfiling")
+        .def("isProfiling", &EvaluationProfiler::isEnabled)
+        .staticmethod("isProfiling")
+        .def("getProfile", &wrap_DataCache_getProfile)
+        .staticmethod("getProfile")
+        .def("resetProfile", &EvaluationProfiler::reset)
+        .staticmethod("resetProfile")
+        .def("writeProfileTrace", static_cast<bool(*)(const std::string&)>(&EvaluationProfiler::writeTrace))
+        .staticmethod("writeProfileTrace")
         .add_property("node", BPy::make_function(&wrap_DataCache_getNode,
                                 BPy::return_value_policy<BPy::manage_new_object>()))
         .def("getData", &wrap_DataCache_getData)
@@ -37,6 +37,12 @@ void wrap_DataCache_cache(MindTree::DataCache *self, MindTree::DinSocketPyWrappe
 BPy::dict wrap_DataCache_getProcessors();
 std::string wrap_DataCache_getType(DataCache *self);
 void wrap_DataCache_invalidate(DNodePyWrapper *node);
+BPy::dict wrap_DataCache_getCacheStatistics();
+BPy::list wrap_DataCache_getCacheUsage();
+size_t wrap_DataCache_evictCache();
+void wrap_DataCache_setMemoizable(std::string ntype, bool memoizable);
+BPy::dict wrap_DataCache_getMemoStatistics();
+BPy::list wrap_DataCache_getProfile();
 
 class PyWrapCache : public DataCache
 {
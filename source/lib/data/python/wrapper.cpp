@@ -754,7 +754,20 @@ void PropertyPyWrapper::wrap()
 {
     BPy::class_<Property, BPy::bases<PyWrapper>>("Property", BPy::no_init)
         .def("__repr__", &PropertyPyWrapper::__repr__)
-        .def("__str__", &PropertyPyWrapper::__str__);
+        .def("__str__", &PropertyPyWrapper::__str__)
+        .def("getCopyStatistics", &PropertyPyWrapper::getCopyStatistics)
+        .staticmethod("getCopyStatistics")
+        .def("resetCopyStatistics", &Property::resetCopyStatistics)
+        .staticmethod("resetCopyStatistics");
+}
+
+BPy::dict PropertyPyWrapper::getCopyStatistics()
+{
+    auto stats = Property::getCopyStatistics();
+    BPy::dict dict;
+    dict["shared"] = stats.shared;
+    dict["copied"] = stats.copied;
+    return dict;
 }
 
 std::string PropertyPyWrapper::__str__(BPy::object self)
@@ -356,6 +356,8 @@ public:
 
     static std::string __str__(BPy::object self);
     static std::string __repr__(BPy::object self);
+
+    static BPy::dict getCopyStatistics();
 };
 } /* MindTree */
 #endif /* end of include guard: WRAPPER_FA9WP8AJ */
@@ -137,26 +137,7 @@ std::condition_variable HotProcessorManager::m_initCondition;
 void HotProcessorManager::watch()
 {
     while(m_watching.load()) {
-        QDir libdir("../processors/");
-        auto infos = libdir.entryInfoList();
-        for (auto info : infos) {
-           if(!info.isFile()) continue;
-
-            auto fp = info.filePath().toStdString();
-            auto it = m_processors.find(fp);
-            int64_t age = info.lastModified().toMSecsSinceEpoch();
-            if (it == m_processors.end()) {
-                std::cout << "new library" << std::endl;
-                m_processors.emplace(std::make_pair(fp, HotProcessor(fp)));
-            }
-            else if (age > it->second.age()) {
-                std::cout << "library changed" << std::endl;
-                std::cout << "old age: " << it->second.age() << "\n"
-                          << "new age: " << age << std::endl;
-                m_processors.erase(fp);
-                m_processors.emplace(std::make_pair(fp, HotProcessor(fp, age)));
-            }
-        }
+        load();
         if(!m_init) {
             m_init = true;
             m_initCondition.notify_all();
@@ -166,6 +147,30 @@ void HotProcessorManager::watch()
     }
 }
 
+void HotProcessorManager::load()
+{
+    QDir libdir("../processors/");
+    auto infos = libdir.entryInfoList();
+    for (auto info : infos) {
+        if(!info.isFile()) continue;
+
+        auto fp = info.filePath().toStdString();
+        auto it = m_processors.find(fp);
+        int64_t age = info.lastModified().toMSecsSinceEpoch();
+        if (it == m_processors.end()) {
+            std::cout << "new library" << std::endl;
+            m_processors.emplace(std::make_pair(fp, HotProcessor(fp)));
+        }
+        else if (age > it->second.age()) {
+            std::cout << "library changed" << std::endl;
+            std::cout << "old age: " << it->second.age() << "\n"
+                      << "new age: " << age << std::endl;
+            m_processors.erase(fp);
+            m_processors.emplace(std::make_pair(fp, HotProcessor(fp, age)));
+        }
+    }
+}
+
 void HotProcessorManager::start()
 {
     std::cout << "start watching libs" << std::endl;
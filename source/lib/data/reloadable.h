@@ -72,6 +72,9 @@ public:
     static void stop();
     static void watch();
 
+    //loads new and changed libraries once, without watching
+    static void load();
+
 private:
     static std::thread m_watchThread;
     static std::unordered_map<std::string, HotProcessor> m_processors;
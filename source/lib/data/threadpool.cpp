@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <exception>
+
+#include "data/debuglog.h"
+
+#include "threadpool.h"
+
+using namespace MindTree;
+
+namespace
+{
+thread_local ThreadPool *currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : _pending(0), _nextQueue(0), _running(true)
+{
+    if(!threadCount)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i = 0; i < threadCount; ++i)
+        _queues.push_back(std::make_unique<TaskQueue>());
+
+    for(size_t i = 0; i < threadCount; ++i)
+        _threads.emplace_back([this, i] { run(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running = false;
+    }
+    _wakeCondition.notify_all();
+
+    for(auto &thread : _threads)
+        if(thread.joinable()) thread.join();
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return _threads.size();
+}
+
+bool ThreadPool::isWorkerThread()
+{
+    return currentPool != nullptr;
+}
+
+void ThreadPool::submit(Task task)
+{
+    size_t index = currentPool == this
+        ? currentQueue
+        : _nextQueue++ % _queues.size();
+
+    //counted before it becomes visible, a worker popping it right away
+    //must not take _pending below zero
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        ++_pending;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    _wakeCondition.notify_one();
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, const RangeTask &task, size_t grainSize)
+{
+    if(!count) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t chunks = (count + grainSize - 1) / grainSize;
+    if(chunks == 1) {
+        task(0, count);
+        return;
+    }
+
+    struct Range {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto range = std::make_shared<Range>();
+
+    //helpers only ever run chunks they claimed themselves, chunks claimed
+    //after the caller returned can't exist
+    auto work = [range, &task, count, grainSize, chunks] {
+        size_t chunk;
+        while((chunk = range->next++) < chunks) {
+            size_t start = chunk * grainSize;
+            try {
+                task(start, std::min(start + grainSize, count));
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(range->mutex);
+                if(!range->error) range->error = std::current_exception();
+            }
+            if(++range->done == chunks) {
+                std::lock_guard<std::mutex> lock(range->mutex);
+                range->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(chunks - 1, getThreadCount());
+    for(size_t i = 0; i < helpers; ++i)
+        submit(work);
+
+    work();
+
+    std::unique_lock<std::mutex> lock(range->mutex);
+    range->finished.wait(lock, [&range, chunks] { return range->done == chunks; });
+
+    //every chunk is done, the output the caller gets is complete or it
+    //gets the first failure
+    if(range->error) std::rethrow_exception(range->error);
+}
+
+bool ThreadPool::popTask(size_t index, Task &task)
+{
+    auto &queue = *_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealTask(size_t index, Task &task)
+{
+    for(size_t i = 1; i < _queues.size(); ++i) {
+        auto &queue = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty()) continue;
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t index)
+{
+    currentPool = this;
+    currentQueue = index;
+
+    while(true) {
+        Task task;
+        if(popTask(index, task) || stealTask(index, task)) {
+            --_pending;
+            try {
+                task();
+            } catch(const std::exception &e) {
+                dbout("task failed: " << e.what());
+            } catch(...) {
+                //tasks report their own errors, nothing may escape the
+                //worker
+                dbout("task failed");
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCondition.wait(lock, [this] { return !_running || _pending > 0; });
+        if(!_running) return;
+    }
+}
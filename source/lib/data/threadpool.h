@@ -0,0 +1,68 @@
+#ifndef MT_THREADPOOL_H
+#define MT_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MindTree
+{
+
+/*
+ * Work stealing thread pool.
+ *
+ * Every worker owns a task queue. Tasks submitted from inside a worker
+ * are pushed onto that worker's queue and are popped LIFO by the owner,
+ * idle workers steal FIFO from the other queues. Tasks submitted from
+ * outside the pool are distributed round robin.
+ *
+ * parallelFor splits a range into chunks the calling thread works on as
+ * well, so it is safe to call from inside a task.
+ */
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(size_t, size_t)> RangeTask;
+
+    ThreadPool(size_t threadCount=0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);
+    void parallelFor(size_t count, const RangeTask &task, size_t grainSize=1024);
+    size_t getThreadCount() const;
+
+    static bool isWorkerThread();
+    static ThreadPool& instance();
+
+private:
+    struct TaskQueue {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    bool popTask(size_t index, Task &task);
+    bool stealTask(size_t index, Task &task);
+    void run(size_t index);
+
+    std::vector<std::unique_ptr<TaskQueue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+    std::atomic<size_t> _pending;
+    std::atomic<size_t> _nextQueue;
+    std::atomic<bool> _running;
+};
+
+}
+
+#endif
@@ -15,7 +15,9 @@ class ScatterPointsOnSurface(MT.pytypes.NodeDecorator):
     label = "Objects.Scatter Surface"
     insockets = [
         ("Object", "TRANSFORMABLE"),
-        ("count", "INTEGER", 100)
+        ("count", "INTEGER", 100),
+        ("Seed", "INTEGER", 0),
+        ("Min Distance", "FLOAT", 0.)
     ]
     outsockets = [ ("Pointcloud", "TRANSFORMABLE") ]
 
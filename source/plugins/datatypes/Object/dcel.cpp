@@ -255,7 +255,7 @@ Adapter::Adapter(std::shared_ptr<MeshData> mesh) :
     m_mesh(mesh)
 {
     auto points = mesh->getProperty("P").getData<std::shared_ptr<VertexList>>();
-    auto polygons = mesh->getProperty("polygon").getData<std::shared_ptr<PolygonList>>();
+    auto polygons = mesh->getPolygonBuffer();
 
     int i=0;
     for(auto p : *points) {
@@ -264,17 +264,20 @@ Adapter::Adapter(std::shared_ptr<MeshData> mesh) :
     }
 
     std::unordered_map<EdgeKey, Edge*> edge_map;
-    for(const Polygon &p : *polygons) {
+    for(size_t f = 0; polygons && f < polygons->size(); ++f) {
+        const uint *first = polygons->polygonBegin(f);
+        const uint *last = polygons->polygonEnd(f);
         Edge *prev{nullptr};
         std::vector<EdgeKey> adjacent_edges;
-        std::adjacent_find(begin(p),
-                           end(p),
+        std::adjacent_find(first,
+                           last,
                            [&adjacent_edges](const auto &a, const auto &b) {
                                adjacent_edges.push_back(EdgeKey(a, b));
                                return false;
                            });
 
-        for (int i : p) {
+        for (const uint *it = first; it != last; ++it) {
+            int i = *it;
             Vertex *origin = m_vertices[i].get();
             m_edges.push_back(std::make_unique<Edge>(this));
             auto newEdge = m_edges.back().get();
@@ -384,45 +387,28 @@ std::shared_ptr<MeshData> Adapter::getMesh()
 
 void Adapter::updateMesh()
 {
-    //update polygons
-    std::shared_ptr<PolygonList> polygons;
-    std::shared_ptr<VertexList> vertices;
-
-    if(!m_mesh->hasProperty("polygon")) {
-        polygons = std::make_shared<PolygonList>();
-        m_mesh->setProperty("polygon", polygons);
-    }
-    else {
-        polygons = m_mesh->getProperty("polygon")
-            .getData<std::shared_ptr<PolygonList>>();
-        polygons->clear();
-        polygons->reserve(m_faces.size());
-    }
-
-    if(!m_mesh->hasProperty("P")) {
-        vertices = std::make_shared<VertexList>();
-        m_mesh->setProperty("P", vertices);
-    }
-    else {
-        vertices = m_mesh->getProperty("P")
-            .getData<std::shared_ptr<VertexList>>();
-        vertices->clear();
-        vertices->reserve(m_vertices.size());
-    }
-
+    //new lists set once they are filled, the old ones may be shared with
+    //other meshes and setting them drops the cached bounds
+    auto vertices = std::make_shared<VertexList>();
+    vertices->reserve(m_vertices.size());
     for(const auto &vert : m_vertices) {
         vertices->push_back(vert->get("P").getData<glm::vec3>());
     }
+    m_mesh->setProperty("P", vertices);
 
+    auto polygons = std::make_shared<PolygonBuffer>();
+    polygons->reserve(m_faces.size(), 0);
+    Polygon p;
     for(const auto &face : m_faces) {
         auto *start = face->outerBoundary();
         auto *e = start;
-        Polygon p;
+        p.clear();
         do {
             p.push_back(e->origin()->index());
         } while ((e = e->next()) != start);
-        polygons->push_back(p);
+        polygons->addPolygon(begin(p), end(p));
     }
+    m_mesh->setProperty("polygon", polygons);
     m_mesh->computeVertexNormals();
 
     return;
@@ -17,10 +17,14 @@
 */
 
 #include "cmath"
+#include "shared_mutex"
+#include "unordered_map"
 
 #define GLM_SWIZZLE
 #include "glm/gtc/matrix_transform.hpp"
 
+#include "data/threadpool.h"
+
 #include "lights.h"
 
 #include "object.h"
@@ -37,9 +41,191 @@ PROPERTY_TYPE_INFO(PointLightPtr, "TRANSFORMABLE");
 PROPERTY_TYPE_INFO(DistantLightPtr, "TRANSFORMABLE");
 PROPERTY_TYPE_INFO(SpotLightPtr, "TRANSFORMABLE");
 PROPERTY_TYPE_INFO(EmptyPtr, "TRANSFORMABLE");
+PROPERTY_TYPE_INFO(InstancerPtr, "TRANSFORMABLE");
 PROPERTY_TYPE_INFO(CameraPtr, "TRANSFORMABLE");
 
 PROPERTY_TYPE_INFO(Polygon, "POLYGON");
+PROPERTY_TYPE_INFO(PolygonBufferPtr, "POLYGONBUFFER");
+
+PolygonBuffer::PolygonBuffer(const PolygonList &polygons)
+{
+    _offsets.resize(polygons.size() + 1);
+    _offsets[0] = 0;
+    for(size_t i = 0; i < polygons.size(); ++i)
+        _offsets[i + 1] = _offsets[i] + polygons[i].size();
+
+    _indices.resize(_offsets.back());
+    for(size_t i = 0; i < polygons.size(); ++i)
+        std::copy(begin(polygons[i]), end(polygons[i]), begin(_indices) + _offsets[i]);
+}
+
+PolygonBuffer::PolygonBuffer(std::vector<uint> indices, std::vector<uint> offsets)
+    : _indices(std::move(indices)), _offsets(std::move(offsets))
+{
+    if(_offsets.empty()) _offsets.push_back(0);
+}
+
+size_t PolygonBuffer::getTriangleCount() const
+{
+    size_t cnt = 0;
+    for(size_t i = 0; i < size(); ++i)
+        if(polygonSize(i) > 2)
+            cnt += polygonSize(i) - 2;
+    return cnt;
+}
+
+void PolygonBuffer::reserve(size_t polygons, size_t indices)
+{
+    _offsets.reserve(polygons + 1);
+    _indices.reserve(indices);
+}
+
+void PolygonBuffer::setPolygon(size_t polygon, const uint *begin, const uint *end)
+{
+    if(polygon >= size()) {
+        _offsets.resize(polygon + 1, _indices.size());
+        addPolygon(begin, end);
+        return;
+    }
+
+    const size_t oldSize = polygonSize(polygon);
+    const size_t newSize = end - begin;
+    auto first = _indices.begin() + _offsets[polygon];
+    if(newSize > oldSize)
+        first = _indices.insert(first + oldSize, newSize - oldSize, 0) - oldSize;
+    else if(newSize < oldSize)
+        first = _indices.erase(first + newSize, first + oldSize) - newSize;
+
+    if(newSize != oldSize)
+        for(size_t i = polygon + 1; i < _offsets.size(); ++i)
+            _offsets[i] = _offsets[i] + newSize - oldSize;
+
+    std::copy(begin, end, first);
+}
+
+void PolygonBuffer::clear()
+{
+    _indices.clear();
+    _offsets.assign(1, 0);
+}
+
+std::vector<uint> PolygonBuffer::triangulate() const
+{
+    std::vector<uint> triangles(getTriangleCount() * 3);
+    auto out = begin(triangles);
+    for(size_t i = 0; i < size(); ++i) {
+        const uint *poly = polygonBegin(i);
+        for(uint j = 1; j + 1 < polygonSize(i); ++j) {
+            *out++ = poly[0];
+            *out++ = poly[j];
+            *out++ = poly[j + 1];
+        }
+    }
+    return triangles;
+}
+
+PolygonList PolygonBuffer::toList() const
+{
+    PolygonList polygons;
+    polygons.reserve(size());
+    for(size_t i = 0; i < size(); ++i)
+        polygons.emplace_back(polygonBegin(i), polygonEnd(i));
+    return polygons;
+}
+
+namespace {
+void polygonListToBuffer(void *from, void *to)
+{
+    const auto &list = reinterpret_cast<PropertyData<PolygonListPtr>*>(from)->getData();
+    auto *buffer = reinterpret_cast<PolygonBufferPtr*>(to);
+    *buffer = list ? std::make_shared<PolygonBuffer>(*list) : nullptr;
+}
+
+void polygonBufferToList(void *from, void *to)
+{
+    const auto &buffer = reinterpret_cast<PropertyData<PolygonBufferPtr>*>(from)->getData();
+    auto *list = reinterpret_cast<PolygonListPtr*>(to);
+    *list = buffer ? std::make_shared<PolygonList>(buffer->toList()) : nullptr;
+}
+}
+
+void PolygonBuffer::registerConverters()
+{
+    auto listType = PropertyTypeInfo<PolygonListPtr>::getType();
+    auto bufferType = PropertyTypeInfo<PolygonBufferPtr>::getType();
+    PropertyConverter::registerConverter(listType, bufferType, polygonListToBuffer);
+    PropertyConverter::registerConverter(bufferType, listType, polygonBufferToList);
+}
+
+namespace MindTree {
+void PropertyListTraits<PolygonBufferPtr>::setItem(Property &self, int index, Property value)
+{
+    if(index < 0) return;
+
+    //written in place like the other shared lists, element wise writes
+    //only move indices when the polygon changes its size
+    auto &polygons = self.getDataRef<PolygonBufferPtr>();
+    if(!polygons) polygons = std::make_shared<PolygonBuffer>();
+
+    auto polygon = value.getData<Polygon>();
+    polygons->setPolygon(index, polygon.data(), polygon.data() + polygon.size());
+}
+
+Property PropertyListTraits<PolygonBufferPtr>::gatherItems(const Property &self,
+                                                           const std::vector<uint32_t> &indices)
+{
+    const auto &polygons = self.getDataRef<PolygonBufferPtr>();
+    auto items = std::make_shared<PolygonBuffer>();
+    for(uint32_t i : indices) {
+        if(i < polygons->size())
+            items->addPolygon(polygons->polygonBegin(i), polygons->polygonEnd(i));
+        else
+            items->addPolygon({});
+    }
+    return items;
+}
+}
+
+bool AABB::isEmpty() const
+{
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+glm::vec3 AABB::getCenter() const
+{
+    return (min + max) * 0.5f;
+}
+
+void AABB::extend(const glm::vec3 &point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::extend(const AABB &other)
+{
+    if(other.isEmpty()) return;
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+AABB AABB::transformed(const glm::mat4 &transformation) const
+{
+    if(isEmpty()) return *this;
+
+    //Arvo's method, every matrix entry moves either bound along its row
+    AABB box;
+    box.min = box.max = glm::vec3(transformation[3]);
+    for(int col = 0; col < 3; ++col) {
+        for(int row = 0; row < 3; ++row) {
+            float a = transformation[col][row] * min[col];
+            float b = transformation[col][row] * max[col];
+            box.min[row] += std::min(a, b);
+            box.max[row] += std::max(a, b);
+        }
+    }
+    return box;
+}
 
 AbstractTransformable::AbstractTransformable(eObjType t)
     : center(0, 0, 0), type(t), _parent(nullptr)
@@ -299,66 +485,379 @@ std::string MeshData::getName()
     return name;
 }
 
-void MeshData::computeVertexNormals()    
+void MeshData::computeVertexNormals(eNormalWeighting weighting)
+{
+    auto polygons = getPolygonBuffer();
+    auto verts = getAttributeSpan<glm::vec3>(POSITION);
+    if(!polygons || !verts) return;
+
+    const auto &indices = polygons->getIndices();
+    const auto &faceOffsets = polygons->getOffsets();
+    const size_t faceCount = polygons->size();
+    const size_t vertexCount = verts.size();
+    auto &pool = MindTree::ThreadPool::instance();
+
+    //faces referencing points that don't exist are skipped, they neither
+    //get a normal nor contribute to the normals of their other points
+    std::vector<char> validFaces(faceCount, 1);
+    for(size_t f = 0; f < faceCount; ++f)
+        for(uint32_t c = faceOffsets[f]; c < faceOffsets[f + 1]; ++c)
+            if(indices[c] >= vertexCount) {
+                validFaces[f] = 0;
+                break;
+            }
+
+    //face normals, kept as separate components so the accumulation
+    //vectorizes, their length is twice the face area
+    std::vector<float> nx(faceCount), ny(faceCount), nz(faceCount);
+    pool.parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            const uint *poly = polygons->polygonBegin(f);
+            const uint size = polygons->polygonSize(f);
+            float x = 0, y = 0, z = 0;
+            if(size > 2 && validFaces[f]) {
+                const glm::vec3 first = verts[poly[0]];
+                glm::vec3 prev = verts[poly[1]] - first;
+                for(uint j = 2; j < size; ++j) {
+                    const glm::vec3 cur = verts[poly[j]] - first;
+                    x += prev.y * cur.z - prev.z * cur.y;
+                    y += prev.z * cur.x - prev.x * cur.z;
+                    z += prev.x * cur.y - prev.y * cur.x;
+                    prev = cur;
+                }
+            }
+            nx[f] = x;
+            ny[f] = y;
+            nz[f] = z;
+        }
+    });
+
+    if(weighting != AREA_WEIGHTS) {
+        pool.parallelFor(faceCount, [&] (size_t start, size_t end) {
+            for(size_t f = start; f < end; ++f) {
+                float length = std::sqrt(nx[f] * nx[f] + ny[f] * ny[f] + nz[f] * nz[f]);
+                float scale = length > 0 ? 1.f / length : 0.f;
+                nx[f] *= scale;
+                ny[f] *= scale;
+                nz[f] *= scale;
+            }
+        });
+    }
+
+    //vertex to corner adjacency, every vertex gathers from its own
+    //corners so no two threads write the same normal
+    std::vector<uint32_t> vertexOffsets(vertexCount + 1, 0);
+    for(size_t f = 0; f < faceCount; ++f)
+        if(validFaces[f])
+            for(uint32_t c = faceOffsets[f]; c < faceOffsets[f + 1]; ++c)
+                ++vertexOffsets[indices[c] + 1];
+    for(size_t v = 0; v < vertexCount; ++v)
+        vertexOffsets[v + 1] += vertexOffsets[v];
+
+    std::vector<uint32_t> vertexCorners(vertexOffsets[vertexCount]);
+    {
+        std::vector<uint32_t> cursor(begin(vertexOffsets), end(vertexOffsets) - 1);
+        for(size_t f = 0; f < faceCount; ++f)
+            if(validFaces[f])
+                for(uint32_t c = faceOffsets[f]; c < faceOffsets[f + 1]; ++c)
+                    vertexCorners[cursor[indices[c]]++] = c;
+    }
+
+    std::vector<uint32_t> cornerFaces(indices.size());
+    pool.parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f)
+            for(uint32_t c = faceOffsets[f]; c < faceOffsets[f + 1]; ++c)
+                cornerFaces[c] = f;
+    });
+
+    auto vertexnormals = std::make_shared<VertexList>(vertexCount);
+    auto &normals = *vertexnormals;
+    pool.parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        for(size_t v = start; v < end; ++v) {
+            glm::vec3 normal(0);
+            for(uint32_t i = vertexOffsets[v]; i < vertexOffsets[v + 1]; ++i) {
+                uint32_t c = vertexCorners[i];
+                uint32_t f = cornerFaces[c];
+                float weight = 1.f;
+
+                if(weighting == ANGLE_WEIGHTS) {
+                    const uint *poly = polygons->polygonBegin(f);
+                    const uint size = polygons->polygonSize(f);
+                    uint j = c - faceOffsets[f];
+                    glm::vec3 e0 = verts[poly[(j + 1) % size]] - verts[v];
+                    glm::vec3 e1 = verts[poly[(j + size - 1) % size]] - verts[v];
+                    float lengths = glm::length(e0) * glm::length(e1);
+                    weight = lengths > 0
+                        ? std::acos(glm::clamp(glm::dot(e0, e1) / lengths, -1.f, 1.f))
+                        : 0.f;
+                }
+
+                normal += weight * glm::vec3(nx[f], ny[f], nz[f]);
+            }
+
+            float length = glm::length(normal);
+            normals[v] = length > 0 ? normal / length : normal;
+        }
+    });
+
+    setProperty("N", vertexnormals);
+}
+
+int MeshData::getVertexCount() const
+{
+    return getAttributeSpan<glm::vec3>(POSITION).size();
+}
+
+int MeshData::getPolygonCount() const
 {
-    auto facenormals = std::make_shared<VertexList>();
-    auto polygons = getProperty("polygon").getData<std::shared_ptr<PolygonList>>();
-    auto vertices = getProperty("P").getData<std::shared_ptr<VertexList>>();
-    auto vertexnormals = std::make_shared<VertexList>();
-    vertexnormals->resize(vertices->size());
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table || POLYGON >= table->columns.size()) return 0;
 
-    for(const auto &poly : *polygons) {
-        glm::vec3 normal;
+    //count lists in place instead of converting them
+    const Property &column = table->columns[POLYGON];
+    if(column.holds<PolygonListPtr>()) {
+        const auto &list = column.getDataRef<PolygonListPtr>();
+        if(!list) return 0;
 
-        for(int j=2; j<poly.size(); j++){
-            uint vec_prev_i = poly[j - 1];
-            uint vec_cur_i = poly[j];
-            uint vec_first_i = poly[0];
+        int cnt = 0;
+        for(const auto &p : *list)
+            if(p.size() > 2)
+                cnt += p.size() - 2;
+        return cnt;
+    }
 
-            glm::vec3 vec_prev = vertices->at(vec_prev_i);
-            glm::vec3 vec_cur = vertices->at(vec_cur_i);
-            glm::vec3 vec_first = vertices->at(vec_first_i);
+    auto polygons = getPolygonBuffer();
+    if(!polygons) return 0;
+    return polygons->getTriangleCount();
+}
 
-            glm::vec3 vec1 = vec_cur - vec_prev;
-            glm::vec3 vec2 = vec_cur - vec_first;
-            glm::vec3 cross = glm::cross(vec2, vec1);
+PolygonBufferPtr MeshData::getPolygonBuffer() const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table || POLYGON >= table->columns.size()) return nullptr;
 
-            //do not accidentally kill the normal
-            glm::vec3 new_normal = normal + cross;
-            if(glm::length(new_normal) > 0)
-                normal = new_normal;
-        }
+    const Property &column = table->columns[POLYGON];
+    if(column.holds<PolygonBufferPtr>())
+        return column.getData<PolygonBufferPtr>();
 
-        for (int i : poly) {
-            vertexnormals->at(i) += glm::normalize(normal);
+    if(!column.holds<PolygonListPtr>()) return nullptr;
+
+    //not cached, the list may be changed in place through its pointer
+    const auto &list = column.getDataRef<PolygonListPtr>();
+    if(!list) return nullptr;
+    return std::make_shared<PolygonBuffer>(*list);
+}
+
+namespace {
+struct AttributeNames {
+    AttributeNames()
+    {
+        //MeshData::POSITION, NORMAL and POLYGON
+        for(std::string name : {"P", "N", "polygon"}) {
+            ids[name] = names.size();
+            names.push_back(name);
         }
     }
 
-    for(auto &n : *vertexnormals)
-        n = glm::normalize(n);
+    std::shared_timed_mutex mutex;
+    std::unordered_map<std::string, MeshData::AttributeID> ids;
+    std::vector<std::string> names;
+};
 
-    setProperty("N", vertexnormals);
+AttributeNames& attributeNames()
+{
+    static AttributeNames names;
+    return names;
+}
 }
 
-int MeshData::getVertexCount() const
+const MeshData::AttributeID MeshData::POSITION = 0;
+const MeshData::AttributeID MeshData::NORMAL = 1;
+const MeshData::AttributeID MeshData::POLYGON = 2;
+
+MeshData::AttributeID MeshData::getAttributeID(const std::string &name)
+{
+    auto &table = attributeNames();
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(table.mutex);
+        auto it = table.ids.find(name);
+        if(it != end(table.ids)) return it->second;
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(table.mutex);
+    auto it = table.ids.find(name);
+    if(it != end(table.ids)) return it->second;
+
+    AttributeID id = table.names.size();
+    table.ids[name] = id;
+    table.names.push_back(name);
+    return id;
+}
+
+std::string MeshData::getAttributeName(AttributeID id)
 {
-    if(!hasProperty("P")) return 0;
-    auto list = getProperty("P").getData<VertexListPtr>();
-    if(!list) return 0;
-    return list->size();
+    auto &table = attributeNames();
+    std::shared_lock<std::shared_timed_mutex> lock(table.mutex);
+    if(id >= table.names.size()) return "";
+    return table.names[id];
 }
 
-int MeshData::getPolygonCount() const
+void MeshData::setProperty(const std::string &name, Property value)
 {
-    if(!hasProperty("polygon")) return 0;
-    auto list = getProperty("polygon").getData<PolygonListPtr>();
-    if(!list) return 0;
+    AttributeID id = getAttributeID(name);
 
-    int cnt = 0;
-    for(auto p : *list) {
-        cnt += p.size() - 2;
+    std::lock_guard<std::mutex> lock(_attributesLock);
+    ObjectData::setProperty(name, value);
+
+    //copy the columns into a new table, readers holding the old one keep
+    //seeing consistent data
+    auto table = std::make_shared<AttributeTable>();
+    size_t count = _attributes ? _attributes->columns.size() : 0;
+    table->columns.reserve(std::max(count, size_t(id + 1)));
+    for(AttributeID i = 0; i < std::max(count, size_t(id + 1)); ++i) {
+        if(i == id)
+            table->columns.push_back(value);
+        else if(i < count)
+            table->columns.push_back(_attributes->columns[i]);
+        else
+            table->columns.emplace_back();
     }
-    return cnt;
+    std::atomic_store(&_attributes, AttributeTablePtr(table));
+}
+
+void MeshData::rmProperty(const std::string &name)
+{
+    AttributeID id = getAttributeID(name);
+
+    std::lock_guard<std::mutex> lock(_attributesLock);
+    ObjectData::rmProperty(name);
+    if(!_attributes || id >= _attributes->columns.size()) return;
+
+    auto table = std::make_shared<AttributeTable>();
+    table->columns.reserve(_attributes->columns.size());
+    for(AttributeID i = 0; i < _attributes->columns.size(); ++i) {
+        if(i == id)
+            table->columns.emplace_back();
+        else
+            table->columns.push_back(_attributes->columns[i]);
+    }
+    std::atomic_store(&_attributes, AttributeTablePtr(table));
+}
+
+AABB MeshData::getBounds() const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table) return AABB();
+
+    //read the positions from the same table the bounds are stored in
+    const VertexList *points = nullptr;
+    if(POSITION < table->columns.size()) {
+        const Property &column = table->columns[POSITION];
+        if(column.holds<VertexList>())
+            points = &column.getDataRef<VertexList>();
+        else if(column.holds<VertexListPtr>())
+            points = column.getDataRef<VertexListPtr>().get();
+    }
+    size_t size = points ? points->size() : 0;
+
+    auto cached = std::atomic_load(&table->bounds);
+    if(cached && cached->points == points && cached->size == size)
+        return cached->bounds;
+
+    AABB bounds;
+    if(points) {
+        for(const auto &p : *points)
+            bounds.extend(p);
+    }
+
+    std::atomic_store(&table->bounds,
+                      std::shared_ptr<const CachedBounds>(
+                          std::make_shared<CachedBounds>(CachedBounds{bounds, points, size})));
+    return bounds;
+}
+
+std::vector<MeshData::AttributeID> MeshData::getAttributeIDs() const
+{
+    std::vector<AttributeID> ids;
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table) return ids;
+
+    for(AttributeID i = 0; i < table->columns.size(); ++i)
+        if(table->columns[i])
+            ids.push_back(i);
+    return ids;
+}
+
+bool MeshData::hasAttribute(AttributeID id) const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    return table && id < table->columns.size() && table->columns[id];
+}
+
+Property MeshData::getAttribute(AttributeID id) const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table || id >= table->columns.size()) return Property();
+    return table->columns[id];
+}
+
+size_t MeshData::getDomainSize(const AttributeTable &table, eAttributeDomain domain)
+{
+    auto column = [&table] (AttributeID id) -> const Property* {
+        if(id >= table.columns.size() || !table.columns[id]) return nullptr;
+        return &table.columns[id];
+    };
+
+    switch(domain) {
+        case POINT_DOMAIN:
+            if(const Property *points = column(POSITION))
+                return points->isList() ? points->size() : 0;
+            return 0;
+        case POLYGON_DOMAIN:
+            if(const Property *polygons = column(POLYGON))
+                return polygons->isList() ? polygons->size() : 0;
+            return 0;
+        case CORNER_DOMAIN:
+            if(const Property *polygons = column(POLYGON)) {
+                if(polygons->holds<PolygonBufferPtr>()) {
+                    const auto &buffer = polygons->getDataRef<PolygonBufferPtr>();
+                    return buffer ? buffer->getIndexCount() : 0;
+                }
+                if(polygons->holds<PolygonListPtr>()) {
+                    const auto &list = polygons->getDataRef<PolygonListPtr>();
+                    size_t corners = 0;
+                    if(list)
+                        for(const auto &poly : *list)
+                            corners += poly.size();
+                    return corners;
+                }
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+size_t MeshData::getDomainSize(eAttributeDomain domain) const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table) return 0;
+    return getDomainSize(*table, domain);
+}
+
+MeshData::eAttributeDomain MeshData::getAttributeDomain(AttributeID id) const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table || id >= table->columns.size()) return NO_DOMAIN;
+
+    const Property &column = table->columns[id];
+    if(!column.isList()) return NO_DOMAIN;
+
+    for(auto domain : {POINT_DOMAIN, POLYGON_DOMAIN, CORNER_DOMAIN})
+        if(column.size() == getDomainSize(*table, domain))
+            return domain;
+
+    return NO_DOMAIN;
 }
 
 GeoObject::GeoObject()
@@ -390,12 +889,94 @@ int GeoObject::getPolygonCount() const
     return cnt;
 }
 
+AABB GeoObject::getBounds() const
+{
+    if(!data || data->getType() != ObjectData::MESH) return AABB();
+    return std::static_pointer_cast<MeshData>(data)->getBounds();
+}
+
 AbstractTransformablePtr GeoObject::clone() const
 {
     auto *obj = new GeoObject(*this);
     return std::shared_ptr<AbstractTransformable>(obj);
 }
 
+Instancer::Instancer(AbstractTransformablePtr prototype,
+                     std::shared_ptr<const TransformationList> transformations)
+    : AbstractTransformable(INSTANCER),
+    _prototype(prototype),
+    _transformations(transformations)
+{
+}
+
+Instancer::Instancer(const Instancer &other)
+    : AbstractTransformable(other),
+    _prototype(other._prototype),
+    _transformations(other._transformations)
+{
+}
+
+Instancer::~Instancer()
+{
+}
+
+AbstractTransformablePtr Instancer::clone() const
+{
+    auto *obj = new Instancer(*this);
+    return std::shared_ptr<AbstractTransformable>(obj);
+}
+
+AbstractTransformablePtr Instancer::getPrototype() const
+{
+    return _prototype;
+}
+
+std::shared_ptr<const Instancer::TransformationList> Instancer::getInstanceTransformations() const
+{
+    return _transformations;
+}
+
+size_t Instancer::getInstanceCount() const
+{
+    return _transformations ? _transformations->size() : 0;
+}
+
+bool Instancer::canInstance(AbstractTransformablePtr obj)
+{
+    if(obj->getType() != GEO && obj->getType() != EMPTY)
+        return false;
+
+    for(const auto &child : obj->getChildren())
+        if(!canInstance(child)) return false;
+    return true;
+}
+
+std::vector<AbstractTransformablePtr> Instancer::expand() const
+{
+    std::vector<AbstractTransformablePtr> copies;
+    copies.reserve(getInstanceCount());
+    for(size_t i = 0; i < getInstanceCount(); ++i) {
+        auto copy = _prototype->clone();
+        copy->setTransformation((*_transformations)[i] * copy->getTransformation());
+        copies.push_back(copy);
+    }
+    return copies;
+}
+
+int Instancer::getVertexCount() const
+{
+    int cnt = AbstractTransformable::getVertexCount();
+    cnt += _prototype->getVertexCount() * getInstanceCount();
+    return cnt;
+}
+
+int Instancer::getPolygonCount() const
+{
+    int cnt = AbstractTransformable::getPolygonCount();
+    cnt += _prototype->getPolygonCount() * getInstanceCount();
+    return cnt;
+}
+
 MaterialInstancePtr GeoObject::getMaterial()
 {
     return _material;
@@ -448,6 +1029,15 @@ std::vector<std::shared_ptr<GeoObject>> Group::getGeometry() const
     return objs;
 }
 
+std::vector<std::shared_ptr<Instancer>> Group::getInstancers() const
+{
+    std::vector<std::shared_ptr<Instancer>> instancers;
+    for(auto &obj : members)
+        if(obj->getType() == AbstractTransformable::INSTANCER)
+            instancers.push_back(std::static_pointer_cast<Instancer>(obj));
+    return instancers;
+}
+
 int Group::getVertexCount() const
 {
     int cnt = 0;
@@ -567,3 +1157,47 @@ glm::mat4 Camera::getViewMatrix()
     return glm::inverse(getWorldTransformation());
 }
 
+namespace MindTree {
+size_t PropertySize<AbstractTransformablePtr>::size(const AbstractTransformablePtr &value)
+{
+    if(!value) return sizeof(value);
+
+    size_t bytes = sizeof(value);
+    switch(value->getType()) {
+        case AbstractTransformable::GEO:
+            bytes += sizeof(GeoObject)
+                + PropertySize<ObjectDataPtr>::size(std::static_pointer_cast<GeoObject>(value)->getData());
+            break;
+        case AbstractTransformable::INSTANCER:
+            {
+                auto instancer = std::static_pointer_cast<Instancer>(value);
+                bytes += sizeof(Instancer)
+                    + size(instancer->getPrototype())
+                    + instancer->getInstanceCount() * sizeof(glm::mat4);
+            }
+            break;
+        default:
+            bytes += sizeof(AbstractTransformable);
+            break;
+    }
+
+    for(const auto &child : value->getChildren())
+        bytes += size(child);
+    return bytes;
+}
+
+size_t PropertySize<GeoObjectPtr>::size(const GeoObjectPtr &value)
+{
+    return PropertySize<AbstractTransformablePtr>::size(value);
+}
+
+size_t PropertySize<GroupPtr>::size(const GroupPtr &value)
+{
+    if(!value) return sizeof(value);
+
+    size_t bytes = sizeof(value) + sizeof(Group);
+    for(const auto &member : value->getMembers())
+        bytes += PropertySize<AbstractTransformablePtr>::size(member);
+    return bytes;
+}
+}
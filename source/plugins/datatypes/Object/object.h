@@ -31,6 +31,7 @@
 
 #include "mutex"
 #include "atomic"
+#include "limits"
 
 typedef std::vector<glm::vec3> VertexList;
 typedef std::shared_ptr<VertexList> VertexListPtr;
@@ -40,6 +41,74 @@ struct Polygon : public std::vector<uint> {
 typedef std::vector<Polygon> PolygonList;
 typedef std::shared_ptr<PolygonList> PolygonListPtr;
 
+//compact polygon storage, the indices of all polygons live in one flat
+//array and polygon i uses indices offsets[i] ... offsets[i + 1] - 1.
+//meshes can store this instead of a PolygonList under "polygon", both
+//types convert into each other when read through Property::getData
+class PolygonBuffer
+{
+public:
+    PolygonBuffer() : _offsets(1, 0) {}
+    explicit PolygonBuffer(const PolygonList &polygons);
+    //takes over ready made storage, offsets has one more entry than there
+    //are polygons and starts at 0
+    PolygonBuffer(std::vector<uint> indices, std::vector<uint> offsets);
+
+    size_t size() const { return _offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+    size_t getIndexCount() const { return _indices.size(); }
+    size_t getTriangleCount() const;
+
+    uint polygonSize(size_t polygon) const { return _offsets[polygon + 1] - _offsets[polygon]; }
+    const uint* polygonBegin(size_t polygon) const { return _indices.data() + _offsets[polygon]; }
+    const uint* polygonEnd(size_t polygon) const { return _indices.data() + _offsets[polygon + 1]; }
+    Polygon getPolygon(size_t polygon) const { return Polygon(polygonBegin(polygon), polygonEnd(polygon)); }
+
+    template<typename Iterator>
+    void addPolygon(Iterator begin, Iterator end)
+    {
+        _indices.insert(_indices.end(), begin, end);
+        _offsets.push_back(_indices.size());
+    }
+    void addPolygon(std::initializer_list<uint> polygon) { addPolygon(polygon.begin(), polygon.end()); }
+
+    //overwrites a polygon of the same size in place, other sizes move the
+    //indices of the following polygons. Polygons past the end are
+    //appended, the gap is filled with empty polygons
+    void setPolygon(size_t polygon, const uint *begin, const uint *end);
+    void reserve(size_t polygons, size_t indices);
+    void clear();
+
+    const std::vector<uint>& getIndices() const { return _indices; }
+    const std::vector<uint>& getOffsets() const { return _offsets; }
+
+    //fan triangulation of every polygon
+    std::vector<uint> triangulate() const;
+    PolygonList toList() const;
+
+    static void registerConverters();
+
+private:
+    std::vector<uint> _indices;
+    std::vector<uint> _offsets;
+};
+typedef std::shared_ptr<PolygonBuffer> PolygonBufferPtr;
+
+//axis aligned bounding box, a default constructed box is empty
+struct AABB
+{
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+    bool isEmpty() const;
+    glm::vec3 getCenter() const;
+    void extend(const glm::vec3 &point);
+    void extend(const AABB &other);
+
+    //the box enclosing this box after the transformation
+    AABB transformed(const glm::mat4 &transformation) const;
+};
+
 class MeshData;
 class AbstractTransformable;
 typedef std::shared_ptr<AbstractTransformable> AbstractTransformablePtr;
@@ -47,7 +116,7 @@ class AbstractTransformable : public MindTree::Object
 {
 public:
     enum eObjType {
-        GEO, CAMERA, LIGHT, EMPTY, JOINT
+        GEO, CAMERA, LIGHT, EMPTY, JOINT, INSTANCER
     };
     AbstractTransformable(eObjType t);
     virtual ~AbstractTransformable();
@@ -141,6 +210,30 @@ private:
 
 typedef std::shared_ptr<ObjectData> ObjectDataPtr;
 
+//read only view of an attribute column, keeps the column alive
+template<typename T>
+class AttributeSpan
+{
+public:
+    AttributeSpan() = default;
+    AttributeSpan(const T *data, size_t size, std::shared_ptr<const void> owner)
+        : _data(data), _size(size), _owner(std::move(owner))
+    {}
+
+    const T* data() const { return _data; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const T& operator[](size_t i) const { return _data[i]; }
+    explicit operator bool() const { return _data != nullptr; }
+
+private:
+    const T *_data = nullptr;
+    size_t _size = 0;
+    std::shared_ptr<const void> _owner;
+};
+
 class MeshData : public ObjectData
 {
 public:
@@ -164,15 +257,255 @@ public:
     virtual ~MeshData();
     std::string getName();
 
-    void computeVertexNormals();
+    //how the normals of the adjacent faces contribute to a vertex normal
+    enum eNormalWeighting {
+        UNIFORM_WEIGHTS,
+        AREA_WEIGHTS,
+        ANGLE_WEIGHTS
+    };
+
+    //faces with indices past the last point are left out
+    void computeVertexNormals(eNormalWeighting weighting=UNIFORM_WEIGHTS);
     int getVertexCount() const;
     int getPolygonCount() const;
 
+    //the "polygon" property as a PolygonBuffer, shared when the mesh
+    //already stores one, converted from a PolygonList on every call
+    //otherwise
+    PolygonBufferPtr getPolygonBuffer() const;
+
+    //attribute columns.
+    //attribute names are interned into ids once, the columns are kept
+    //in an immutable table indexed by id that is replaced on every
+    //setProperty, so reading a column takes no lock and no string lookup
+    typedef uint32_t AttributeID;
+    static const AttributeID POSITION;
+    static const AttributeID NORMAL;
+    static const AttributeID POLYGON;
+
+    enum eAttributeDomain {
+        POINT_DOMAIN,
+        POLYGON_DOMAIN,
+        CORNER_DOMAIN,
+        NO_DOMAIN
+    };
+
+    static AttributeID getAttributeID(const std::string &name);
+    static std::string getAttributeName(AttributeID id);
+
+    void setProperty(const std::string &name, MindTree::Property value) override;
+    void rmProperty(const std::string &name) override;
+
+    std::vector<AttributeID> getAttributeIDs() const;
+    bool hasAttribute(AttributeID id) const;
+    MindTree::Property getAttribute(AttributeID id) const;
+
+    //the domain is found by comparing the column size with the number of
+    //points, polygons and polygon corners
+    eAttributeDomain getAttributeDomain(AttributeID id) const;
+    size_t getDomainSize(eAttributeDomain domain) const;
+
+    //the column as a span of T if it holds a std::vector<T> or a
+    //std::shared_ptr<std::vector<T>>, and if a domain is given, only if
+    //it has as many values as the domain. empty otherwise
+    template<typename T>
+    AttributeSpan<T> getAttributeSpan(AttributeID id, eAttributeDomain domain=NO_DOMAIN) const;
+
+    //bounds of the point positions, computed on first use and kept until
+    //the attributes change or the point list changes its address or size
+    AABB getBounds() const;
+
 private:
+    //the point list the bounds were computed from, lists written in
+    //place after they were set only invalidate the bounds by resizing
+    struct CachedBounds {
+        AABB bounds;
+        const VertexList *points;
+        size_t size;
+    };
+
+    struct AttributeTable {
+        std::vector<MindTree::Property> columns;
+        mutable std::shared_ptr<const CachedBounds> bounds;
+    };
+    typedef std::shared_ptr<const AttributeTable> AttributeTablePtr;
+
+    static size_t getDomainSize(const AttributeTable &table, eAttributeDomain domain);
+
     std::string name;
+    AttributeTablePtr _attributes;
+    std::mutex _attributesLock;
 };
+
+template<typename T>
+AttributeSpan<T> MeshData::getAttributeSpan(AttributeID id, eAttributeDomain domain) const
+{
+    AttributeTablePtr table = std::atomic_load(&_attributes);
+    if(!table || id >= table->columns.size()) return AttributeSpan<T>();
+
+    const MindTree::Property &column = table->columns[id];
+    const std::vector<T> *values = nullptr;
+    if(column.holds<std::vector<T>>())
+        values = &column.getDataRef<std::vector<T>>();
+    else if(column.holds<std::shared_ptr<std::vector<T>>>())
+        values = column.getDataRef<std::shared_ptr<std::vector<T>>>().get();
+
+    if(!values) return AttributeSpan<T>();
+    if(domain != NO_DOMAIN && values->size() != getDomainSize(*table, domain))
+        return AttributeSpan<T>();
+
+    return AttributeSpan<T>(values->data(), values->size(), table);
+}
 typedef std::shared_ptr<MeshData> MeshDataPtr;
 
+namespace MindTree {
+template<>
+struct PropertyHash<Polygon> : public PropertyHash<std::vector<uint>> {};
+
+template<>
+struct PropertyEqual<Polygon> : public PropertyEqual<std::vector<uint>> {};
+
+template<>
+struct PropertySize<Polygon> : public PropertySize<std::vector<uint>> {};
+
+template<>
+struct PropertyHash<PolygonBufferPtr> {
+    static bool hash(const PolygonBufferPtr &value, size_t &seed)
+    {
+        if(!value) {
+            hashCombine(seed, 0);
+            return true;
+        }
+        PropertyHash<std::vector<uint>>::hash(value->getOffsets(), seed);
+        return PropertyHash<std::vector<uint>>::hash(value->getIndices(), seed);
+    }
+};
+
+template<>
+struct PropertyEqual<PolygonBufferPtr> {
+    static bool equal(const PolygonBufferPtr &lhs, const PolygonBufferPtr &rhs)
+    {
+        if(lhs == rhs) return true;
+        if(!lhs || !rhs) return false;
+        return lhs->getOffsets() == rhs->getOffsets()
+            && lhs->getIndices() == rhs->getIndices();
+    }
+};
+
+template<>
+struct PropertySize<PolygonBufferPtr> {
+    static size_t size(const PolygonBufferPtr &value)
+    {
+        if(!value) return sizeof(value);
+        return sizeof(value)
+            + sizeof(PolygonBuffer)
+            + value->getOffsets().capacity() * sizeof(uint)
+            + value->getIndices().capacity() * sizeof(uint);
+    }
+};
+
+//a polygon buffer behaves like a list of polygons
+template<>
+struct PropertyListTraits<PolygonBufferPtr> {
+    static Property getItem(const Property &self, int index)
+    {
+        const auto &polygons = self.getDataRef<PolygonBufferPtr>();
+        if(index < 0 || static_cast<size_t>(index) >= polygons->size())
+            return Property();
+
+        return polygons->getPolygon(index);
+    }
+
+    static void setItem(Property &self, int index, Property value);
+    static Property gatherItems(const Property &self, const std::vector<uint32_t> &indices);
+
+    static size_t getSize(const Property &self)
+    {
+        return self.getDataRef<PolygonBufferPtr>()->size();
+    }
+
+    //cnt copies of the polygon def
+    static Property createList(int cnt, Property def)
+    {
+        auto polygon = def.getData<Polygon>();
+        auto polygons = std::make_shared<PolygonBuffer>();
+        polygons->reserve(cnt, cnt * polygon.size());
+        for(int i = 0; i < cnt; ++i)
+            polygons->addPolygon(polygon.begin(), polygon.end());
+        return polygons;
+    }
+    static bool isList() { return true; }
+};
+
+template<>
+struct PyConverter<PolygonBufferPtr> {
+    static BPy::object pywrap(PolygonBufferPtr data)
+    {
+        BPy::list polygons;
+        if(!data) return polygons;
+        for(size_t i = 0; i < data->size(); ++i) {
+            BPy::list polygon;
+            for(auto it = data->polygonBegin(i); it != data->polygonEnd(i); ++it)
+                polygon.append(*it);
+            polygons.append(polygon);
+        }
+        return polygons;
+    }
+};
+
+//object data is hashed by content so results computed from an
+//identical mesh can be reused
+template<typename T>
+struct ObjectDataHash {
+    static bool hash(const std::shared_ptr<T> &value, size_t &seed)
+    {
+        if(!value) {
+            hashCombine(seed, 0);
+            return true;
+        }
+        return PropertyHash<PropertyMap>::hash(value->getProperties(), seed);
+    }
+};
+
+template<>
+struct PropertyHash<ObjectDataPtr> : public ObjectDataHash<ObjectData> {};
+
+template<>
+struct PropertyHash<MeshDataPtr> : public ObjectDataHash<MeshData> {};
+
+template<typename T>
+struct ObjectDataEqual {
+    static bool equal(const std::shared_ptr<T> &lhs, const std::shared_ptr<T> &rhs)
+    {
+        if(lhs == rhs) return true;
+        if(!lhs || !rhs) return false;
+        return PropertyEqual<PropertyMap>::equal(lhs->getProperties(), rhs->getProperties());
+    }
+};
+
+template<>
+struct PropertyEqual<ObjectDataPtr> : public ObjectDataEqual<ObjectData> {};
+
+template<>
+struct PropertyEqual<MeshDataPtr> : public ObjectDataEqual<MeshData> {};
+
+//vertices, polygons and attributes live in the property map
+template<typename T>
+struct ObjectDataSize {
+    static size_t size(const std::shared_ptr<T> &value)
+    {
+        if(!value) return sizeof(value);
+        return sizeof(value) + sizeof(T) + PropertySize<PropertyMap>::size(value->getProperties());
+    }
+};
+
+template<>
+struct PropertySize<ObjectDataPtr> : public ObjectDataSize<ObjectData> {};
+
+template<>
+struct PropertySize<MeshDataPtr> : public ObjectDataSize<MeshData> {};
+}
+
 class PointCloud : public ObjectData
 {
     PointCloud() : ObjectData(POINTCLOUD) {}
@@ -196,6 +529,9 @@ public:
     int getVertexCount() const override;
     int getPolygonCount() const override;
 
+    //bounds of the data in object space, empty for non mesh data
+    AABB getBounds() const;
+
 protected:
     GeoObject(const GeoObject &other);
 
@@ -204,6 +540,47 @@ private:
     MaterialInstancePtr _material;
 };
 
+/*
+ * Many copies of one prototype hierarchy, every instance is placed by its
+ * own transformation relative to the instancer.
+ *
+ * The prototype and the transformations are shared and never modified,
+ * renderers draw all instances of a prototype with a single draw call.
+ * expand creates real copies for code that needs individual objects.
+ */
+class Instancer;
+typedef std::shared_ptr<Instancer> InstancerPtr;
+class Instancer : public AbstractTransformable, public MindTree::PyExposable
+{
+public:
+    typedef std::vector<glm::mat4> TransformationList;
+
+    Instancer(AbstractTransformablePtr prototype,
+              std::shared_ptr<const TransformationList> transformations);
+    virtual ~Instancer();
+
+    AbstractTransformablePtr clone() const override;
+
+    AbstractTransformablePtr getPrototype() const;
+    std::shared_ptr<const TransformationList> getInstanceTransformations() const;
+    size_t getInstanceCount() const;
+
+    //only geometry can be instanced, hierarchies containing lights,
+    //cameras or joints have to be copied
+    static bool canInstance(AbstractTransformablePtr obj);
+    std::vector<AbstractTransformablePtr> expand() const;
+
+    int getVertexCount() const override;
+    int getPolygonCount() const override;
+
+protected:
+    Instancer(const Instancer &other);
+
+private:
+    AbstractTransformablePtr _prototype;
+    std::shared_ptr<const TransformationList> _transformations;
+};
+
 class CreateGroupNode;
 class Camera;
 class GeoObject;
@@ -220,6 +597,7 @@ public:
     void addMembers(std::vector<std::shared_ptr<AbstractTransformable>> list);
     std::vector<std::shared_ptr<Camera>> getCameras() const;
     std::vector<std::shared_ptr<GeoObject>> getGeometry() const;
+    std::vector<std::shared_ptr<Instancer>> getInstancers() const;
     std::vector<std::shared_ptr<Light>> getLights() const;
     void setProperty(std::string name, MindTree::Property prop);
 
@@ -265,6 +643,24 @@ private:
     std::atomic<int> _width, _height;
 };
 
+namespace MindTree {
+//scene objects are counted with their children and geometry
+template<>
+struct PropertySize<AbstractTransformablePtr> {
+    static size_t size(const AbstractTransformablePtr &value);
+};
+
+template<>
+struct PropertySize<GeoObjectPtr> {
+    static size_t size(const GeoObjectPtr &value);
+};
+
+template<>
+struct PropertySize<GroupPtr> {
+    static size_t size(const GroupPtr &value);
+};
+}
+
 namespace std {
     template<>
     struct hash<MeshData::Edge> {
@@ -329,6 +329,8 @@ BOOST_PYTHON_MODULE(object){
 
     NodeDataBase::setNotConvertible("TRANSFORMABLE");
 
+    PolygonBuffer::registerConverters();
+
     ObjectDataPyWrapper::wrap();
     ObjectPyWrapper::wrap();
     GroupPyWrapper::wrap();
@@ -0,0 +1,191 @@
+#include <cmath>
+#include <unordered_map>
+
+#include "data/threadpool.h"
+
+#include "scatter.h"
+
+using namespace MindTree;
+using namespace MindTree::scatter;
+
+namespace
+{
+const size_t GRAIN_SIZE = 4096;
+
+void parallelFor(size_t count, const ThreadPool::RangeTask &task)
+{
+    ThreadPool::instance().parallelFor(count, task, GRAIN_SIZE);
+}
+
+//packs the integer coordinates of a grid cell into one key
+uint64_t cellKey(int64_t x, int64_t y, int64_t z)
+{
+    const uint64_t mask = (1ull << 21) - 1;
+    return (uint64_t(x) & mask)
+        | ((uint64_t(y) & mask) << 21)
+        | ((uint64_t(z) & mask) << 42);
+}
+}
+
+AliasTable::AliasTable(const std::vector<float> &weights)
+    : _probabilities(weights.size(), 0.f),
+    _aliases(weights.size(), 0),
+    _total(0)
+{
+    for(float w : weights)
+        _total += w;
+
+    if(weights.empty() || _total <= 0) return;
+
+    const double scale = weights.size() / _total;
+    std::vector<double> scaled(weights.size());
+    std::vector<uint32_t> small, large;
+    for(uint32_t i = 0; i < weights.size(); ++i) {
+        scaled[i] = weights[i] * scale;
+        _aliases[i] = i;
+        if(scaled[i] < 1.) small.push_back(i);
+        else large.push_back(i);
+    }
+
+    while(!small.empty() && !large.empty()) {
+        uint32_t s = small.back(); small.pop_back();
+        uint32_t l = large.back();
+
+        _probabilities[s] = scaled[s];
+        _aliases[s] = l;
+
+        scaled[l] -= 1. - scaled[s];
+        if(scaled[l] < 1.) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    //whatever is left is only off by rounding errors
+    for(uint32_t i : large) _probabilities[i] = 1.f;
+    for(uint32_t i : small) _probabilities[i] = 1.f;
+}
+
+VertexListPtr MindTree::scatter::scatterSurface(const MeshData &mesh,
+                                                const glm::mat4 &transformation,
+                                                const Options &options)
+{
+    auto points = std::make_shared<VertexList>();
+    auto polygons = mesh.getPolygonBuffer();
+    auto verts = mesh.getProperty("P").getData<VertexListPtr>();
+    if(!polygons || !verts || !options.count) return points;
+
+    //transform the vertices once, the transformation is affine so
+    //interpolating transformed vertices gives the transformed point
+    VertexList world(verts->size());
+    parallelFor(world.size(), [&] (size_t start, size_t end) {
+        for(size_t i = start; i < end; ++i)
+            world[i] = glm::vec3(transformation * glm::vec4((*verts)[i], 1));
+    });
+
+    //fan triangles of every polygon, the first corner is shared
+    std::vector<uint32_t> triangleOffsets(polygons->size() + 1, 0);
+    for(size_t i = 0; i < polygons->size(); ++i) {
+        uint32_t size = polygons->polygonSize(i);
+        triangleOffsets[i + 1] = triangleOffsets[i] + (size > 2 ? size - 2 : 0);
+    }
+
+    const size_t triangleCount = triangleOffsets.back();
+    if(!triangleCount) return points;
+
+    std::vector<uint32_t> corners(triangleCount * 3);
+    std::vector<float> areas(triangleCount);
+    parallelFor(polygons->size(), [&] (size_t start, size_t end) {
+        for(size_t i = start; i < end; ++i) {
+            const uint *poly = polygons->polygonBegin(i);
+            for(uint32_t t = triangleOffsets[i]; t < triangleOffsets[i + 1]; ++t) {
+                uint32_t j = t - triangleOffsets[i] + 1;
+                corners[3 * t] = poly[0];
+                corners[3 * t + 1] = poly[j];
+                corners[3 * t + 2] = poly[j + 1];
+
+                glm::vec3 e1 = world[poly[j]] - world[poly[0]];
+                glm::vec3 e2 = world[poly[j + 1]] - world[poly[0]];
+                areas[t] = glm::length(glm::cross(e1, e2)) * .5f;
+            }
+        }
+    });
+
+    AliasTable table(areas);
+    if(table.getTotalWeight() <= 0) return points;
+
+    points->resize(options.count);
+    parallelFor(options.count, [&] (size_t start, size_t end) {
+        for(size_t i = start; i < end; ++i) {
+            //two draws of 64 bits give the four numbers of the sample
+            uint64_t r1 = randomBits(options.seed, 2 * i);
+            uint64_t r2 = randomBits(options.seed, 2 * i + 1);
+            uint32_t t = table.sample(randomFloat(r1), randomFloat(r1 << 24));
+            float u = randomFloat(r2);
+            float v = randomFloat(r2 << 24);
+            if(u + v > 1.f) {
+                u = 1.f - u;
+                v = 1.f - v;
+            }
+
+            const glm::vec3 &v0 = world[corners[3 * t]];
+            const glm::vec3 &v1 = world[corners[3 * t + 1]];
+            const glm::vec3 &v2 = world[corners[3 * t + 2]];
+            (*points)[i] = v0 + (v1 - v0) * u + (v2 - v0) * v;
+        }
+    });
+
+    if(options.minDistance > 0)
+        return poissonDiskFilter(*points, options.minDistance);
+
+    return points;
+}
+
+VertexListPtr MindTree::scatter::poissonDiskFilter(const VertexList &points, float minDistance)
+{
+    auto kept = std::make_shared<VertexList>();
+    if(minDistance <= 0) {
+        *kept = points;
+        return kept;
+    }
+
+    //cells as large as the distance, so conflicts can only come from
+    //the 27 cells around a point
+    const float invCellSize = 1.f / minDistance;
+    const float minDistance2 = minDistance * minDistance;
+
+    std::vector<int64_t> cells(points.size() * 3);
+    parallelFor(points.size(), [&] (size_t start, size_t end) {
+        for(size_t i = start; i < end; ++i)
+            for(int c = 0; c < 3; ++c)
+                cells[3 * i + c] = int64_t(std::floor(points[i][c] * invCellSize));
+    });
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+    grid.reserve(points.size());
+    for(uint32_t i = 0; i < points.size(); ++i) {
+        const int64_t *cell = &cells[3 * i];
+        bool conflict = false;
+        for(int64_t x = cell[0] - 1; x <= cell[0] + 1 && !conflict; ++x) {
+            for(int64_t y = cell[1] - 1; y <= cell[1] + 1 && !conflict; ++y) {
+                for(int64_t z = cell[2] - 1; z <= cell[2] + 1 && !conflict; ++z) {
+                    auto it = grid.find(cellKey(x, y, z));
+                    if(it == end(grid)) continue;
+                    for(uint32_t j : it->second) {
+                        glm::vec3 d = points[i] - (*kept)[j];
+                        if(glm::dot(d, d) < minDistance2) {
+                            conflict = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if(conflict) continue;
+        grid[cellKey(cell[0], cell[1], cell[2])].push_back(kept->size());
+        kept->push_back(points[i]);
+    }
+
+    return kept;
+}
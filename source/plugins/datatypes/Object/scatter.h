@@ -0,0 +1,80 @@
+#ifndef MT_OBJECT_SCATTER_H
+#define MT_OBJECT_SCATTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "./object.h"
+
+namespace MindTree {
+namespace scatter {
+
+/*
+ * Walker/Vose alias table.
+ *
+ * Draws an index with a probability proportional to its weight in
+ * constant time, one uniform number picks the bucket and a second one
+ * decides between the bucket and its alias.
+ */
+class AliasTable
+{
+public:
+    AliasTable(const std::vector<float> &weights);
+
+    size_t size() const { return _probabilities.size(); }
+    double getTotalWeight() const { return _total; }
+
+    uint32_t sample(float u1, float u2) const
+    {
+        uint32_t bucket = std::min(uint32_t(u1 * _probabilities.size()),
+                                   uint32_t(_probabilities.size() - 1));
+        return u2 < _probabilities[bucket] ? bucket : _aliases[bucket];
+    }
+
+private:
+    std::vector<float> _probabilities;
+    std::vector<uint32_t> _aliases;
+    double _total;
+};
+
+//counter based random numbers, sample i of a seed always gets the same
+//numbers no matter which thread draws it
+inline uint64_t randomBits(uint64_t seed, uint64_t counter)
+{
+    //splitmix64 finalizer
+    uint64_t z = seed * 0x9e3779b97f4a7c15ull + counter;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+//uniform number in [0, 1) from 24 random bits
+inline float randomFloat(uint64_t bits)
+{
+    return (bits >> 40) * (1.f / 16777216.f);
+}
+
+struct Options {
+    uint32_t count = 0;
+    uint32_t seed = 0;
+
+    //if not 0, points closer than minDistance to an earlier point are
+    //dropped, count then only is an upper bound
+    float minDistance = 0;
+};
+
+//area weighted random points on the triangles of the mesh, transformed
+//by transformation
+VertexListPtr scatterSurface(const MeshData &mesh,
+                             const glm::mat4 &transformation,
+                             const Options &options);
+
+//keeps the points that are at least minDistance away from every
+//earlier point that was kept
+VertexListPtr poissonDiskFilter(const VertexList &points, float minDistance);
+
+} // scatter
+} // MindTree
+
+#endif
@@ -27,3 +27,52 @@ Joint::Joint(glm::vec3 pos, glm::vec3 x)
                                 glm::vec4(z, 0),
                                 glm::vec4(pos, 1)));
 }
+
+namespace {
+void hashHierarchy(AbstractTransformable &transformable, glm::mat4 transformation, size_t &seed)
+{
+    hashCombine(seed, transformable.getType());
+    PropertyHash<glm::mat4>::hash(transformation, seed);
+
+    auto children = transformable.getChildren();
+    hashCombine(seed, children.size());
+    for(const auto &child : children)
+        hashHierarchy(*child, child->getTransformation(), seed);
+}
+
+bool equalHierarchy(AbstractTransformable &lhs, glm::mat4 lhsTransformation,
+                    AbstractTransformable &rhs, glm::mat4 rhsTransformation)
+{
+    if(lhs.getType() != rhs.getType() || lhsTransformation != rhsTransformation)
+        return false;
+
+    auto lhsChildren = lhs.getChildren();
+    auto rhsChildren = rhs.getChildren();
+    if(lhsChildren.size() != rhsChildren.size()) return false;
+    for(size_t i = 0; i < lhsChildren.size(); ++i)
+        if(!equalHierarchy(*lhsChildren[i], lhsChildren[i]->getTransformation(),
+                           *rhsChildren[i], rhsChildren[i]->getTransformation()))
+            return false;
+    return true;
+}
+}
+
+namespace MindTree {
+bool PropertyHash<JointPtr>::hash(const JointPtr &value, size_t &seed)
+{
+    if(!value) {
+        hashCombine(seed, 0);
+        return true;
+    }
+    hashHierarchy(*value, value->getWorldTransformation(), seed);
+    return true;
+}
+
+bool PropertyEqual<JointPtr>::equal(const JointPtr &lhs, const JointPtr &rhs)
+{
+    if(lhs == rhs) return true;
+    if(!lhs || !rhs) return false;
+    return equalHierarchy(*lhs, lhs->getWorldTransformation(),
+                          *rhs, rhs->getWorldTransformation());
+}
+}
@@ -23,6 +23,18 @@ private:
 
  typedef std::shared_ptr<Joint> JointPtr;
 
+//skeletons are hashed by their hierarchy, the root with its world
+//transformation, everything below it relative to its parent
+template<>
+struct PropertyHash<JointPtr> {
+    static bool hash(const JointPtr &value, size_t &seed);
+};
+
+template<>
+struct PropertyEqual<JointPtr> {
+    static bool equal(const JointPtr &lhs, const JointPtr &rhs);
+};
+
 }
 
 #endif
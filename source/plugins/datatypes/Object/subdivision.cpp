@@ -0,0 +1,529 @@
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+#include "data/threadpool.h"
+
+#include "subdivision.h"
+
+using namespace MindTree;
+using namespace MindTree::subdivision;
+
+namespace
+{
+const size_t GRAIN_SIZE = 4096;
+
+void parallelFor(size_t count, const ThreadPool::RangeTask &task)
+{
+    ThreadPool::instance().parallelFor(count, task, GRAIN_SIZE);
+}
+
+//turns counts into offsets, offsets.back() holds the total
+void prefixSum(std::vector<uint32_t> &offsets)
+{
+    uint32_t sum = 0;
+    for(auto &offset : offsets) {
+        uint32_t count = offset;
+        offset = sum;
+        sum += count;
+    }
+}
+}
+
+MeshTopology::MeshTopology(size_t vertexCount, const PolygonBuffer &polygons)
+    : _vertexCount(vertexCount),
+    _faceCorners(polygons.getOffsets()),
+    _cornerVertices(polygons.getIndices())
+{
+    //the corners are the polygon buffer's indices
+    const size_t faceCount = polygons.size();
+    const size_t cornerCount = _cornerVertices.size();
+    _nextCorners.resize(cornerCount);
+    _cornerFaces.resize(cornerCount);
+    _cornerEdges.resize(cornerCount);
+
+    parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            uint32_t first = _faceCorners[f];
+            uint32_t size = faceSize(f);
+            for(uint32_t j = 0; j < size; ++j) {
+                _cornerFaces[first + j] = f;
+                _nextCorners[first + j] = first + (j + 1) % size;
+            }
+        }
+    });
+
+    //bucket the corners by the lower vertex of their edge
+    auto lowerVertex = [this] (uint32_t c) {
+        return std::min(_cornerVertices[c], _cornerVertices[_nextCorners[c]]);
+    };
+    auto upperVertex = [this] (uint32_t c) {
+        return std::max(_cornerVertices[c], _cornerVertices[_nextCorners[c]]);
+    };
+
+    std::vector<uint32_t> buckets(vertexCount + 1, 0);
+    for(uint32_t c = 0; c < cornerCount; ++c)
+        ++buckets[lowerVertex(c)];
+    prefixSum(buckets);
+
+    _edgeCornerList.resize(cornerCount);
+    {
+        std::vector<uint32_t> cursor(begin(buckets), end(buckets) - 1);
+        for(uint32_t c = 0; c < cornerCount; ++c)
+            _edgeCornerList[cursor[lowerVertex(c)]++] = c;
+    }
+
+    //corners of the same edge end up next to each other in their bucket
+    std::vector<uint32_t> edgeCounts(vertexCount + 1, 0);
+    parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        for(size_t v = start; v < end; ++v) {
+            auto first = begin(_edgeCornerList) + buckets[v];
+            auto last = begin(_edgeCornerList) + buckets[v + 1];
+            std::sort(first, last, [&] (uint32_t lhs, uint32_t rhs) {
+                return upperVertex(lhs) < upperVertex(rhs);
+            });
+
+            uint32_t count = 0;
+            for(auto it = first; it != last; ++it)
+                if(it == first || upperVertex(*it) != upperVertex(*(it - 1)))
+                    ++count;
+            edgeCounts[v] = count;
+        }
+    });
+    prefixSum(edgeCounts);
+
+    const size_t edgeCount = edgeCounts.back();
+    _edgeVertices.resize(2 * edgeCount);
+    _edgeCorners.resize(edgeCount + 1);
+    _edgeCorners[edgeCount] = cornerCount;
+
+    parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        for(size_t v = start; v < end; ++v) {
+            uint32_t edge = edgeCounts[v];
+            for(uint32_t i = buckets[v]; i < buckets[v + 1]; ++i) {
+                uint32_t c = _edgeCornerList[i];
+                bool first = i == buckets[v];
+                if(!first && upperVertex(c) != upperVertex(_edgeCornerList[i - 1])) {
+                    ++edge;
+                    first = true;
+                }
+
+                if(first) {
+                    _edgeVertices[2 * edge] = v;
+                    _edgeVertices[2 * edge + 1] = upperVertex(c);
+                    _edgeCorners[edge] = i;
+                }
+                _cornerEdges[c] = edge;
+            }
+        }
+    });
+
+    _vertexCorners.resize(vertexCount + 1, 0);
+    for(uint32_t c = 0; c < cornerCount; ++c)
+        ++_vertexCorners[_cornerVertices[c]];
+    prefixSum(_vertexCorners);
+
+    _vertexCornerList.resize(cornerCount);
+    {
+        std::vector<uint32_t> cursor(begin(_vertexCorners), end(_vertexCorners) - 1);
+        for(uint32_t c = 0; c < cornerCount; ++c)
+            _vertexCornerList[cursor[_cornerVertices[c]]++] = c;
+    }
+
+    _vertexEdges.resize(vertexCount + 1, 0);
+    for(size_t e = 0; e < edgeCount; ++e) {
+        ++_vertexEdges[_edgeVertices[2 * e]];
+        ++_vertexEdges[_edgeVertices[2 * e + 1]];
+    }
+    prefixSum(_vertexEdges);
+
+    _vertexEdgeList.resize(2 * edgeCount);
+    {
+        std::vector<uint32_t> cursor(begin(_vertexEdges), end(_vertexEdges) - 1);
+        for(uint32_t e = 0; e < edgeCount; ++e) {
+            _vertexEdgeList[cursor[_edgeVertices[2 * e]]++] = e;
+            _vertexEdgeList[cursor[_edgeVertices[2 * e + 1]]++] = e;
+        }
+    }
+}
+
+namespace
+{
+Level refine(const MeshTopology &topology,
+             const VertexList &points,
+             const std::vector<char> *selection)
+{
+    const size_t vertexCount = topology.getVertexCount();
+    const size_t faceCount = topology.getFaceCount();
+    const size_t edgeCount = topology.getEdgeCount();
+    auto selected = [selection] (size_t face) {
+        return !selection || (*selection)[face];
+    };
+
+    //indices of the new points and polygons
+    std::vector<uint32_t> facePoints(faceCount + 1, 0);
+    std::vector<uint32_t> children(faceCount + 1, 0);
+    for(size_t f = 0; f < faceCount; ++f) {
+        facePoints[f] = selected(f);
+        children[f] = selected(f) ? topology.faceSize(f) : 1;
+    }
+    prefixSum(facePoints);
+    prefixSum(children);
+
+    std::vector<uint32_t> edgePoints(edgeCount + 1, 0);
+    for(size_t e = 0; e < edgeCount; ++e)
+        for(auto c = topology.edgeCornersBegin(e); c != topology.edgeCornersEnd(e); ++c)
+            if(selected(topology.cornerFace(*c)))
+                edgePoints[e] = 1;
+    prefixSum(edgePoints);
+
+    auto edgeSelected = [&edgePoints] (uint32_t e) {
+        return edgePoints[e] != edgePoints[e + 1];
+    };
+
+    const uint32_t facePointOffset = vertexCount;
+    const uint32_t edgePointOffset = vertexCount + facePoints.back();
+
+    //refined faces become quads, the others gain the points of their
+    //refined edges
+    std::vector<uint32_t> childOffsets(children.back() + 1, 0);
+    parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            uint32_t child = children[f];
+            if(selected(f)) {
+                for(uint32_t i = 0; i < topology.faceSize(f); ++i)
+                    childOffsets[child + i] = 4;
+                continue;
+            }
+
+            uint32_t size = topology.faceSize(f);
+            for(uint32_t c = topology.faceCorners(f); c < topology.faceCorners(f + 1); ++c)
+                size += edgeSelected(topology.cornerEdge(c));
+            childOffsets[child] = size;
+        }
+    });
+    prefixSum(childOffsets);
+
+    Level level;
+    level.points = std::make_shared<VertexList>(edgePointOffset + edgePoints.back());
+    level.parentFaces.resize(children.back());
+
+    auto &refined = *level.points;
+
+    std::vector<glm::vec3> centroids(faceCount);
+    parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            glm::vec3 fp(0);
+            for(uint32_t c = topology.faceCorners(f); c < topology.faceCorners(f + 1); ++c)
+                fp += points[topology.cornerVertex(c)];
+            centroids[f] = fp / float(topology.faceSize(f));
+            if(selected(f))
+                refined[facePointOffset + facePoints[f]] = centroids[f];
+        }
+    });
+
+    //edge points
+    parallelFor(edgeCount, [&] (size_t start, size_t end) {
+        for(size_t e = start; e < end; ++e) {
+            if(!edgeSelected(e)) continue;
+
+            glm::vec3 ep = points[topology.edgeVertex(e, 0)] + points[topology.edgeVertex(e, 1)];
+            for(auto c = topology.edgeCornersBegin(e); c != topology.edgeCornersEnd(e); ++c)
+                ep += centroids[topology.cornerFace(*c)];
+            refined[edgePointOffset + edgePoints[e]] = ep / 4.f;
+        }
+    });
+
+    //move the old vertices that belong to a refined face
+    parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        for(size_t v = start; v < end; ++v) {
+            const glm::vec3 &P = points[v];
+            refined[v] = P;
+
+            uint32_t n = topology.vertexCornerCount(v);
+            uint32_t edges = topology.vertexEdgeCount(v);
+            if(!n || !edges) continue;
+
+            bool move = false;
+            glm::vec3 F(0);
+            for(auto c = topology.vertexCornersBegin(v); c != topology.vertexCornersEnd(v); ++c) {
+                F += centroids[topology.cornerFace(*c)];
+                move = move || selected(topology.cornerFace(*c));
+            }
+            if(!move) continue;
+            F /= float(n);
+
+            glm::vec3 R(0);
+            for(auto e = topology.vertexEdgesBegin(v); e != topology.vertexEdgesEnd(v); ++e)
+                R += (points[topology.edgeVertex(*e, 0)] + points[topology.edgeVertex(*e, 1)]) * 0.5f;
+            R /= float(edges);
+
+            refined[v] = (F + 2.f * R + (n - 3.f) * P) / float(n);
+        }
+    });
+
+    //one quad per corner of refined faces, the other faces pick up the
+    //points of their refined edges
+    std::vector<uint> indices(childOffsets.back());
+    parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            uint32_t child = children[f];
+            if(!selected(f)) {
+                uint *poly = indices.data() + childOffsets[child];
+                for(uint32_t c = topology.faceCorners(f); c < topology.faceCorners(f + 1); ++c) {
+                    *poly++ = topology.cornerVertex(c);
+                    if(edgeSelected(topology.cornerEdge(c)))
+                        *poly++ = edgePointOffset + edgePoints[topology.cornerEdge(c)];
+                }
+                level.parentFaces[child] = f;
+                continue;
+            }
+
+            for(uint32_t c = topology.faceCorners(f); c < topology.faceCorners(f + 1); ++c, ++child) {
+                uint32_t next = topology.nextCorner(c);
+                uint *poly = indices.data() + childOffsets[child];
+                poly[0] = facePointOffset + facePoints[f];
+                poly[1] = edgePointOffset + edgePoints[topology.cornerEdge(c)];
+                poly[2] = topology.cornerVertex(next);
+                poly[3] = edgePointOffset + edgePoints[topology.cornerEdge(next)];
+                level.parentFaces[child] = f;
+            }
+        }
+    });
+    level.polygons = std::make_shared<PolygonBuffer>(std::move(indices), std::move(childOffsets));
+
+    return level;
+}
+
+glm::vec3 faceNormal(const MeshTopology &topology, size_t face, const VertexList &points)
+{
+    //Newell's method, works for non planar polygons
+    glm::vec3 normal(0);
+    for(uint32_t c = topology.faceCorners(face); c < topology.faceCorners(face + 1); ++c) {
+        const glm::vec3 &cur = points[topology.cornerVertex(c)];
+        const glm::vec3 &next = points[topology.cornerVertex(topology.nextCorner(c))];
+        normal.x += (cur.y - next.y) * (cur.z + next.z);
+        normal.y += (cur.z - next.z) * (cur.x + next.x);
+        normal.z += (cur.x - next.x) * (cur.y + next.y);
+    }
+    float length = glm::length(normal);
+    return length > 0 ? normal / length : normal;
+}
+}
+
+Level MindTree::subdivision::catmullClark(const VertexList &points,
+                                          const PolygonBuffer &polygons,
+                                          const std::vector<char> *selection)
+{
+    MeshTopology topology(points.size(), polygons);
+    return refine(topology, points, selection);
+}
+
+std::vector<char> MindTree::subdivision::selectIrregularFaces(const MeshTopology &topology,
+                                                              const VertexList &points,
+                                                              float tolerance)
+{
+    const size_t vertexCount = topology.getVertexCount();
+    const size_t faceCount = topology.getFaceCount();
+
+    //interior vertices need 4 edges, boundary vertices 3
+    std::vector<char> regular(vertexCount);
+    parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        for(size_t v = start; v < end; ++v) {
+            uint32_t boundary = 0;
+            bool manifold = true;
+            for(auto e = topology.vertexEdgesBegin(v); e != topology.vertexEdgesEnd(v); ++e) {
+                boundary += topology.isBoundaryEdge(*e);
+                manifold = manifold && topology.edgeCornerCount(*e) <= 2;
+            }
+            uint32_t valence = topology.vertexEdgeCount(v);
+            regular[v] = manifold && ((!boundary && valence == 4)
+                                      || (boundary == 2 && valence == 3));
+        }
+    });
+
+    std::vector<glm::vec3> normals;
+    const float minCos = std::cos(glm::radians(tolerance));
+    if(tolerance > 0) {
+        normals.resize(faceCount);
+        parallelFor(faceCount, [&] (size_t start, size_t end) {
+            for(size_t f = start; f < end; ++f)
+                normals[f] = faceNormal(topology, f, points);
+        });
+    }
+
+    std::vector<char> selection(faceCount, 0);
+    parallelFor(faceCount, [&] (size_t start, size_t end) {
+        for(size_t f = start; f < end; ++f) {
+            bool irregular = topology.faceSize(f) != 4;
+            for(uint32_t c = topology.faceCorners(f); c < topology.faceCorners(f + 1) && !irregular; ++c) {
+                uint32_t twin = topology.twinCorner(c);
+                irregular = !regular[topology.cornerVertex(c)]
+                    || twin == MeshTopology::INVALID
+                    || (tolerance > 0
+                        && glm::dot(normals[f], normals[topology.cornerFace(twin)]) < minCos);
+            }
+            selection[f] = irregular;
+        }
+    });
+
+    return selection;
+}
+
+void MindTree::subdivision::evaluateLimit(const VertexList &points,
+                                          const PolygonBuffer &polygons,
+                                          VertexList &limitPoints,
+                                          VertexList &normals)
+{
+    MeshTopology topology(points.size(), polygons);
+    const size_t vertexCount = topology.getVertexCount();
+    limitPoints.resize(vertexCount);
+    normals.resize(vertexCount);
+
+    parallelFor(vertexCount, [&] (size_t start, size_t end) {
+        std::vector<uint32_t> edgeRing, faceRing;
+        for(size_t v = start; v < end; ++v) {
+            const glm::vec3 &P = points[v];
+            limitPoints[v] = P;
+
+            //boundary vertices move along the boundary curve
+            uint32_t boundary = 0;
+            glm::vec3 boundarySum(0);
+            for(auto e = topology.vertexEdgesBegin(v); e != topology.vertexEdgesEnd(v); ++e) {
+                if(!topology.isBoundaryEdge(*e)) continue;
+                ++boundary;
+                uint32_t other = topology.edgeVertex(*e, 0) == v
+                    ? topology.edgeVertex(*e, 1)
+                    : topology.edgeVertex(*e, 0);
+                boundarySum += points[other];
+            }
+            if(boundary) {
+                if(boundary == 2)
+                    limitPoints[v] = (boundarySum + 4.f * P) / 6.f;
+                continue;
+            }
+
+            //collect the one ring, e_i along the edges, f_i diagonal in
+            //the quads between e_i and e_i+1
+            uint32_t n = topology.vertexCornerCount(v);
+            if(n < 3) continue;
+
+            edgeRing.clear();
+            faceRing.clear();
+            uint32_t first = *topology.vertexCornersBegin(v);
+            uint32_t c = first;
+            bool closed = false;
+            for(uint32_t i = 0; i < n; ++i) {
+                if(topology.faceSize(topology.cornerFace(c)) != 4) break;
+                uint32_t next = topology.nextCorner(c);
+                edgeRing.push_back(topology.cornerVertex(next));
+                faceRing.push_back(topology.cornerVertex(topology.nextCorner(next)));
+
+                uint32_t twin = topology.twinCorner(topology.prevCorner(c));
+                if(twin == MeshTopology::INVALID || topology.cornerVertex(twin) != v)
+                    break;
+                c = twin;
+                closed = c == first && i == n - 1;
+            }
+            if(!closed) continue;
+
+            glm::vec3 edgeSum(0), faceSum(0), t1(0), t2(0);
+            const float pi = glm::pi<float>();
+            const float An = 1.f + std::cos(2.f * pi / n)
+                + std::cos(pi / n) * std::sqrt(2.f * (9.f + std::cos(2.f * pi / n)));
+            for(uint32_t i = 0; i < n; ++i) {
+                const glm::vec3 &e = points[edgeRing[i]];
+                const glm::vec3 &f = points[faceRing[i]];
+                edgeSum += e;
+                faceSum += f;
+
+                float a0 = 2.f * pi * i / n;
+                float a1 = 2.f * pi * (i + 1) / n;
+                t1 += An * std::cos(a0) * e + (std::cos(a0) + std::cos(a1)) * f;
+                t2 += An * std::sin(a0) * e + (std::sin(a0) + std::sin(a1)) * f;
+            }
+
+            limitPoints[v] = (float(n * n) * P + 4.f * edgeSum + faceSum) / float(n * (n + 5));
+
+            glm::vec3 normal = glm::cross(t1, t2);
+            float length = glm::length(normal);
+            if(length <= 0) continue;
+            normal /= length;
+            normals[v] = glm::dot(normal, normals[v]) < 0 ? -normal : normal;
+        }
+    });
+}
+
+MeshDataPtr MindTree::subdivision::subdivide(MeshDataPtr base, const Options &options)
+{
+    auto mesh = std::make_shared<MeshData>();
+    auto polys = base->getPolygonBuffer();
+    auto verts = base->getProperty("P").getData<VertexListPtr>();
+    if(!polys) polys = std::make_shared<PolygonBuffer>();
+    if(!verts) verts = std::make_shared<VertexList>();
+
+    PropertyMap poly_properties;
+    for(const auto &prop : base->getProperties()) {
+        if(prop.second.isList() && prop.second.size() == polys->size()
+           && prop.first != "polygon") {
+            poly_properties[prop.first] = prop.second;
+        }
+    }
+
+    //base polygon of every refined polygon
+    std::vector<uint32_t> origins(polys->size());
+    for(size_t i = 0; i < origins.size(); ++i)
+        origins[i] = i;
+
+    bool refined = false;
+    for(int i = 0; i < options.iterations; ++i) {
+        MeshTopology topology(verts->size(), *polys);
+
+        std::vector<char> selection;
+        if(options.adaptive) {
+            selection = selectIrregularFaces(topology, *verts, options.tolerance);
+            if(std::find(begin(selection), end(selection), 1) == end(selection))
+                break;
+        }
+
+        Level level = refine(topology,
+                             *verts,
+                             options.adaptive ? &selection : nullptr);
+
+        std::vector<uint32_t> refinedOrigins(level.parentFaces.size());
+        parallelFor(refinedOrigins.size(), [&] (size_t start, size_t end) {
+            for(size_t j = start; j < end; ++j)
+                refinedOrigins[j] = origins[level.parentFaces[j]];
+        });
+
+        origins = std::move(refinedOrigins);
+        verts = level.points;
+        polys = level.polygons;
+        refined = true;
+    }
+
+    mesh->setProperty("P", verts);
+    mesh->setProperty("polygon", polys);
+
+    for(const auto &p : poly_properties) {
+        if(refined)
+            mesh->setProperty(p.first, Property::gatherItems(p.second, origins));
+        else
+            mesh->setProperty(p.first, p.second);
+    }
+
+    mesh->computeVertexNormals();
+
+    //empty meshes get no normals to start from
+    auto vertexNormals = mesh->getProperty("N").getData<VertexListPtr>();
+    if(options.limitSurface && vertexNormals) {
+        auto limitPoints = std::make_shared<VertexList>();
+        auto normals = std::make_shared<VertexList>(*vertexNormals);
+        evaluateLimit(*verts, *polys, *limitPoints, *normals);
+        mesh->setProperty("P", limitPoints);
+        mesh->setProperty("N", normals);
+    }
+
+    return mesh;
+}
@@ -0,0 +1,142 @@
+#ifndef MT_OBJECT_SUBDIVISION_H
+#define MT_OBJECT_SUBDIVISION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "./object.h"
+
+namespace MindTree {
+namespace subdivision {
+
+/*
+ * Compressed adjacency of a polygon mesh.
+ *
+ * Every polygon corner is a half edge running from its vertex to the next
+ * vertex of the polygon, corners of polygon f are numbered
+ * faceCorners(f) ... faceCorners(f + 1) - 1.
+ * Edges are numbered by their lower vertex, the corners of every edge are
+ * stored contiguously so edges, faces and vertices can be processed
+ * independently of each other.
+ */
+class MeshTopology
+{
+public:
+    MeshTopology(size_t vertexCount, const PolygonBuffer &polygons);
+
+    size_t getVertexCount() const { return _vertexCount; }
+    size_t getFaceCount() const { return _faceCorners.size() - 1; }
+    size_t getEdgeCount() const { return _edgeVertices.size() / 2; }
+    size_t getCornerCount() const { return _cornerVertices.size(); }
+
+    uint32_t faceCorners(size_t face) const { return _faceCorners[face]; }
+    uint32_t faceSize(size_t face) const { return _faceCorners[face + 1] - _faceCorners[face]; }
+    uint32_t nextCorner(uint32_t corner) const { return _nextCorners[corner]; }
+    uint32_t prevCorner(uint32_t corner) const
+    {
+        uint32_t first = _faceCorners[_cornerFaces[corner]];
+        uint32_t size = faceSize(_cornerFaces[corner]);
+        return first + (corner - first + size - 1) % size;
+    }
+
+    uint32_t cornerVertex(uint32_t corner) const { return _cornerVertices[corner]; }
+    uint32_t cornerFace(uint32_t corner) const { return _cornerFaces[corner]; }
+    uint32_t cornerEdge(uint32_t corner) const { return _cornerEdges[corner]; }
+
+    uint32_t edgeVertex(size_t edge, int i) const { return _edgeVertices[2 * edge + i]; }
+    uint32_t edgeCornerCount(size_t edge) const { return _edgeCorners[edge + 1] - _edgeCorners[edge]; }
+    const uint32_t* edgeCornersBegin(size_t edge) const { return _edgeCornerList.data() + _edgeCorners[edge]; }
+    const uint32_t* edgeCornersEnd(size_t edge) const { return _edgeCornerList.data() + _edgeCorners[edge + 1]; }
+
+    //corners starting at the vertex
+    uint32_t vertexCornerCount(size_t vertex) const { return _vertexCorners[vertex + 1] - _vertexCorners[vertex]; }
+    const uint32_t* vertexCornersBegin(size_t vertex) const { return _vertexCornerList.data() + _vertexCorners[vertex]; }
+    const uint32_t* vertexCornersEnd(size_t vertex) const { return _vertexCornerList.data() + _vertexCorners[vertex + 1]; }
+
+    uint32_t vertexEdgeCount(size_t vertex) const { return _vertexEdges[vertex + 1] - _vertexEdges[vertex]; }
+    const uint32_t* vertexEdgesBegin(size_t vertex) const { return _vertexEdgeList.data() + _vertexEdges[vertex]; }
+    const uint32_t* vertexEdgesEnd(size_t vertex) const { return _vertexEdgeList.data() + _vertexEdges[vertex + 1]; }
+
+    bool isBoundaryEdge(size_t edge) const { return edgeCornerCount(edge) == 1; }
+
+    //the corner on the other side of the edge, INVALID on boundaries
+    //and non manifold edges
+    uint32_t twinCorner(uint32_t corner) const
+    {
+        uint32_t edge = _cornerEdges[corner];
+        if(edgeCornerCount(edge) != 2) return INVALID;
+        const uint32_t *corners = edgeCornersBegin(edge);
+        return corners[0] == corner ? corners[1] : corners[0];
+    }
+
+    static const uint32_t INVALID = uint32_t(-1);
+
+private:
+    size_t _vertexCount;
+
+    std::vector<uint32_t> _faceCorners;
+    std::vector<uint32_t> _nextCorners;
+    std::vector<uint32_t> _cornerVertices;
+    std::vector<uint32_t> _cornerFaces;
+    std::vector<uint32_t> _cornerEdges;
+
+    std::vector<uint32_t> _edgeVertices;
+    std::vector<uint32_t> _edgeCorners;
+    std::vector<uint32_t> _edgeCornerList;
+
+    std::vector<uint32_t> _vertexCorners;
+    std::vector<uint32_t> _vertexCornerList;
+    std::vector<uint32_t> _vertexEdges;
+    std::vector<uint32_t> _vertexEdgeList;
+};
+
+struct Level {
+    VertexListPtr points;
+    PolygonBufferPtr polygons;
+
+    //polygon of the coarser level every polygon was created from
+    std::vector<uint32_t> parentFaces;
+};
+
+struct Options {
+    int iterations = 1;
+
+    //only refine faces around extraordinary vertices, boundaries and
+    //non quads, and faces bending more than tolerance degrees against
+    //a neighbour if tolerance is not 0
+    bool adaptive = false;
+    float tolerance = 0;
+
+    //move the final vertices onto the limit surface and use its normals
+    bool limitSurface = false;
+};
+
+//one level of Catmull-Clark refinement.
+//the refined points are the old vertices, followed by one point per
+//refined face and one point per edge of a refined face.
+//without a selection every face is refined, faces that are not selected
+//are kept but take on the points of their refined edges so the mesh
+//stays closed
+Level catmullClark(const VertexList &points,
+                   const PolygonBuffer &polygons,
+                   const std::vector<char> *selection=nullptr);
+
+std::vector<char> selectIrregularFaces(const MeshTopology &topology,
+                                       const VertexList &points,
+                                       float tolerance=0);
+
+//evaluates limit positions and normals where the one ring around a
+//vertex only consists of quads, other vertices keep their position and
+//normal
+void evaluateLimit(const VertexList &points,
+                   const PolygonBuffer &polygons,
+                   VertexList &limitPoints,
+                   VertexList &normals);
+
+//per polygon attributes are carried over
+MeshDataPtr subdivide(MeshDataPtr base, const Options &options);
+
+} // subdivision
+} // MindTree
+
+#endif
@@ -34,6 +34,13 @@ class NotNodeDecorator(MT.pytypes.NodeDecorator):
     insockets = [("Input", "BOOLEAN")]
     outsockets = [("Output", "BOOLEAN")]
 
+class LessThanNodeDecorator(MT.pytypes.NodeDecorator):
+    label = "Condition.Less Than"
+    type = "LESSTHAN"
+    insockets = [("Value", "FLOAT"),
+            ("Threshold", "FLOAT")]
+    outsockets = [("Output", "BOOLEAN")]
+
 MT.addCompatibility("FLOAT", "INTEGER")
 
 MT.registerNode(SinNodeDecorator)
@@ -41,3 +48,4 @@ MT.registerNode(IfNodeDecorator)
 MT.registerNode(AndNodeDecorator)
 MT.registerNode(OrNodeDecorator)
 MT.registerNode(NotNodeDecorator)
+MT.registerNode(LessThanNodeDecorator)
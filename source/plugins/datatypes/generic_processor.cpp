@@ -71,5 +71,14 @@ BOOST_PYTHON_MODULE(generic_processor)
 
     DataCache::addProcessor(new CacheProcessor("FLOAT", "SIN", sinfunc));
 
+    auto lessthan = [] (DataCache *cache) {
+        auto value = cache->getData(0).getData<double>();
+        auto threshold = cache->getData(1).getData<double>();
+
+        cache->pushData(value < threshold);
+    };
+
+    DataCache::addProcessor(new CacheProcessor("BOOLEAN", "LESSTHAN", lessthan));
+
     registerConverteNodeOperators();
 }
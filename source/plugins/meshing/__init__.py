@@ -4,7 +4,10 @@ class SubdNodeDecorator(MT.pytypes.NodeDecorator):
     type="SUBDIVISIONSURFACE"
     label="Objects.Data.Subdivision"
     insockets = [ ("Mesh", "OBJECTDATA"),
-                  ("Iterations", "INTEGER", 1)]
+                  ("Iterations", "INTEGER", 1),
+                  ("Adaptive", "BOOLEAN", False),
+                  ("Tolerance", "FLOAT", 0.),
+                  ("Limit Surface", "BOOLEAN", False)]
 
     outsockets = [("Subd", "OBJECTDATA")]
 
@@ -51,17 +51,19 @@ void ObjImporter::readData(QTextStream &stream)
     while(!stream.atEnd()) {
         QString line = stream.readLine();
         if(line.startsWith("o ")) {
+            finishObject(obj);
             obj = addObject(line);
         }
         else if(line.startsWith("v "))
-                addVertex(line, obj);
+                addVertex(line);
         else if(line.startsWith("vn "))
-                addNormal(line, obj);
+                addNormal(line);
         else if(line.startsWith("f "))
-                addFace(line, obj);
+                addFace(line);
         else if(line.startsWith("st "))
-            addUV(line, obj);
+            addUV(line);
     }
+    finishObject(obj);
 
     std::cout <<  " done" << std::endl;
     auto mesh = std::static_pointer_cast<MeshData>(obj->getData());
@@ -82,14 +84,27 @@ std::shared_ptr<GeoObject> ObjImporter::addObject(QString line)
     QStringList l = line.split(" ");
     l.takeFirst();
     obj->setName(l[0].toStdString());
-    auto mesh = std::make_shared<MeshData>();
-    mesh->setProperty("P", std::make_shared<VertexList>());
-    mesh->setProperty("polygon", std::make_shared<PolygonList>());
-    obj->setData(mesh);
+    obj->setData(std::make_shared<MeshData>());
+
+    points = std::make_shared<VertexList>();
+    normals.reset();
+    polygons = std::make_shared<PolygonBuffer>();
     return obj;
 }
 
-void ObjImporter::addVertex(QString line, std::shared_ptr<GeoObject> obj)
+//writing the attributes in place would keep the mesh's cached bounds,
+//they are set once the object is complete instead
+void ObjImporter::finishObject(std::shared_ptr<GeoObject> obj)
+{
+    if(!obj) return;
+
+    auto mesh = std::static_pointer_cast<MeshData>(obj->getData());
+    mesh->setProperty("P", points);
+    mesh->setProperty("polygon", polygons);
+    if(normals) mesh->setProperty("N", normals);
+}
+
+void ObjImporter::addVertex(QString line)
 {
     QStringList l = line.split(" ");
     double d[3];
@@ -99,13 +114,10 @@ void ObjImporter::addVertex(QString line, std::shared_ptr<GeoObject> obj)
         d[i] = vstr.toDouble();
         ++i;
     }
-    std::static_pointer_cast<MeshData>(obj->getData())
-        ->getProperty("P")
-        .getData<std::shared_ptr<VertexList>>()
-        ->push_back(glm::vec3(d[0], d[1], d[2]));
+    points->push_back(glm::vec3(d[0], d[1], d[2]));
 }
 
-void ObjImporter::addNormal(QString line, std::shared_ptr<GeoObject> obj)
+void ObjImporter::addNormal(QString line)
 {
     QStringList l = line.split(" ");
     double d[3];
@@ -115,31 +127,26 @@ void ObjImporter::addNormal(QString line, std::shared_ptr<GeoObject> obj)
         d[i] = vstr.toDouble();
         ++i;
     }
-    auto mesh = std::static_pointer_cast<MeshData>(obj->getData());
-    if(!mesh->hasProperty("N"))
-        mesh->setProperty("N", std::make_shared<VertexList>());
+    if(!normals)
+        normals = std::make_shared<VertexList>();
 
-    mesh->getProperty("N")
-        .getData<std::shared_ptr<VertexList>>()
-        ->push_back(glm::vec3(d[0], d[1], d[2]));
+    normals->push_back(glm::vec3(d[0], d[1], d[2]));
 }
 
-void ObjImporter::addFace(QString line, std::shared_ptr<GeoObject> obj)    
+void ObjImporter::addFace(QString line)    
 {
     QStringList l = line.split(" ");
-    Polygon p;
     l.takeFirst();
+    std::vector<uint> p;
+    p.reserve(l.size());
     for(QString vstr : l){
         QStringList tmp = vstr.split("/");
         p.push_back(tmp.at(0).toInt() - 1);
     }
-    std::static_pointer_cast<MeshData>(obj->getData())
-        ->getProperty("polygon")
-        .getData<std::shared_ptr<PolygonList>>()
-        ->push_back(p);
+    polygons->addPolygon(begin(p), end(p));
 }
 
-void ObjImporter::addUV(QString line, std::shared_ptr<GeoObject> obj)    
+void ObjImporter::addUV(QString line)    
 {
 }
 
@@ -38,13 +38,19 @@ public:
 private:
     void readData(QTextStream &stream);
     std::shared_ptr<GeoObject> addObject(QString line);
-    void addVertex(QString line, std::shared_ptr<GeoObject> obj);
-    void addNormal(QString line, std::shared_ptr<GeoObject> obj);
-    void addFace(QString line, std::shared_ptr<GeoObject> obj);
-    void addUV(QString line, std::shared_ptr<GeoObject> obj);
+    void finishObject(std::shared_ptr<GeoObject> obj);
+    void addVertex(QString line);
+    void addNormal(QString line);
+    void addFace(QString line);
+    void addUV(QString line);
 
     std::shared_ptr<Group> grp;
     QString name;
+
+    //the current object's attributes, only set on its mesh once complete
+    std::shared_ptr<VertexList> points;
+    std::shared_ptr<VertexList> normals;
+    PolygonBufferPtr polygons;
 };
 
 class ObjImportNode : public MindTree::DNode
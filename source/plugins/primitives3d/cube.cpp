@@ -20,18 +20,17 @@ std::shared_ptr<ObjectData> prim3d::createCubeMesh(float scale)
                      vec3(-scale, scale, scale)
     });
 
-    auto polygons = std::make_shared<PolygonList>();
+    auto polygons = std::make_shared<PolygonBuffer>();
+    polygons->reserve(6, 24);
 
-    polygons->insert(polygons->begin(), {
-                     Polygon{3, 2, 1, 0}, //front
-                     Polygon{4, 5, 6, 7}, //back
+    polygons->addPolygon({3, 2, 1, 0}); //front
+    polygons->addPolygon({4, 5, 6, 7}); //back
 
-                     Polygon{0, 1, 5, 4}, //bottom
-                     Polygon{2, 3, 7, 6}, //top
+    polygons->addPolygon({0, 1, 5, 4}); //bottom
+    polygons->addPolygon({2, 3, 7, 6}); //top
 
-                     Polygon{3, 0, 4, 7}, //right
-                     Polygon{1, 2, 6, 5} //left
-    });
+    polygons->addPolygon({3, 0, 4, 7}); //right
+    polygons->addPolygon({1, 2, 6, 5}); //left
 
     mesh->setProperty("P", vertices);
     mesh->setProperty("polygon", polygons);
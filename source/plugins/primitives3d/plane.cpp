@@ -9,12 +9,7 @@ ObjectDataPtr prim3d::createPlaneMesh(float scale)
     auto mesh = std::make_shared<MeshData>();
     auto vertices = std::make_shared<VertexList>();
     auto normals = std::make_shared<VertexList>();
-    auto polygons = std::make_shared<PolygonList>();
-
-    mesh->setProperty("P", vertices);
-    mesh->setProperty("N", normals);
-    mesh->setProperty("polygon", polygons);
-    obj->setData(mesh);
+    auto polygons = std::make_shared<PolygonBuffer>();
 
     vertices->insert(vertices->begin(), {
                      vec3(-scale, 0, -scale),
@@ -30,6 +25,11 @@ ObjectDataPtr prim3d::createPlaneMesh(float scale)
                      vec3(0, 1, 0),
                      });
 
-    polygons->push_back(Polygon{3, 2, 1, 0});
+    polygons->addPolygon({3, 2, 1, 0});
+
+    mesh->setProperty("P", vertices);
+    mesh->setProperty("N", normals);
+    mesh->setProperty("polygon", polygons);
+    obj->setData(mesh);
     return mesh;
 }
@@ -0,0 +1,179 @@
+#include "algorithm"
+#include "unordered_map"
+
+#include "render_block.h"
+#include "culling.h"
+
+using namespace MindTree;
+using namespace MindTree::GL;
+
+Frustum::Frustum(const glm::mat4 &viewProjection)
+{
+    //Gribb/Hartmann, the planes are sums and differences of the rows
+    glm::vec4 rows[4];
+    for(int i = 0; i < 4; ++i)
+        rows[i] = glm::vec4(viewProjection[0][i],
+                            viewProjection[1][i],
+                            viewProjection[2][i],
+                            viewProjection[3][i]);
+
+    for(int i = 0; i < 3; ++i) {
+        _planes[i * 2] = rows[3] + rows[i];
+        _planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+
+    for(auto &plane : _planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+Frustum::eIntersection Frustum::intersect(const AABB &box) const
+{
+    eIntersection result = INSIDE;
+    for(const auto &plane : _planes) {
+        glm::vec3 normal(plane);
+
+        //the corners furthest along and against the plane normal
+        glm::vec3 positive(normal.x > 0 ? box.max.x : box.min.x,
+                           normal.y > 0 ? box.max.y : box.min.y,
+                           normal.z > 0 ? box.max.z : box.min.z);
+        glm::vec3 negative(normal.x > 0 ? box.min.x : box.max.x,
+                           normal.y > 0 ? box.min.y : box.max.y,
+                           normal.z > 0 ? box.min.z : box.max.z);
+
+        if(glm::dot(normal, positive) + plane.w < 0) return OUTSIDE;
+        if(glm::dot(normal, negative) + plane.w < 0) result = INTERSECTING;
+    }
+    return result;
+}
+
+namespace {
+void collectBounds(AbstractTransformablePtr transformable,
+                   std::unordered_map<const AbstractTransformable*, AABB> &bounds)
+{
+    switch(transformable->getType()) {
+        case AbstractTransformable::GEO:
+            {
+                auto obj = std::static_pointer_cast<GeoObject>(transformable);
+                auto box = obj->getBounds().transformed(obj->getWorldTransformation());
+                bounds[obj.get()].extend(box);
+            }
+            break;
+        case AbstractTransformable::INSTANCER:
+            for(const auto &instanced : getInstancedObjects(std::static_pointer_cast<Instancer>(transformable))) {
+                auto local = instanced.object->getBounds();
+                auto &box = bounds[instanced.object.get()];
+                for(const auto &instance : *instanced.instances)
+                    box.extend(local.transformed(instance));
+            }
+            break;
+        default:
+            break;
+    }
+
+    for(const auto &child : transformable->getChildren())
+        collectBounds(child, bounds);
+}
+}
+
+BVH::BVH(std::vector<Item> items) :
+    _items(std::move(items))
+{
+    if(_items.empty()) return;
+
+    _nodes.reserve(2 * _items.size());
+    build(0, _items.size());
+}
+
+std::shared_ptr<BVH> BVH::fromGroup(std::shared_ptr<Group> group)
+{
+    std::unordered_map<const AbstractTransformable*, AABB> bounds;
+    for(const auto &member : group->getMembers())
+        collectBounds(member, bounds);
+
+    std::vector<Item> items;
+    items.reserve(bounds.size());
+    for(const auto &pair : bounds) {
+        if(!pair.second.isEmpty())
+            items.push_back({pair.first, pair.second});
+    }
+    return std::make_shared<BVH>(std::move(items));
+}
+
+uint BVH::build(uint first, uint count)
+{
+    uint index = _nodes.size();
+    _nodes.push_back(Node());
+
+    AABB bounds, centers;
+    for(uint i = first; i < first + count; ++i) {
+        bounds.extend(_items[i].bounds);
+        centers.extend(_items[i].bounds.getCenter());
+    }
+
+    Node node;
+    node.bounds = bounds;
+    node.first = first;
+    node.count = count;
+    node.right = 0;
+
+    if(count > MAX_LEAF_SIZE) {
+        //median split along the longest axis of the item centers
+        glm::vec3 extent = centers.max - centers.min;
+        int axis = 0;
+        if(extent.y > extent[axis]) axis = 1;
+        if(extent.z > extent[axis]) axis = 2;
+
+        uint half = count / 2;
+        std::nth_element(begin(_items) + first,
+                         begin(_items) + first + half,
+                         begin(_items) + first + count,
+                         [axis] (const Item &a, const Item &b) {
+                             return a.bounds.getCenter()[axis] < b.bounds.getCenter()[axis];
+                         });
+
+        build(first, half);
+        node.right = build(first + half, count - half);
+    }
+
+    _nodes[index] = node;
+    return index;
+}
+
+CulledObjects BVH::cull(const Frustum &frustum) const
+{
+    CulledObjects culled;
+    if(_nodes.empty()) return culled;
+
+    std::vector<uint> stack{0};
+    while(!stack.empty()) {
+        const Node &node = _nodes[stack.back()];
+        uint index = stack.back();
+        stack.pop_back();
+
+        switch(frustum.intersect(node.bounds)) {
+            case Frustum::INSIDE:
+                break;
+            case Frustum::OUTSIDE:
+                for(uint i = node.first; i < node.first + node.count; ++i)
+                    culled.insert(_items[i].object);
+                break;
+            case Frustum::INTERSECTING:
+                if(node.right) {
+                    stack.push_back(index + 1);
+                    stack.push_back(node.right);
+                }
+                else {
+                    for(uint i = node.first; i < node.first + node.count; ++i)
+                        if(frustum.intersect(_items[i].bounds) == Frustum::OUTSIDE)
+                            culled.insert(_items[i].object);
+                }
+                break;
+        }
+    }
+    return culled;
+}
+
+size_t BVH::size() const
+{
+    return _items.size();
+}
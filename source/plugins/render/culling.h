@@ -0,0 +1,80 @@
+#ifndef MT_GL_CULLING_H
+#define MT_GL_CULLING_H
+
+#include "memory"
+#include "vector"
+#include "unordered_set"
+
+#include "glm/glm.hpp"
+#include "../datatypes/Object/object.h"
+
+namespace MindTree {
+namespace GL {
+
+/*
+ * The six clipping planes of a view projection matrix, normals point
+ * into the frustum.
+ */
+class Frustum
+{
+public:
+    explicit Frustum(const glm::mat4 &viewProjection);
+
+    enum eIntersection {
+        OUTSIDE,
+        INTERSECTING,
+        INSIDE
+    };
+
+    eIntersection intersect(const AABB &box) const;
+
+private:
+    glm::vec4 _planes[6];
+};
+
+typedef std::unordered_set<const AbstractTransformable*> CulledObjects;
+
+/*
+ * Bounding volume hierarchy over the world bounds of the geometry in a
+ * scene. Instanced objects are represented by the bounds of all their
+ * instances.
+ *
+ * Objects without bounds are not part of the hierarchy and are therefore
+ * never culled.
+ */
+class BVH
+{
+public:
+    struct Item {
+        const AbstractTransformable *object;
+        AABB bounds;
+    };
+
+    explicit BVH(std::vector<Item> items);
+    static std::shared_ptr<BVH> fromGroup(std::shared_ptr<Group> group);
+
+    //objects entirely outside the frustum
+    CulledObjects cull(const Frustum &frustum) const;
+
+    size_t size() const;
+
+private:
+    //every node covers the items first ... first + count - 1, the first
+    //child directly follows its parent, right is 0 for leaves
+    struct Node {
+        AABB bounds;
+        uint first, count;
+        uint right;
+    };
+
+    static const uint MAX_LEAF_SIZE = 4;
+
+    uint build(uint first, uint count);
+
+    std::vector<Item> _items;
+    std::vector<Node> _nodes;
+};
+
+}
+}
+#endif
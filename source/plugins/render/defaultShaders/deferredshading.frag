@@ -3,11 +3,14 @@ vec3 pos;
 vec3 Nn;
 
 vec3 eye;
-uniform mat4 view;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 uniform bool GL_defaultLighting = true;
 
 in vec2 st;
-uniform ivec2 resolution;
 
 uniform sampler2D outnormal;
 uniform sampler2D outposition;
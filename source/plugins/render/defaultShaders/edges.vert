@@ -1,7 +1,14 @@
 #version 330
 uniform mat4 modelView;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 in vec3 P;
+uniform int instanced = 0;
+in mat4 instance;
 void main(){
-   gl_Position = projection * modelView * vec4(P, 1);
+   mat4 instanceModelView = instanced == 1 ? modelView * instance : modelView;
+   gl_Position = projection * instanceModelView * vec4(P, 1);
 };
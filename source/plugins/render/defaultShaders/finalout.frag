@@ -1,6 +1,10 @@
 #version 330
 in vec2 st;
-uniform ivec2 resolution;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 uniform sampler2D output;
 
 out vec4 color;
@@ -4,7 +4,11 @@ in vec2 _st;
 out vec2 st;
 
 uniform mat4 modelView;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 
 void main(){
     vec3 p = vec3(P.xy, 1);
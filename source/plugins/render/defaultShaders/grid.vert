@@ -1,6 +1,10 @@
 #version 330
 uniform mat4 modelView;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 uniform vec4 alternatingColor = vec4(1);
 uniform vec4 fillColor = vec4(1);
 uniform vec4 borderColor = vec4(1);
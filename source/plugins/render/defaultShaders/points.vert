@@ -4,13 +4,20 @@ in vec3 C;
 out vec3 vertex_color;
 uniform float has_vertex_color = 0.0f;
 uniform mat4 modelView;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 uniform int size = 5;
 uniform vec4 pointcolor = vec4(1);
+uniform int instanced = 0;
+in mat4 instance;
 
 void main(){
     vertex_color = mix(pointcolor.rgb, C, has_vertex_color);
 
-    gl_Position = projection * modelView * vec4(P, 1.);
+    mat4 instanceModelView = instanced == 1 ? modelView * instance : modelView;
+    gl_Position = projection * instanceModelView * vec4(P, 1.);
     gl_PointSize = size;
 };
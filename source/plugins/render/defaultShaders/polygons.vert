@@ -1,13 +1,21 @@
 #version 330
 uniform mat4 modelView;
 uniform mat4 model;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 
 uniform bool GL_defaultLighting = true;
 
 in vec3 P;
 in vec3 N;
 
+//world transformation of the drawn instance, model is identity then
+uniform int instanced = 0;
+in mat4 instance;
+
 out vec3 pos;
 out vec3 worldPos;
 out vec3 cameraPos;
@@ -16,12 +24,14 @@ out vec3 sn;
 out vec3 worldNormal;
 
 void main(){
-   gl_Position = projection * modelView * vec4(P, 1);
+   mat4 instanceModel = instanced == 1 ? model * instance : model;
+   mat4 instanceModelView = instanced == 1 ? modelView * instance : modelView;
+   gl_Position = projection * instanceModelView * vec4(P, 1);
 
-   worldPos = (model * vec4(P, 1)).xyz;
-   worldNormal = (model * vec4(N, 0)).xyz;
-   cameraPos = (modelView * vec4(P, 1)).xyz;
-   cameraNormal = (modelView * vec4(N, 0)).xyz;
+   worldPos = (instanceModel * vec4(P, 1)).xyz;
+   worldNormal = (instanceModel * vec4(N, 0)).xyz;
+   cameraPos = (instanceModelView * vec4(P, 1)).xyz;
+   cameraNormal = (instanceModelView * vec4(N, 0)).xyz;
 
    if(GL_defaultLighting) {
        pos = cameraPos;
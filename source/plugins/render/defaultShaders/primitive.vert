@@ -1,16 +1,18 @@
 #version 330
 in vec3 P;
 
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 uniform mat4 model;
-uniform mat4 view;
 uniform mat4 mvp;
 uniform mat4 staticTransformation;
 uniform bool fixed_screensize = true;
 uniform bool screen_oriented = false;
 uniform int point_size = 5;
 
-uniform ivec2 resolution;
 out vec3 pos;
 
 mat4 computeScreenOrientation() {
@@ -5,7 +5,11 @@ uniform sampler2D outnormal;
 uniform sampler2D outposition;
 
 in vec2 st;
-uniform ivec2 resolution;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 
 uniform float cosAngleTolerance = 2;
 uniform float distanceTolerance = 1.0;
@@ -7,8 +7,11 @@ uniform sampler2D shading_out;
 in vec2 st;
 
 vec3 camPos;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 
 const float MAXDIST = 5;
 const int MAXSTEPS = 50;
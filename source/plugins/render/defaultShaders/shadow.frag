@@ -7,7 +7,11 @@ uniform vec4 diffuse_color = vec4(1);
 uniform mat4 modelView;
 uniform float coneangle;
 uniform float intensity;
-uniform mat4 view;
+layout(std140) uniform PassConstants {
+    mat4 view;
+    mat4 projection;
+    ivec2 resolution;
+};
 
 //layout (location = 0) out float shadow;
 out vec4 shadow_position;
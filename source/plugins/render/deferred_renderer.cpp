@@ -19,7 +19,7 @@
 #include "rsm_computation_plane.h"
 #include "deferred_light_block.h"
 #include "gbuffer_block.h"
-#include "benchmark.h"
+#include "data/benchmark.h"
 
 #include "deferred_renderer.h"
 
@@ -106,10 +106,15 @@ void DeferredRenderer::setCamera(std::shared_ptr<Camera> cam)
     _finalPass->setCamera(cam);
 }
 
-glm::vec4 DeferredRenderer::getPosition(glm::vec2 pixel) const
+std::future<glm::vec4> DeferredRenderer::requestPosition(glm::vec2 pixel) const
 {
     std::vector<std::string> values = {"worldposition"};
-    return _geometryPass->readPixel(values, pixel)[0];
+    auto position = std::make_shared<std::promise<glm::vec4>>();
+    _geometryPass->requestPixels(values, glm::ivec2(pixel), glm::ivec2(1),
+                                 [position] (std::vector<glm::vec4> pixels) {
+                                     position->set_value(pixels[0]);
+                                 });
+    return position->get_future();
 }
 
 void DeferredRenderer::setProperty(const std::string &name, Property prop)
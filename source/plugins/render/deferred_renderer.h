@@ -22,7 +22,7 @@ public:
 
     void setOverrideOutput(std::string output) override;
     void clearOverrideOutput() override;
-    glm::vec4 getPosition(glm::vec2 pixel) const override;
+    std::future<glm::vec4> requestPosition(glm::vec2 pixel) const override;
 
     void setCamera(std::shared_ptr<Camera> cam) override;
 
@@ -1,4 +1,4 @@
-#include "benchmark.h"
+#include "data/benchmark.h"
 #include "camera_renderer.h"
 #include "empty_renderer.h"
 #include "polygon_renderer.h"
@@ -107,6 +107,25 @@ void GBufferRenderBlock::addRendererFromObject(std::shared_ptr<GeoObject> obj)
     }
 }
 
+void GBufferRenderBlock::addRendererFromInstancer(std::shared_ptr<Instancer> obj)
+{
+    for(const auto &instanced : getInstancedObjects(obj)) {
+        auto geo = instanced.object;
+        switch(geo->getData()->getType()){
+            case ObjectData::MESH:
+                if(geo->getData()->hasProperty("polygon")) {
+                    _gbufferNode->addRenderer(new PolygonRenderer(geo, instanced.instances));
+                    _geometryPass->addGeometryRenderer(new EdgeRenderer(geo, instanced.instances));
+                }
+                _geometryPass->addGeometryRenderer(new PointRenderer(geo, instanced.instances));
+                break;
+            case ObjectData::POINTCLOUD:
+                _geometryPass->addGeometryRenderer(new PointRenderer(geo, instanced.instances));
+                break;
+        }
+    }
+}
+
 void GBufferRenderBlock::setProperty(const std::string &name, Property prop)
 {
     _geometryPass->setProperty(name, prop);
@@ -19,6 +19,7 @@ public:
 
 protected:
     void addRendererFromObject(std::shared_ptr<GeoObject> obj) override;
+    void addRendererFromInstancer(std::shared_ptr<Instancer> obj) override;
 
 private:
     void setupGBuffer();
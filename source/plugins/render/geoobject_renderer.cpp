@@ -5,10 +5,11 @@
 using namespace MindTree;
 using namespace MindTree::GL;
 
-GeoObjectRenderer::GeoObjectRenderer(std::shared_ptr<GeoObject> o)
-    : obj(o)
+GeoObjectRenderer::GeoObjectRenderer(std::shared_ptr<GeoObject> o,
+                                     InstanceTransformations instances)
+    : obj(o), _instances(instances)
 {
-    setTransformation(obj->getWorldTransformation());
+    if(!_instances) setTransformation(obj->getWorldTransformation());
 }
 
 GeoObjectRenderer::~GeoObjectRenderer()
@@ -18,18 +19,54 @@ GeoObjectRenderer::~GeoObjectRenderer()
 void GeoObjectRenderer::init(ShaderProgram* prog)
 {
     auto data = obj->getData();
-    auto propmap = data->getProperties();
-    for(auto propPair : propmap){
-        bool has_attr = prog->hasAttribute(propPair.first);
+    std::vector<std::string> names;
+    if(data->getType() == ObjectData::MESH) {
+        //walk the attribute columns instead of copying the property map
+        auto mesh = std::static_pointer_cast<MeshData>(data);
+        for(auto id : mesh->getAttributeIDs())
+            names.push_back(MeshData::getAttributeName(id));
+    }
+    else {
+        for(const auto &propPair : data->getProperties())
+            names.push_back(propPair.first);
+    }
+
+    for(const auto &name : names){
+        bool has_attr = prog->hasAttribute(name);
         if(has_attr) {
-            getResourceManager()->geometryCache()->uploadData(data.get(), propPair.first);
-            auto vbo = getResourceManager()->geometryCache()->getVBO(data.get(), propPair.first);
+            getResourceManager()->geometryCache()->uploadData(data.get(), name);
+            auto vbo = getResourceManager()->geometryCache()->getVBO(data.get(), name);
             prog->bindAttributeLocation(vbo);
         }
     }
+
+    if(_instances && prog->hasAttribute("instance")) {
+        _instanceVBO = make_resource<VBO>(getResourceManager(), "instance");
+        _instanceVBO->overrideIndex(INSTANCE_LOCATION);
+        _instanceVBO->setDivisor(1);
+        _instanceVBO->bind();
+        _instanceVBO->data(*_instances);
+        _instanceVBO->setPointer();
+        prog->bindAttributeLocation(_instanceVBO.get());
+    }
     initCustom();
 }
 
+const AbstractTransformable* GeoObjectRenderer::getCullingObject() const
+{
+    return obj.get();
+}
+
+bool GeoObjectRenderer::isInstanced() const
+{
+    return _instances != nullptr;
+}
+
+GLsizei GeoObjectRenderer::getInstanceCount() const
+{
+    return _instances ? _instances->size() : 0;
+}
+
 void GeoObjectRenderer::initCustom()
 {
 }
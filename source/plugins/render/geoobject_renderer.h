@@ -6,22 +6,39 @@
 namespace MindTree {
 namespace GL {
 
+typedef std::shared_ptr<const std::vector<glm::mat4>> InstanceTransformations;
+
 class GeoObjectRenderer : public Renderer
 {
 public:
-    GeoObjectRenderer(std::shared_ptr<GeoObject> o);
+    //with instance transformations the object is drawn once per
+    //transformation, they are world transformations
+    GeoObjectRenderer(std::shared_ptr<GeoObject> o,
+                      InstanceTransformations instances=nullptr);
     virtual ~GeoObjectRenderer();
 
+    //attribute location of the instance transformation, it takes up four
+    //locations and is kept clear of the mesh attributes
+    static const uint INSTANCE_LOCATION = 12;
+
+    const AbstractTransformable* getCullingObject() const override;
+
 protected:
     virtual void draw(const CameraPtr &camera, const RenderConfig &config, ShaderProgram* program);
 
     void init(ShaderProgram* prog);
     virtual void initCustom();
 
+    bool isInstanced() const;
+    GLsizei getInstanceCount() const;
+
     std::shared_ptr<GeoObject> obj;
 
 private:
     void setUniforms();
+
+    InstanceTransformations _instances;
+    ResourceHandle<VBO> _instanceVBO;
 };
 
 }
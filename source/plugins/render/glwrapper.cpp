@@ -4,9 +4,11 @@
 #include "glm/gtx/string_cast.hpp"
 #include "iostream"
 #include "fstream"
+#include "cstring"
 #include "rendertree.h"
 #include "data/debuglog.h"
-#include <regex>
+#include "data/benchmark.h"
+#include "algorithm"
 
 #include "glwrapper.h"
 
@@ -139,10 +141,16 @@ std::string VBO::getName() const
     return _name;
 }
 
+uint VBO::getLocationCount() const
+{
+    return _size == 16 ? 4 : 1;
+}
+
 void VBO::bind()
 {
     Buffer::bind();
-    glEnableVertexAttribArray(_index);
+    for(uint i = 0; i < getLocationCount(); ++i)
+        glEnableVertexAttribArray(_index + i);
     MTGLERROR;
 }
 
@@ -155,9 +163,40 @@ void VBO::data(std::shared_ptr<VertexList> l)
     glBufferData(GL_ARRAY_BUFFER, datasize, &(*l)[0], GL_STATIC_DRAW);
 }
 
+void VBO::data(const AttributeSpan<glm::vec3> &values)
+{
+    _datatype = GL_FLOAT;
+    _size = 3;
+
+    size_t datasize = values.size() * _size * sizeof(float);
+    glBufferData(GL_ARRAY_BUFFER, datasize, values.data(), GL_STATIC_DRAW);
+}
+
 void VBO::setPointer()
 {
-    glVertexAttribPointer(_index, _size, _datatype, GL_FALSE, 0, 0);
+    if(getLocationCount() == 1) {
+        glVertexAttribPointer(_index, _size, _datatype, GL_FALSE, 0, 0);
+    }
+    else {
+        GLsizei stride = _size * sizeof(float);
+        for(uint i = 0; i < getLocationCount(); ++i)
+            glVertexAttribPointer(_index + i,
+                                  4,
+                                  _datatype,
+                                  GL_FALSE,
+                                  stride,
+                                  (const GLvoid*)(i * 4 * sizeof(float)));
+    }
+
+    if(_divisor)
+        for(uint i = 0; i < getLocationCount(); ++i)
+            glVertexAttribDivisor(_index + i, _divisor);
+    MTGLERROR;
+}
+
+void VBO::setDivisor(uint divisor)
+{
+    _divisor = divisor;
 }
 
 void VBO::data(VertexList l)
@@ -184,6 +223,14 @@ void VBO::data(std::vector<glm::vec4> l)
     glBufferData(GL_ARRAY_BUFFER, l.size() * _size * sizeof(float), &l[0], GL_STATIC_DRAW);
 }
 
+void VBO::data(const std::vector<glm::mat4> &l)
+{
+    _datatype = GL_FLOAT;
+    _size = 16;
+
+    glBufferData(GL_ARRAY_BUFFER, l.size() * _size * sizeof(float), l.data(), GL_STATIC_DRAW);
+}
+
 GLint VBO::getIndex() const
 {
     return _index;
@@ -209,31 +256,31 @@ void IBO::data(const std::vector<uint32_t> &triangles)
 
 void IBO::data(std::shared_ptr<PolygonList> l)
 {
-    int size = 0;
-
-    //find out size of index buffer by adding together polygon sizes
+    data(l ? std::make_shared<PolygonBuffer>(*l) : nullptr);
+}
 
+void IBO::data(std::shared_ptr<PolygonBuffer> polygons)
+{
     _polysizes.clear();
     _indexOffsets.clear();
-
-    std::vector<uint> data;
-
-    intptr_t offset = 0;
-    for(const auto &p : *l) {
-        size += p.size();
-        for(auto v : p)
-            data.push_back(v);
-
-        //get the size of each polygon
-        _indexOffsets.push_back(offset);
-        _polysizes.push_back(p.size());
-        offset += p.size() * sizeof(uint);
+    if(!polygons) return;
+
+    //the flat index array is uploaded as is, sizes and offsets are
+    //cached for glMultiDrawElements
+    const auto &offsets = polygons->getOffsets();
+    _polysizes.resize(polygons->size());
+    _indexOffsets.resize(polygons->size());
+    for(size_t i = 0; i < polygons->size(); ++i) {
+        _polysizes[i] = polygons->polygonSize(i);
+        _indexOffsets[i] = offsets[i] * sizeof(uint);
     }
 
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(uint), &data[0], GL_STATIC_DRAW);
+    const auto &indices = polygons->getIndices();
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 indices.size() * sizeof(uint),
+                 indices.data(),
+                 GL_STATIC_DRAW);
     MTGLERROR;
-
-    //cache indices for glMultiDrawElements
 }
 
 std::vector<intptr_t> IBO::getOffsets() const
@@ -255,6 +302,171 @@ UBO::~UBO()
 {
 }
 
+void UBO::data(const void *block, size_t size)
+{
+    glBufferData(GL_UNIFORM_BUFFER, size, block, GL_DYNAMIC_DRAW);
+    MTGLERROR;
+}
+
+void UBO::bindBase(GLuint binding)
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, getID());
+    MTGLERROR;
+}
+
+PBO::PBO()
+    : Buffer(GL_PIXEL_PACK_BUFFER), _capacity(0)
+{
+}
+
+PBO::~PBO()
+{
+}
+
+void PBO::reserve(size_t count)
+{
+    if(count <= _capacity) return;
+
+    _capacity = count;
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(glm::vec4) * count, nullptr, GL_STREAM_READ);
+    MTGLERROR;
+}
+
+size_t PBO::capacity() const
+{
+    return _capacity;
+}
+
+std::vector<glm::vec4> PBO::read(size_t count)
+{
+    std::vector<glm::vec4> pixels(count);
+    if(!count) return pixels;
+
+    auto *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER,
+                                  0,
+                                  sizeof(glm::vec4) * count,
+                                  GL_MAP_READ_BIT);
+    MTGLERROR;
+    if(!data) return pixels;
+
+    memcpy(static_cast<void*>(pixels.data()), data, sizeof(glm::vec4) * count);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    MTGLERROR;
+    return pixels;
+}
+
+Fence::Fence()
+    : _sync(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+{
+    MTGLERROR;
+}
+
+Fence::~Fence()
+{
+    glDeleteSync(_sync);
+    MTGLERROR;
+}
+
+bool Fence::isSignaled() const
+{
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(_sync, GL_SYNC_STATUS, 1, nullptr, &status);
+    MTGLERROR;
+    return status == GL_SIGNALED;
+}
+
+bool Fence::wait(GLuint64 timeout) const
+{
+    //flush so the fence is guaranteed to reach the gpu
+    GLenum result = glClientWaitSync(_sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    MTGLERROR;
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+GPUTimer::GPUTimer()
+    : _running(false)
+{
+}
+
+GPUTimer::~GPUTimer()
+{
+    if(_running) end();
+
+    std::vector<GLuint> queries(_unused);
+    queries.insert(queries.end(), _pending.begin(), _pending.end());
+    if(queries.empty()) return;
+
+    glDeleteQueries(queries.size(), queries.data());
+    MTGLERROR;
+}
+
+void GPUTimer::begin()
+{
+    if(_running) return;
+
+    GLuint query;
+    if(_unused.empty()) {
+        glGenQueries(1, &query);
+    }
+    else {
+        query = _unused.back();
+        _unused.pop_back();
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    MTGLERROR;
+    _pending.push_back(query);
+    _running = true;
+}
+
+void GPUTimer::end()
+{
+    if(!_running) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    MTGLERROR;
+    _running = false;
+}
+
+std::vector<uint64_t> GPUTimer::collect()
+{
+    std::vector<uint64_t> durations;
+
+    //queries finish in submission order
+    size_t finished = _running ? _pending.size() - 1 : _pending.size();
+    while(finished--) {
+        GLuint query = _pending.front();
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) break;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        durations.push_back(elapsed);
+
+        _pending.pop_front();
+        _unused.push_back(query);
+    }
+    MTGLERROR;
+
+    return durations;
+}
+
+GPUBenchmarkHandler::GPUBenchmarkHandler(std::weak_ptr<Benchmark> benchmark, GPUTimer &timer)
+    : _benchmark(benchmark.lock()), _timer(timer)
+{
+    if(!_benchmark) return;
+
+    for(uint64_t duration : _timer.collect())
+        _benchmark->addSample(duration);
+    _timer.begin();
+}
+
+GPUBenchmarkHandler::~GPUBenchmarkHandler()
+{
+    if(_benchmark) _timer.end();
+}
+
 FBO::FBO()
     : color_attachments(0)
 {
@@ -555,6 +767,9 @@ void ShaderProgram::link()
 {
     assert(RenderThread::id() == std::this_thread::get_id());
     _textures.clear();
+    _uniformLocations.clear();
+    _uniformValues.clear();
+    _uniformBlockBindings.clear();
 
     glLinkProgram(_id);
     GLint linkStatus;
@@ -662,18 +877,46 @@ GLuint ShaderProgram::getID() const
 
 int ShaderProgram::getUniformLocation(std::string name) const
 {
+    auto it = _uniformLocations.find(name);
+    if(it != end(_uniformLocations)) return it->second;
+
     int loc = glGetUniformLocation(_id, name.c_str());
     if(MTGLERROR) dbout(name);
+    _uniformLocations[name] = loc;
     return loc;
 }
 
+template<typename T>
+bool ShaderProgram::cacheUniform(GLint location, const T &value)
+{
+    static_assert(sizeof(T) <= sizeof(UniformValue::data), "uniform too large to cache");
+
+    auto &cached = _uniformValues[location];
+    if(cached.size == sizeof(T) && !std::memcmp(cached.data.data(), &value, sizeof(T)))
+        return false;
+
+    cached.size = sizeof(T);
+    std::memcpy(cached.data.data(), &value, sizeof(T));
+    return true;
+}
+
+template<typename T>
+bool ShaderProgram::getCachedUniform(GLint location, T *value) const
+{
+    auto it = _uniformValues.find(location);
+    if(it == end(_uniformValues) || it->second.size != sizeof(T)) return false;
+
+    std::memcpy(static_cast<void*>(value), it->second.data.data(), sizeof(T));
+    return true;
+}
+
 void ShaderProgram::setUniform(std::string name, const glm::ivec2 &value)
 {
     assert(RenderThread::id() == std::this_thread::get_id());
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform2i(location, value.x, value.y);
+    if(location > -1 && cacheUniform(location, value)) glUniform2i(location, value.x, value.y);
     if(MTGLERROR) dbout(name);
 }
 
@@ -683,7 +926,7 @@ void ShaderProgram::setUniform(std::string name, const glm::ivec3 &value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform3i(location, value.x, value.y, value.z);
+    if(location > -1 && cacheUniform(location, value)) glUniform3i(location, value.x, value.y, value.z);
     if(MTGLERROR) dbout(name);
 }
 
@@ -693,7 +936,7 @@ void ShaderProgram::setUniform(std::string name, const glm::vec2 &value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform2f(location, value.x, value.y);
+    if(location > -1 && cacheUniform(location, value)) glUniform2f(location, value.x, value.y);
     if(MTGLERROR) dbout(name);
 }
 
@@ -703,7 +946,7 @@ void ShaderProgram::setUniform(std::string name, const glm::vec3 &value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform3f(location, value.x, value.y, value.z);
+    if(location > -1 && cacheUniform(location, value)) glUniform3f(location, value.x, value.y, value.z);
     if(MTGLERROR) dbout(name);
 }
 
@@ -713,7 +956,7 @@ void ShaderProgram::setUniform(std::string name, const glm::vec4 &value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform4f(location, value.x, value.y, value.z, value.w);
+    if(location > -1 && cacheUniform(location, value)) glUniform4f(location, value.x, value.y, value.z, value.w);
     if(MTGLERROR) dbout(name);
 }
 
@@ -723,7 +966,7 @@ void ShaderProgram::setUniform(std::string name, float value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniform1f(location, value);
+    if(location > -1 && cacheUniform(location, value)) glUniform1f(location, value);
     if(MTGLERROR) dbout(name);
 }
 
@@ -736,7 +979,7 @@ void ShaderProgram::setUniform(std::string name, int value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) {
+    if(location > -1 && cacheUniform(location, value)) {
         glUniform1i(location, value);
     }
     if(MTGLERROR) dbout(name);
@@ -748,8 +991,8 @@ void ShaderProgram::setUniform(std::string name, const glm::mat4 &value)
     assert(_initialized);
 
     GLint location = getUniformLocation(name);
-    if(location > -1) glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
-    else std::cout << "shader " << _id << " has no uniform named: " << name << std::endl;
+    if(location > -1 && cacheUniform(location, value))
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 
 #ifdef DEBUG_GL_WRAPPER_SHADER
     dbout(name << glm::to_string(value));
@@ -760,7 +1003,10 @@ void ShaderProgram::setUniform(std::string name, const glm::mat4 &value)
 glm::ivec2 ShaderProgram::getUniformi2(std::string name) const
 {
     glm::ivec2 ret;
-    glGetUniformiv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformiv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -769,7 +1015,10 @@ glm::ivec2 ShaderProgram::getUniformi2(std::string name) const
 glm::ivec3 ShaderProgram::getUniformi3(std::string name) const
 {
     glm::ivec3 ret;
-    glGetUniformiv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformiv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -778,7 +1027,10 @@ glm::ivec3 ShaderProgram::getUniformi3(std::string name) const
 glm::vec2 ShaderProgram::getUniformf2(std::string name) const
 {
     glm::vec2 ret;
-    glGetUniformfv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformfv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -787,7 +1039,10 @@ glm::vec2 ShaderProgram::getUniformf2(std::string name) const
 glm::vec3 ShaderProgram::getUniformf3(std::string name) const
 {
     glm::vec3 ret;
-    glGetUniformfv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformfv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -796,7 +1051,10 @@ glm::vec3 ShaderProgram::getUniformf3(std::string name) const
 glm::vec4 ShaderProgram::getUniformf4(std::string name) const
 {
     glm::vec4 ret;
-    glGetUniformfv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformfv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -805,7 +1063,10 @@ glm::vec4 ShaderProgram::getUniformf4(std::string name) const
 float ShaderProgram::getUniformf(std::string name) const
 {
     float ret;
-    glGetUniformfv(_id, getUniformLocation(name), &ret);
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformfv(_id, location, &ret);
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -814,7 +1075,10 @@ float ShaderProgram::getUniformf(std::string name) const
 int ShaderProgram::getUniformi(std::string name) const
 {
     int ret;
-    glGetUniformiv(_id, getUniformLocation(name), &ret);
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformiv(_id, location, &ret);
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -823,7 +1087,10 @@ int ShaderProgram::getUniformi(std::string name) const
 glm::mat4 ShaderProgram::getUniformf4x4(std::string name) const
 {
     glm::mat4 ret;
-    glGetUniformfv(_id, getUniformLocation(name), glm::value_ptr(ret));
+    GLint location = getUniformLocation(name);
+    if(getCachedUniform(location, &ret)) return ret;
+
+    glGetUniformfv(_id, location, glm::value_ptr(ret));
     if(MTGLERROR) dbout(name);
 
     return ret;
@@ -832,7 +1099,7 @@ glm::mat4 ShaderProgram::getUniformf4x4(std::string name) const
 
 void ShaderProgram::setUniformFromProperty(std::string name, Property prop)
 {
-    name = std::regex_replace(name, std::regex(":"), "_");
+    std::replace(begin(name), end(name), ':', '_');
 
 #ifdef DEBUG_GL_WRAPPER_SHADER
     dbout("setting uniform from property of type " << prop.getType().toStr() << " named " << name);
@@ -900,13 +1167,28 @@ MindTree::Property ShaderProgram::getUniformAsProperty(std::string name, DataTyp
     return prop;
 }
 
-void ShaderProgram::setUniforms(PropertyMap map)
+void ShaderProgram::setUniforms(const PropertyMap &map)
 {
     for(const auto &p : map) {
         setUniformFromProperty(p.first, p.second);
     }
 }
 
+void ShaderProgram::setUniformBlock(const std::string &name, GLuint binding)
+{
+    assert(RenderThread::id() == std::this_thread::get_id());
+    auto it = _uniformBlockBindings.find(name);
+    if(it != end(_uniformBlockBindings) && it->second == binding) return;
+
+    _uniformBlockBindings[name] = binding;
+    GLuint index = glGetUniformBlockIndex(_id, name.c_str());
+    MTGLERROR;
+    if(index == GL_INVALID_INDEX) return;
+
+    glUniformBlockBinding(_id, index, binding);
+    if(MTGLERROR) dbout(name);
+}
+
 void ShaderProgram::setTexture(Texture *texture, std::string name)
 {
     assert(RenderThread::id() == std::this_thread::get_id());
@@ -1062,7 +1344,8 @@ std::string ShaderProgram::getFileName(int shaderType) const
 UniformState::UniformState(ShaderProgram *prog, std::string name, Property value) :
     _program(prog)
 {
-    _name = std::regex_replace(name, std::regex(":"), "_");
+    _name = name;
+    std::replace(begin(_name), end(_name), ':', '_');
     _valid = prog->getUniformLocation(_name) > -1;
 
     if(_valid) {
@@ -3,8 +3,10 @@
 #define GLWRAPPER_TLVMZFDN
 
 #include "vector"
+#include "deque"
 #include "memory"
 #include "unordered_map"
+#include "array"
 #include "typeinfo"
 #include "typeindex"
 #include "GL/glew.h"
@@ -16,6 +18,8 @@
 
 namespace MindTree
 {
+class Benchmark;
+
 namespace GL
 {
 
@@ -118,17 +122,27 @@ public:
 
     std::string getName() const;
     void data(std::shared_ptr<VertexList> l);
+    void data(const AttributeSpan<glm::vec3> &values);
     void data(VertexList l);
     void data(std::vector<glm::vec2> l);
     void data(std::vector<glm::vec4> l);
+
+    //matrices take up one attribute location per column
+    void data(const std::vector<glm::mat4> &l);
     void setPointer();
     GLint getIndex() const;
     void overrideIndex(uint index);
 
+    //per instance attributes advance once every divisor instances
+    void setDivisor(uint divisor);
+
 private:
+    uint getLocationCount() const;
+
     GLuint _index;
     GLenum _datatype;
     uint _size;
+    uint _divisor = 0;
     std::string _name;
 };
 
@@ -142,6 +156,7 @@ public:
     std::vector<intptr_t> getOffsets() const;
 
     void data(std::shared_ptr<PolygonList> l);
+    void data(std::shared_ptr<PolygonBuffer> polygons);
     void data(const std::vector<uint32_t> &triangles);
 
 private:
@@ -154,6 +169,93 @@ class UBO : public Buffer
 public:
     UBO();
     virtual ~UBO();
+
+    void data(const void *block, size_t size);
+
+    //makes the buffer available to uniform blocks using this binding point
+    void bindBase(GLuint binding);
+};
+
+/*
+ * Pixel pack buffer, glReadPixels into a bound PBO returns immediately
+ * and the data can be mapped once the gpu has written it.
+ */
+class PBO : public Buffer
+{
+public:
+    PBO();
+    virtual ~PBO();
+
+    //grows the buffer to hold at least count rgba float pixels
+    void reserve(size_t count);
+    size_t capacity() const;
+
+    std::vector<glm::vec4> read(size_t count);
+
+private:
+    size_t _capacity;
+};
+
+/*
+ * A sync object inserted into the command stream, signaled once the gpu
+ * has executed every command submitted before it.
+ */
+class Fence
+{
+public:
+    Fence();
+    ~Fence();
+
+    bool isSignaled() const;
+
+    //blocks until the fence is signaled or timeout nanoseconds passed
+    bool wait(GLuint64 timeout=GL_TIMEOUT_IGNORED) const;
+
+private:
+    GLsync _sync;
+};
+
+/*
+ * Measures how long the gpu takes for the commands submitted between
+ * begin and end with GL_TIME_ELAPSED queries. Results are only read once
+ * they are available, usually a frame or two later, so measuring never
+ * stalls the pipeline.
+ * Elapsed time queries can not be nested, only one timer may be running
+ * at a time.
+ */
+class GPUTimer
+{
+public:
+    GPUTimer();
+    ~GPUTimer();
+
+    void begin();
+    void end();
+
+    //nanoseconds of the measurements that finished since the last call,
+    //oldest first
+    std::vector<uint64_t> collect();
+
+private:
+    std::deque<GLuint> _pending;
+    std::vector<GLuint> _unused;
+    bool _running;
+};
+
+/*
+ * Counterpart of BenchmarkHandler for the gpu, adds the time the gpu
+ * spends on the commands submitted in its scope to the benchmark once
+ * that is known.
+ */
+class GPUBenchmarkHandler
+{
+public:
+    GPUBenchmarkHandler(std::weak_ptr<Benchmark> benchmark, GPUTimer &timer);
+    ~GPUBenchmarkHandler();
+
+private:
+    std::shared_ptr<Benchmark> _benchmark;
+    GPUTimer &_timer;
 };
 
 class Texture2D;
@@ -275,7 +377,10 @@ public:
     void setUniformFromProperty(std::string name, Property prop);
     Property getUniformAsProperty(std::string name, DataType t) const;
 
-    void setUniforms(PropertyMap map);
+    void setUniforms(const PropertyMap &map);
+
+    //connects the named uniform block to a buffer binding point
+    void setUniformBlock(const std::string &name, GLuint binding);
 
     void setTexture(Texture *texture, std::string name="");
 
@@ -304,8 +409,18 @@ private:
         std::string name;
     };
 
+    //raw copy of the last value uploaded to a location
+    struct UniformValue {
+        size_t size = 0;
+        std::array<char, sizeof(glm::mat4)> data;
+    };
+
     void _addShaderFromSource(std::string src, ShaderType type);
 
+    //returns false when value is already set and the gl call can be skipped
+    template<typename T> bool cacheUniform(GLint location, const T &value);
+    template<typename T> bool getCachedUniform(GLint location, T *value) const;
+
     GLuint _id;
     std::atomic<bool> _isBound, _initialized;
     int _attributes = 0;
@@ -315,6 +430,11 @@ private:
     std::unordered_map<int, std::string> _shaderSources;
     std::vector<TextureInfo> _textures;
     std::unordered_map<int, std::string> _fileNameMap;
+
+    //locations and values are only touched from the render thread
+    mutable std::unordered_map<std::string, GLint> _uniformLocations;
+    std::unordered_map<GLint, UniformValue> _uniformValues;
+    std::unordered_map<std::string, GLuint> _uniformBlockBindings;
 };
 
 class UniformState
@@ -403,8 +523,9 @@ public:
 
     virtual void init();
 
-    template<typename T>
-    void init(const std::vector<T> &data)
+    //data is any contiguous container, a std::vector or an AttributeSpan
+    template<typename Container>
+    void init(const Container &data)
     {
         Texture::init();
 
@@ -9,9 +9,8 @@
 
 using namespace MindTree::GL;
 
-PolygonRenderer::PolygonRenderer(std::shared_ptr<GeoObject> o)
-
-    : GeoObjectRenderer(o),
+PolygonRenderer::PolygonRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances)
+    : GeoObjectRenderer(o, instances),
       _triangleCount(0)
 {
 }
@@ -34,36 +33,28 @@ ShaderProgram* PolygonRenderer::getProgram()
 
 std::vector<uint> PolygonRenderer::triangulate()
 {
-    auto data = obj->getData();
-    auto polygons = data->getProperty("polygon").getData<PolygonListPtr>();
-
-    std::cout << "---------" << std::endl;
-    std::cout << "polygon count: " << polygons->size() << std::endl;
-    std::vector<uint> triangles;
-    for(const Polygon &poly : *polygons) {
-        uint first = poly[0];
-        for(size_t i = 1; i < poly.size() - 1; ++i) {
-            triangles.push_back(first);
-            triangles.push_back(poly[i]);
-            triangles.push_back(poly[i+1]);
-        }
+    auto data = std::static_pointer_cast<MeshData>(obj->getData());
+    auto polygons = data->getPolygonBuffer();
+    if(!polygons) {
+        _triangleCount = 0;
+        return std::vector<uint>();
     }
+
+    auto triangles = polygons->triangulate();
     _triangleCount = triangles.size();
-    std::cout << "traingle count: " << _triangleCount << std::endl;
-    std::cout << "---------" << std::endl;
     return triangles;
 }
 
 void PolygonRenderer::initCustom()
 {
-    auto data = obj->getData();
+    auto data = std::static_pointer_cast<MeshData>(obj->getData());
     _triangulatedIBO = make_resource<IBO>(getResourceManager());
     _triangulatedIBO->bind();
     _triangulatedIBO->data(triangulate());
-    if (std::static_pointer_cast<MeshData>(data)->hasProperty("polygon_color")) {
-        auto colProp = std::static_pointer_cast<MeshData>(data)->getProperty("polygon_color");
-        auto colors = colProp.getData<std::vector<uint8_t>>();
 
+    static const auto POLYGON_COLOR = MeshData::getAttributeID("polygon_color");
+    auto colors = data->getAttributeSpan<uint8_t>(POLYGON_COLOR);
+    if (colors) {
         _polyColors = make_resource<Texture>(getResourceManager(), "polygon_color", Texture::RGB8);
         _polyColors->setWidth(colors.size() / 3);
         _polyColors->init(colors);
@@ -91,15 +82,25 @@ void PolygonRenderer::draw(const CameraPtr &camera, const RenderConfig &config,
     //program->setTexture(_polyColorTexture);
     glPolygonOffset(1.0, 1.0);
     MTGLERROR;
-    glDrawElements(GL_TRIANGLES, //Primitive type
-                   _triangleCount,
-                   GL_UNSIGNED_INT, //index datatype
-                   nullptr); //offsets
+    if(isInstanced()) {
+        manager.addState("instanced", 1);
+        glDrawElementsInstanced(GL_TRIANGLES,
+                                _triangleCount,
+                                GL_UNSIGNED_INT,
+                                nullptr,
+                                getInstanceCount());
+    }
+    else {
+        glDrawElements(GL_TRIANGLES, //Primitive type
+                       _triangleCount,
+                       GL_UNSIGNED_INT, //index datatype
+                       nullptr); //offsets
+    }
     MTGLERROR;
 }
 
-EdgeRenderer::EdgeRenderer(std::shared_ptr<GeoObject> o)
-    : GeoObjectRenderer(o)
+EdgeRenderer::EdgeRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances)
+    : GeoObjectRenderer(o, instances), _lineIndexCount(0)
 {
 }
 
@@ -122,9 +123,30 @@ ShaderProgram* EdgeRenderer::getProgram()
 void EdgeRenderer::initCustom()
 {
     auto data = obj->getData();
-    auto ibo = getResourceManager()->geometryCache()->getIBO(data.get());
-    ibo->bind();
-    ibo->data(data->getProperty("polygon").getData<PolygonListPtr>());
+    auto polygons = std::static_pointer_cast<MeshData>(data)->getPolygonBuffer();
+    if(!isInstanced()) {
+        auto ibo = getResourceManager()->geometryCache()->getIBO(data.get());
+        ibo->bind();
+        ibo->data(polygons);
+        return;
+    }
+
+    std::vector<uint> lines;
+    if(polygons) {
+        lines.reserve(polygons->getIndexCount() * 2);
+        for(size_t i = 0; i < polygons->size(); ++i) {
+            uint size = polygons->polygonSize(i);
+            const uint *indices = polygons->polygonBegin(i);
+            for(uint j = 0; j < size; ++j) {
+                lines.push_back(indices[j]);
+                lines.push_back(indices[(j + 1) % size]);
+            }
+        }
+    }
+    _lineIndexCount = lines.size();
+    _linesIBO = make_resource<IBO>(getResourceManager());
+    _linesIBO->bind();
+    _linesIBO->data(lines);
 }
 
 void EdgeRenderer::draw(const CameraPtr &camera, const RenderConfig &config, ShaderProgram* program)
@@ -137,26 +159,36 @@ void EdgeRenderer::draw(const CameraPtr &camera, const RenderConfig &config, Sha
     if (obj->hasProperty("display.lineWidth"))
         lineWidth =  obj->getProperty("display.lineWidth").getData<double>();
 
-    auto data = obj->getData();
-    auto ibo = getResourceManager()->geometryCache()->getIBO(data.get());
-
-    auto polysizes = ibo->getSizes();
-    auto indexOffsets = ibo->getOffsets();
     glEnable(GL_LINE_SMOOTH);
-
     glLineWidth(lineWidth);
-    glMultiDrawElements(GL_LINE_LOOP, //Primitive type
-                        (const GLsizei*)&polysizes[0], //polygon sizes
-                        GL_UNSIGNED_INT, //index datatype
-                        (const GLvoid**)&indexOffsets[0],
-                        polysizes.size()); //primitive count
+    if(isInstanced()) {
+        UniformStateManager manager(program);
+        manager.addState("instanced", 1);
+        glDrawElementsInstanced(GL_LINES,
+                                _lineIndexCount,
+                                GL_UNSIGNED_INT,
+                                nullptr,
+                                getInstanceCount());
+    }
+    else {
+        auto data = obj->getData();
+        auto ibo = getResourceManager()->geometryCache()->getIBO(data.get());
+
+        auto polysizes = ibo->getSizes();
+        auto indexOffsets = ibo->getOffsets();
+        glMultiDrawElements(GL_LINE_LOOP, //Primitive type
+                            (const GLsizei*)&polysizes[0], //polygon sizes
+                            GL_UNSIGNED_INT, //index datatype
+                            (const GLvoid**)&indexOffsets[0],
+                            polysizes.size()); //primitive count
+    }
     MTGLERROR;
     glLineWidth(1);
     glDisable(GL_LINE_SMOOTH);
 }
 
-PointRenderer::PointRenderer(std::shared_ptr<GeoObject> o)
-    : GeoObjectRenderer(o)
+PointRenderer::PointRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances)
+    : GeoObjectRenderer(o, instances)
 {
     auto props = std::static_pointer_cast<MeshData>(o->getData())->getProperties();
     per_vertex_color_ = props.find("C") != props.end();
@@ -187,6 +219,12 @@ void PointRenderer::draw(const CameraPtr &camera, const RenderConfig &config, Sh
     manager.addState("has_vertex_color", (float)per_vertex_color_);
     auto mesh = std::static_pointer_cast<MeshData>(obj->getData());
     auto verts = mesh->getProperty("P").getData<std::shared_ptr<VertexList>>();
-    glDrawArrays(GL_POINTS, 0, verts->size());
+    if(isInstanced()) {
+        manager.addState("instanced", 1);
+        glDrawArraysInstanced(GL_POINTS, 0, verts->size(), getInstanceCount());
+    }
+    else {
+        glDrawArrays(GL_POINTS, 0, verts->size());
+    }
     MTGLERROR;
 }
@@ -11,7 +11,7 @@ namespace GL
 class PolygonRenderer : public GeoObjectRenderer
 {
 public:
-    PolygonRenderer(std::shared_ptr<GeoObject> o);
+    PolygonRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances=nullptr);
     virtual ~PolygonRenderer();
 
     ShaderProgram* getProgram();
@@ -31,7 +31,7 @@ private:
 class EdgeRenderer : public GeoObjectRenderer
 {
 public:
-    EdgeRenderer(std::shared_ptr<GeoObject> o);
+    EdgeRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances=nullptr);
     virtual ~EdgeRenderer();
 
     ShaderProgram* getProgram();
@@ -41,12 +41,17 @@ protected:
 
 private:
     void initCustom();
+
+    //instances are drawn from one list of lines, there is no instanced
+    //variant of glMultiDrawElements
+    size_t _lineIndexCount;
+    ResourceHandle<IBO> _linesIBO;
 };
 
 class PointRenderer : public GeoObjectRenderer
 {
 public:
-    PointRenderer(std::shared_ptr<GeoObject> o);
+    PointRenderer(std::shared_ptr<GeoObject> o, InstanceTransformations instances=nullptr);
     virtual ~PointRenderer();
 
     ShaderProgram* getProgram();
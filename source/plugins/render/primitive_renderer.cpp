@@ -458,7 +458,7 @@ void SphereRenderer::init(ShaderProgram* prog)
     _ibo->bind();
     prog->bindAttributeLocation(_vbo.get());
 
-    auto polygons = std::make_shared<PolygonList>();
+    auto polygons = std::make_shared<PolygonBuffer>();
 
     VertexList verts;
 
@@ -477,7 +477,7 @@ void SphereRenderer::init(ShaderProgram* prog)
     }
 
     for(uint i = 2; i < _v_segments + 1; i += 3) {
-        polygons->emplace_back(Polygon{(i + 1) % _v_segments, i, 0});
+        polygons->addPolygon({(i + 1) % _v_segments, i, 0});
         uint offset = (_u_segments - 1) * _v_segments + 2;
         //polygons->emplace_back(Polygon{1, i + offset, i+1 + offset});
     }
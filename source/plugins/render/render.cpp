@@ -110,6 +110,11 @@ void Renderer::addChild(std::unique_ptr<Renderer> &&child)
     _children.push_back(std::move(child));
 }
 
+const AbstractTransformable* Renderer::getCullingObject() const
+{
+    return nullptr;
+}
+
 const Renderer* Renderer::getParent() const
 {
     return _parent;
@@ -128,17 +133,19 @@ void Renderer::render(const CameraPtr camera, const RenderConfig &config, Shader
 
     {
         GLObjectBinder<VAO*> vaoBinder(_vao.get());
-        UniformStateManager uniformStates(program);
 
+        //every renderer sets its own matrices, so they are not restored.
+        //view and projection are only uploaded for shaders that don't use
+        //the pass constants block and are skipped once they are set
         if(camera) {
             auto model = getGlobalTransformation();
             auto view = camera->getViewMatrix();
             auto projection = camera->getProjection();
-            uniformStates.addState("model", model);
-            uniformStates.addState("view", view);
-            uniformStates.addState("modelView", view * model);
-            uniformStates.addState("projection", projection);
-            uniformStates.addState("mvp", projection * view * model);
+            program->setUniform("model", model);
+            program->setUniform("view", view);
+            program->setUniform("modelView", view * model);
+            program->setUniform("projection", projection);
+            program->setUniform("mvp", projection * view * model);
         }
 
         draw(camera, config, program);
@@ -42,6 +42,10 @@ public:
     void setVisible(bool visible);
 
     virtual ShaderProgram* getProgram() = 0;
+
+    //the scene object this renderer draws, used to look it up in the
+    //culling results. renderers without an object are always drawn
+    virtual const AbstractTransformable* getCullingObject() const;
     void setResourceManager(ResourceManager *manager);
 
 protected:
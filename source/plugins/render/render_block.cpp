@@ -10,7 +10,7 @@
 
 #include "render_setup.h"
 #include "rendertree.h"
-#include "benchmark.h"
+#include "data/benchmark.h"
 #include "string"
 
 #include "render_block.h"
@@ -117,6 +117,9 @@ void RenderBlock::addRendererFromTransformable(AbstractTransformablePtr transfor
         case AbstractTransformable::JOINT:
             addRendererFromJoint(std::dynamic_pointer_cast<Joint>(transformable));
             break;
+        case AbstractTransformable::INSTANCER:
+            addRendererFromInstancer(std::dynamic_pointer_cast<Instancer>(transformable));
+            break;
     }
     addRenderersFromGroup(transformable->getChildren());
 }
@@ -141,6 +144,40 @@ void RenderBlock::addRendererFromJoint(JointPtr obj)
 {
 }
 
+void RenderBlock::addRendererFromInstancer(InstancerPtr obj)
+{
+}
+
+std::vector<InstancedObject> MindTree::GL::getInstancedObjects(InstancerPtr instancer)
+{
+    std::vector<InstancedObject> objects;
+    auto transformations = instancer->getInstanceTransformations();
+    if(!transformations) return objects;
+
+    glm::mat4 world = instancer->getWorldTransformation();
+    std::vector<std::pair<AbstractTransformablePtr, glm::mat4>> stack;
+    stack.push_back({instancer->getPrototype(), glm::mat4()});
+    while(!stack.empty()) {
+        auto transformable = stack.back().first;
+        //relative to the prototype, the prototype itself has no parent
+        glm::mat4 local = stack.back().second * transformable->getTransformation();
+        stack.pop_back();
+
+        for(const auto &child : transformable->getChildren())
+            stack.push_back({child, local});
+
+        if(transformable->getType() != AbstractTransformable::GEO) continue;
+
+        auto instances = std::make_shared<std::vector<glm::mat4>>();
+        instances->reserve(transformations->size());
+        for(const auto &trans : *transformations)
+            instances->push_back(world * trans * local);
+
+        objects.push_back({std::static_pointer_cast<GeoObject>(transformable), instances});
+    }
+    return objects;
+}
+
 RenderPass* RenderBlock::addPass(const std::string &name)
 {
     auto pass = std::make_unique<RenderPass>(name);
@@ -211,6 +248,9 @@ void GeometryRenderBlock::addRendererFromTransformable(AbstractTransformablePtr
         case AbstractTransformable::JOINT:
             addRendererFromJoint(std::dynamic_pointer_cast<Joint>(transformable));
             break;
+        case AbstractTransformable::INSTANCER:
+            addRendererFromInstancer(std::dynamic_pointer_cast<Instancer>(transformable));
+            break;
     }
     addRenderersFromGroup(transformable->getChildren());
 }
@@ -232,6 +272,25 @@ void GeometryRenderBlock::addRendererFromObject(GeoObjectPtr obj)
     }
 }
 
+void GeometryRenderBlock::addRendererFromInstancer(InstancerPtr obj)
+{
+    for(const auto &instanced : getInstancedObjects(obj)) {
+        auto geo = instanced.object;
+        switch(geo->getData()->getType()){
+            case ObjectData::MESH:
+                if(geo->getData()->hasProperty("polygon")) {
+                    _geometryPass->addGeometryRenderer(new PolygonRenderer(geo, instanced.instances));
+                    _geometryPass->addGeometryRenderer(new EdgeRenderer(geo, instanced.instances));
+                }
+                _geometryPass->addGeometryRenderer(new PointRenderer(geo, instanced.instances));
+                break;
+            case ObjectData::POINTCLOUD:
+                _geometryPass->addGeometryRenderer(new PointRenderer(geo, instanced.instances));
+                break;
+        }
+    }
+}
+
 void GeometryRenderBlock::addRendererFromLight(LightPtr obj)
 {
     assert(obj);
@@ -4,6 +4,7 @@
 #include "memory"
 #include "vector"
 
+#include "glm/glm.hpp"
 #include "data/mtobject.h"
 
 class Camera;
@@ -12,6 +13,7 @@ class GeoObject;
 class Light;
 class Empty;
 class Group;
+class Instancer;
 
 namespace MindTree {
 class Joint;
@@ -23,6 +25,17 @@ class RenderTree;
 class RenderConfigurator;
 
 class Texture2D;
+
+//an object of an instancer's prototype together with the world
+//transformations of all its instances
+struct InstancedObject
+{
+    std::shared_ptr<GeoObject> object;
+    std::shared_ptr<const std::vector<glm::mat4>> instances;
+};
+
+std::vector<InstancedObject> getInstancedObjects(std::shared_ptr<Instancer> instancer);
+
 class RenderBlock : public Object
 {
 public:
@@ -53,6 +66,7 @@ protected:
     virtual void addRendererFromCamera(std::shared_ptr<Camera> obj);
     virtual void addRendererFromEmpty(std::shared_ptr<Empty> obj);
     virtual void addRendererFromJoint(std::shared_ptr<Joint> obj);
+    virtual void addRendererFromInstancer(std::shared_ptr<Instancer> obj);
 
     void addOutput(Texture2D *output);
 
@@ -83,6 +97,7 @@ protected:
     virtual void addRendererFromCamera(std::shared_ptr<Camera> obj);
     virtual void addRendererFromEmpty(std::shared_ptr<Empty> obj);
     virtual void addRendererFromJoint(std::shared_ptr<Joint> obj);
+    virtual void addRendererFromInstancer(std::shared_ptr<Instancer> obj);
 
     RenderPass *_geometryPass;
 
@@ -14,7 +14,8 @@
 #include "empty_renderer.h"
 #include "shader_render_node.h"
 #include "render_block.h"
-#include "benchmark.h"
+#include "data/benchmark.h"
+#include "culling.h"
 
 #include "render_setup.h"
 
@@ -76,9 +77,16 @@ void RenderConfigurator::addRenderBlock(std::unique_ptr<RenderBlock> &&block)
     _renderBlocks.push_back(std::move(block));
 }
 
+std::future<glm::vec4> RenderConfigurator::requestPosition(glm::vec2 pixel) const
+{
+    std::promise<glm::vec4> position;
+    position.set_value(glm::vec4(0));
+    return position.get_future();
+}
+
 glm::vec4 RenderConfigurator::getPosition(glm::vec2 pixel) const
 {
-    return glm::vec4(0);
+    return requestPosition(pixel).get();
 }
 
 RenderTree* RenderConfigurator::getManager()
@@ -116,6 +124,7 @@ void RenderConfigurator::setGeometry(std::shared_ptr<Group> grp)
 {
     _vertexCount = grp->getVertexCount();
     _polyCount = grp->getPolygonCount();
+    _rendertree->setSceneBVH(BVH::fromGroup(grp));
     for(auto &block : _renderBlocks) {
         block->setGeometry(grp);
     }
@@ -3,6 +3,7 @@
 
 #include "memory"
 #include "vector"
+#include "future"
 
 #include "data/mtobject.h"
 
@@ -44,7 +45,10 @@ public:
 
     virtual void setOverrideOutput(std::string output);
     virtual void clearOverrideOutput();
-    virtual glm::vec4 getPosition(glm::vec2 pixel) const;
+
+    //world position under pixel, resolved one frame later
+    virtual std::future<glm::vec4> requestPosition(glm::vec2 pixel) const;
+    glm::vec4 getPosition(glm::vec2 pixel) const;
 
     void addRenderBlock(std::unique_ptr<RenderBlock> &&block);
 
@@ -5,7 +5,8 @@
 #include "data/debuglog.h"
 #include "shader_render_node.h"
 #include "rendertree.h"
-#include "benchmark.h"
+#include "data/benchmark.h"
+#include "culling.h"
 #include "renderpass.h"
 
 using namespace MindTree;
@@ -273,141 +274,139 @@ void RenderPass::setTextures(std::vector<Texture2D*> textures)
     }
 }
 
+void RenderPass::requestPixels(std::vector<std::string> names,
+                               glm::ivec2 pos,
+                               glm::ivec2 size,
+                               PixelCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_pixelRequestsLock);
+        _pixelRequests.push_back({names, pos, glm::max(size, glm::ivec2(1)), callback});
+    }
+    //issue in the next frame and resolve in the one after that
+    RenderThread::scheduleFrame();
+    RenderThread::scheduleFrame();
+}
+
+std::future<std::vector<glm::vec4>> RenderPass::requestPixels(std::vector<std::string> names,
+                                                              glm::ivec2 pos,
+                                                              glm::ivec2 size)
+{
+    auto promise = std::make_shared<std::promise<std::vector<glm::vec4>>>();
+    requestPixels(names, pos, size, [promise] (std::vector<glm::vec4> pixels) {
+                  promise->set_value(pixels);
+              });
+    return promise->get_future();
+}
+
 std::vector<glm::vec4> RenderPass::readPixel(std::vector<std::string> names, glm::ivec2 pos)
 {
-    std::unique_lock<std::mutex> lock(_pixelRequestsLock);
-    for(auto name : names)
-        _pixelRequests.push(std::make_pair(name, pos));
+    return requestPixels(names, pos).get();
+}
 
-    pixelRequestsCondition_.wait(lock);
-    return _requestedPixels;
+GLenum RenderPass::getReadBuffer(const std::string &name) const
+{
+    if(!_target) return GL_BACK;
+    return GL_COLOR_ATTACHMENT0 + _target->getAttachmentPos(name);
 }
 
-void RenderPass::processPixelRequests()
+void RenderPass::resolvePixelReadbacks()
 {
-    std::unique_lock<std::mutex> locker(_pixelRequestsLock);
-    _requestedPixels.clear();
-    if (_pixelRequests.empty()) return;
-    while(_pixelRequests.size() > 0) {
-        auto request = _pixelRequests.front();
-        _pixelRequests.pop();
-        auto name = request.first;
-        auto pos = request.second;
-
-        //find attachment
-        if(_target) {
-            glReadBuffer(GL_COLOR_ATTACHMENT0 + _target->getAttachmentPos(name));
-            MTGLERROR;
-        }
-        else {
-            glReadBuffer(GL_BACK);
-            MTGLERROR;
-        }
+    //everything still pending was issued in an earlier frame, so the
+    //fences are almost always signaled already
+    while(!_pixelReadbacks.empty()) {
+        auto &readback = _pixelReadbacks.front();
 
-        //find out whether name is a renderbuffer or a taxture
-        GLenum datasize = GL_UNSIGNED_BYTE;
-        GLenum format = GL_RGBA;
-        for(const auto &tex : _outputTextures) {
-            if (tex->getName() == name){
-                switch(tex->getFormat()) {
-                case Texture::RGB:
-                    format = GL_RGB;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Texture::RGB8:
-                    format = GL_RGB;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Texture::RGBA:
-                    format = GL_RGBA;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Texture::RGBA8:
-                    format = GL_RGBA;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Texture::RGBA16F:
-                    format = GL_RGBA;
-                    datasize = GL_FLOAT;
-                    break;
-                default:
-                    break;
-                }
-            }
+        //later readbacks were issued after this one, try again next frame
+        //instead of stalling on the gpu
+        if(!readback.fence->isSignaled()) {
+            RenderThread::scheduleFrame();
+            return;
         }
 
-        for(const auto &renderbuffer : _outputRenderbuffers) {
-            if (renderbuffer->getName() == name){
-                switch(renderbuffer->getFormat()) {
-                case Renderbuffer::RGB:
-                    format = GL_RGB;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Renderbuffer::RGB8:
-                    format = GL_RGB;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Renderbuffer::RGBA:
-                    format = GL_RGBA;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Renderbuffer::RGBA8:
-                    format = GL_RGBA;
-                    datasize = GL_UNSIGNED_BYTE;
-                    break;
-                case Renderbuffer::RGBA16F:
-                    format = GL_RGBA;
-                    datasize = GL_FLOAT;
-                    break;
-                default:
-                    break;
-                }
+        {
+            GLObjectBinder<PBO*> binder(readback.buffer.get());
+
+            size_t total = 0;
+            for(const auto &request : readback.requests)
+                total += request.names.size() * request.size.x * request.size.y;
+            auto pixels = readback.buffer->read(total);
+
+            size_t offset = 0;
+            for(const auto &request : readback.requests) {
+                size_t count = request.names.size() * request.size.x * request.size.y;
+                request.callback(std::vector<glm::vec4>(begin(pixels) + offset,
+                                                        begin(pixels) + offset + count));
+                offset += count;
             }
         }
-        //and then find its datasize
-        void* data = nullptr;
+        _freePixelBuffers.push_back(std::move(readback.buffer));
+        _pixelReadbacks.pop();
+    }
+}
 
-        if(format == GL_RGB)
-            data = new GLubyte[3];
-        else if(format == GL_RGBA && datasize == GL_UNSIGNED_BYTE)
-            data = new GLubyte[4];
-        else if(format == GL_RGBA && datasize == GL_FLOAT)
-            data = new GLfloat[4];
+void RenderPass::cancelPixelRequests()
+{
+    resolvePixelReadbacks();
 
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        MTGLERROR;
-        glReadPixels(pos.x, pos.y, 1, 1, format, datasize, data);
-        MTGLERROR;
+    std::vector<PixelRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(_pixelRequestsLock);
+        requests.swap(_pixelRequests);
+    }
 
-        glm::vec4 color;
-        if(format == GL_RGB) {
-            GLubyte* raw_color = reinterpret_cast<GLubyte*>(data);
-            color = glm::vec4(raw_color[0] / 255.0,
-                              raw_color[1] / 255.0,
-                              raw_color[2] / 255.0,
-                              1);
-            delete [] raw_color;
-        }
-        else if(format == GL_RGBA && datasize == GL_UNSIGNED_BYTE) {
-            GLubyte* raw_color = reinterpret_cast<GLubyte*>(data);
-            color = glm::vec4(raw_color[0] / 255.0,
-                              raw_color[1] / 255.0,
-                              raw_color[2] / 255.0,
-                              raw_color[3] / 255.0);
-            delete [] raw_color;
-        }
-        else if(format == GL_RGBA && datasize == GL_FLOAT) {
-            GLfloat* raw_color = reinterpret_cast<GLfloat*>(data);
-            color = glm::vec4(raw_color[0],
-                              raw_color[1],
-                              raw_color[2],
-                              raw_color[3]);
-            delete [] raw_color;
-        }
+    //nothing was drawn to read from, callers waiting on a result get an
+    //empty one
+    for(const auto &request : requests)
+        request.callback(std::vector<glm::vec4>());
+}
+
+void RenderPass::processPixelRequests()
+{
+    resolvePixelReadbacks();
+
+    PixelReadback readback;
+    {
+        std::lock_guard<std::mutex> lock(_pixelRequestsLock);
+        if(_pixelRequests.empty()) return;
+        readback.requests.swap(_pixelRequests);
+    }
+
+    size_t count = 0;
+    for(const auto &request : readback.requests)
+        count += request.names.size() * request.size.x * request.size.y;
 
-        _requestedPixels.push_back(color);
+    if(_freePixelBuffers.empty()) {
+        readback.buffer = make_resource<PBO>(_tree->getResourceManager());
+    }
+    else {
+        readback.buffer = std::move(_freePixelBuffers.back());
+        _freePixelBuffers.pop_back();
+    }
+
+    GLObjectBinder<PBO*> binder(readback.buffer.get());
+    readback.buffer->reserve(count);
+
+    //every format is read as normalized rgba floats, rgb outputs get an
+    //alpha of 1
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    MTGLERROR;
+    size_t offset = 0;
+    for(const auto &request : readback.requests) {
+        for(const auto &name : request.names) {
+            glReadBuffer(getReadBuffer(name));
+            MTGLERROR;
+            glReadPixels(request.pos.x, request.pos.y,
+                         request.size.x, request.size.y,
+                         GL_RGBA, GL_FLOAT,
+                         reinterpret_cast<GLvoid*>(offset * sizeof(glm::vec4)));
+            MTGLERROR;
+            offset += request.size.x * request.size.y;
+        }
     }
-    pixelRequestsCondition_.notify_all();
+
+    readback.fence = make_resource<Fence>(_tree->getResourceManager());
+    _pixelReadbacks.push(std::move(readback));
 }
 
 void RenderPass::setTarget(ResourceHandle<FBO> &&target)
@@ -591,22 +590,47 @@ void RenderPass::setClearDepth(float value)
     _depth = value;
 }
 
+glm::mat4 RenderPass::updatePassConstants(int width, int height)
+{
+    PassConstants constants;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(_cameraLock);
+        constants.view = _camera->getViewMatrix();
+        constants.projection = _camera->getProjection();
+    }
+    constants.resolution = glm::ivec2(width, height);
+
+    if(!_passConstants)
+        _passConstants = make_resource<UBO>(_tree->getResourceManager());
+
+    GLObjectBinder<UBO*> binder(_passConstants.get());
+    _passConstants->data(&constants, sizeof(constants));
+    _passConstants->bindBase(PASS_CONSTANTS_BINDING);
+    return constants.projection * constants.view;
+}
+
 void RenderPass::render(const RenderConfig &config)
 {
     int width{0};
     int height{0};
     {
         std::shared_lock<std::shared_timed_mutex> lock(_cameraLock);
-        if(!_camera) return;
-        width = _camera->getWidth();
-        height = _camera->getHeight();
+        if(_camera) {
+            width = _camera->getWidth();
+            height = _camera->getHeight();
+        }
     }
 
     if(!width || !height) {
+        cancelPixelRequests();
         return;
     }
 
-    BenchmarkHandler bhandler(_benchmark);
+    //submitting the commands says little about the cost of a pass, its
+    //benchmark measures the time the gpu spends on them
+    if(!_gpuTimer)
+        _gpuTimer = make_resource<GPUTimer>(_tree->getResourceManager());
+    GPUBenchmarkHandler bhandler(_benchmark, *_gpuTimer);
 
     if(!_initialized || _currentHeight != height || _currentWidth != width) init();
 
@@ -670,6 +694,7 @@ void RenderPass::render(const RenderConfig &config)
 
         if(_shadernodes.empty() && _geometryShaderNodes.empty()) {
             std::cout << "RenderPass is empty" << std::endl;
+            cancelPixelRequests();
             return;
         }
 
@@ -677,6 +702,17 @@ void RenderPass::render(const RenderConfig &config)
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         if(_enabled) {
+            glm::mat4 viewProjection = updatePassConstants(width, height);
+
+            //objects outside this pass' camera frustum, for shadow passes
+            //that is the light frustum
+            CulledObjects culled;
+            auto bvh = _tree ? _tree->getSceneBVH() : nullptr;
+            if(bvh) culled = bvh->cull(Frustum(viewProjection));
+
+            //copied once per pass, programs skip values that did not change
+            auto passProperties = getProperties();
+            auto configProperties = config.getProperties();
             {
                 std::shared_lock<std::shared_timed_mutex> lock(_geometryLock);
                 std::shared_lock<std::shared_timed_mutex> shapeLock(_shapesLock);
@@ -685,15 +721,13 @@ void RenderPass::render(const RenderConfig &config)
                     node->init();
                     {
                         GLObjectBinder<ShaderProgram*> binder(node->program());
-                        for(const auto &p : getProperties())
-                            node->program()->setUniformFromProperty(p.first, p.second);
-
-                        for(const auto &p : config.getProperties())
-                            node->program()->setUniformFromProperty(p.first, p.second);
+                        node->program()->setUniformBlock("PassConstants", PASS_CONSTANTS_BINDING);
+                        node->program()->setUniforms(passProperties);
+                        node->program()->setUniforms(configProperties);
 
                         {
                             std::shared_lock<std::shared_timed_mutex> lock(_cameraLock);
-                            node->render(_camera, glm::ivec2(width, height), config);
+                            node->render(_camera, glm::ivec2(width, height), config, &culled);
                         }
                     }
                 }
@@ -702,22 +736,22 @@ void RenderPass::render(const RenderConfig &config)
                     node->init();
                     {
                         GLObjectBinder<ShaderProgram*> binder(node->program());
-                        for(const auto &p : getProperties())
-                            node->program()->setUniformFromProperty(p.first, p.second);
-
-                        for(const auto &p : config.getProperties())
-                            node->program()->setUniformFromProperty(p.first, p.second);
+                        node->program()->setUniformBlock("PassConstants", PASS_CONSTANTS_BINDING);
+                        node->program()->setUniforms(passProperties);
+                        node->program()->setUniforms(configProperties);
                         {
                             std::shared_lock<std::shared_timed_mutex> lock(_cameraLock);
-                            node->render(_camera, glm::ivec2(width, height), config);
+                            node->render(_camera, glm::ivec2(width, height), config, &culled);
                         }
                     }
                 }
             }
             for(auto cb : _postRenderCallbacks)
                 cb(this);
+            processPixelRequests();
+        }
+        else {
+            cancelPixelRequests();
         }
-        processPixelRequests();
     }
-    glFinish();
 }
@@ -7,6 +7,8 @@
 #include "shared_mutex"
 #include "vector"
 #include "queue"
+#include "future"
+#include "functional"
 #include "utility"
 
 #include "glwrapper.h"
@@ -67,6 +69,22 @@ public:
 
     CameraPtr getCamera();
 
+    typedef std::function<void(std::vector<glm::vec4>)> PixelCallback;
+
+    //reads a region of every named output, results are delivered once the
+    //gpu has written them, usually one frame after the request, ordered by
+    //name and then row by row. Passes that draw nothing deliver an empty
+    //result.
+    //Callbacks are invoked on the render thread.
+    void requestPixels(std::vector<std::string> names,
+                       glm::ivec2 pos,
+                       glm::ivec2 size,
+                       PixelCallback callback);
+    std::future<std::vector<glm::vec4>> requestPixels(std::vector<std::string> names,
+                                                      glm::ivec2 pos,
+                                                      glm::ivec2 size=glm::ivec2(1));
+
+    //blocks until the request is resolved
     std::vector<glm::vec4> readPixel(std::vector<std::string> name, glm::ivec2 pos);
 
     void setOverrideProgram(ResourceHandle<ShaderProgram> &&program);
@@ -91,12 +109,16 @@ public:
     void setEnabled(bool enable);
     bool isEnabled() const;
 
+    //uniform buffer binding point of the PassConstants block
+    static const GLuint PASS_CONSTANTS_BINDING = 0;
+
 private:
     void init();
     void render(const RenderConfig &config);
     void setDirty();
 
     void processPixelRequests();
+    glm::mat4 updatePassConstants(int width, int height);
     void addShaderNodeNoLock(std::shared_ptr<ShaderRenderNode> node);
     void addGeometryShaderNodeNoLock(std::shared_ptr<ShaderRenderNode> node);
     std::pair<bool, std::shared_ptr<ShaderRenderNode>>
@@ -105,11 +127,41 @@ private:
 
     std::string getTextureName(Texture2D *tex) const;
 
-    std::vector<glm::vec4> _requestedPixels;
-    std::queue<std::pair<std::string, glm::ivec2>> _pixelRequests;
-    std::condition_variable pixelRequestsCondition_;
+    struct PixelRequest
+    {
+        std::vector<std::string> names;
+        glm::ivec2 pos;
+        glm::ivec2 size;
+        PixelCallback callback;
+    };
+
+    //all requests of one frame read into a single pbo
+    struct PixelReadback
+    {
+        std::vector<PixelRequest> requests;
+        ResourceHandle<PBO> buffer;
+        ResourceHandle<Fence> fence;
+    };
+
+    void resolvePixelReadbacks();
+    void cancelPixelRequests();
+    GLenum getReadBuffer(const std::string &name) const;
+
+    std::vector<PixelRequest> _pixelRequests;
+    std::queue<PixelReadback> _pixelReadbacks;
+    std::vector<ResourceHandle<PBO>> _freePixelBuffers;
     std::mutex _pixelRequestsLock;
 
+    //std140 layout of the PassConstants uniform block
+    struct PassConstants
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::ivec2 resolution;
+        glm::ivec2 padding;
+    };
+    ResourceHandle<UBO> _passConstants;
+
     friend class RenderTree;
 
     std::atomic<bool> _initialized;
@@ -160,6 +212,8 @@ private:
     RenderTree *_tree;
 
     std::shared_ptr<Benchmark> _benchmark;
+    //its queries are deleted through the resource manager
+    ResourceHandle<GPUTimer> _gpuTimer;
 
     std::vector<std::function<void(RenderPass*)>> _postRenderCallbacks;
 
@@ -6,7 +6,8 @@
 #include "render.h"
 #include "renderpass.h"
 #include "shader_render_node.h"
-#include "benchmark.h"
+#include "data/benchmark.h"
+#include "culling.h"
 #include "rendertree.h"
 
 using namespace MindTree;
@@ -54,6 +55,7 @@ bool RenderConfig::flatShading() const
 
 std::atomic_bool RenderThread::_rendering{false};
 std::atomic_bool RenderThread::_update{false};
+std::atomic_int RenderThread::_scheduledFrames{0};
 std::mutex RenderThread::_renderingLock;
 std::condition_variable RenderThread::_renderNotifier;
 std::thread RenderThread::_renderThread;
@@ -86,25 +88,37 @@ bool RenderThread::isRendering()
 
 void RenderThread::updateOnce()
 {
-    _update = true;
-    _renderNotifier.notify_all();
-    _update = false;
+    scheduleFrame();
 }
 
+//the flags are changed under the lock, otherwise the render loop could
+//miss a notification between checking them and starting to wait
 void RenderThread::update()
 {
-    //noop if already updating
-    if(_update) return;
-
-    _update = true;
+    {
+        std::lock_guard<std::mutex> lock(_renderingLock);
+        //noop if already updating
+        if(_update) return;
+        _update = true;
+    }
     _renderNotifier.notify_all();
 }
 
 void RenderThread::pause()
 {
+    std::lock_guard<std::mutex> lock(_renderingLock);
     _update = false;
 }
 
+void RenderThread::scheduleFrame()
+{
+    {
+        std::lock_guard<std::mutex> lock(_renderingLock);
+        ++_scheduledFrames;
+    }
+    _renderNotifier.notify_all();
+}
+
 void RenderThread::start()
 {
     if(isRendering()) stop();
@@ -112,10 +126,17 @@ void RenderThread::start()
     _rendering = true;
 
     auto renderLoop = [] {
-        std::unique_lock<std::mutex> lock(_renderingLock, std::defer_lock);
         ContextBinder binder(_renderQueue[0]->_context, true);
         while(RenderThread::isRendering()) {
-            if(!_update) _renderNotifier.wait(lock);
+            {
+                std::unique_lock<std::mutex> lock(_renderingLock);
+                _renderNotifier.wait(lock, [] {
+                    return _update || _scheduledFrames || !RenderThread::isRendering();
+                });
+                if(_scheduledFrames > 0) --_scheduledFrames;
+            }
+            if(!RenderThread::isRendering()) break;
+
             for(auto *manager : _renderQueue) {
                 manager->draw();
             }
@@ -129,8 +150,11 @@ void RenderThread::start()
 void RenderThread::stop()
 {
     std::cout << "stop rendering" << std::endl;
-    _rendering = false;
-    _update = false;
+    {
+        std::lock_guard<std::mutex> lock(_renderingLock);
+        _rendering = false;
+        _update = false;
+    }
     _renderNotifier.notify_all();
     if (_renderThread.joinable()) _renderThread.join();
 }
@@ -161,6 +185,16 @@ ResourceManager *RenderTree::getResourceManager()
     return _resourceManager.get();
 }
 
+void RenderTree::setSceneBVH(std::shared_ptr<const BVH> bvh)
+{
+    std::atomic_store(&_sceneBVH, bvh);
+}
+
+std::shared_ptr<const BVH> RenderTree::getSceneBVH() const
+{
+    return std::atomic_load(&_sceneBVH);
+}
+
 void RenderTree::setDirty()
 {
     _initialized = false;
@@ -288,8 +322,17 @@ void RenderTree::draw()
     glEnable(GL_PROGRAM_POINT_SIZE);
     glEnable(GL_POLYGON_OFFSET_POINT);
 
+    //cpu time of the whole frame including waiting for the gpu to catch
+    //up, the passes measure their gpu time
     BenchmarkHandler handler(_benchmark);
 
+    //only stall when the gpu falls behind by more than the allowed
+    //frames, otherwise this frame is prepared while the last ones execute
+    while(_frameFences.size() >= MAX_FRAMES_IN_FLIGHT) {
+        _frameFences.front()->wait();
+        _frameFences.pop();
+    }
+
     if(!_initialized) {
         init();
     }
@@ -307,5 +350,5 @@ void RenderTree::draw()
     glDisable(GL_POLYGON_OFFSET_POINT);
     _context->swapBuffers();
 
-    glFinish();
+    _frameFences.push(make_resource<Fence>(_resourceManager.get()));
 }
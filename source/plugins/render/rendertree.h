@@ -11,6 +11,7 @@
 #include "queue"
 #include "unordered_map"
 #include "../datatypes/Object/object.h"
+#include "resource_handling.h"
 
 class QGLContext;
 
@@ -20,6 +21,7 @@ namespace GL {
 
 class Texture;
 class RenderPass;
+class BVH;
 
 class RenderConfig : public Object
 {
@@ -52,6 +54,9 @@ public:
     static void updateOnce();
     static void pause();
 
+    //renders at least one more frame, even when paused
+    static void scheduleFrame();
+
 private:
     static void start();
     static void stop();
@@ -59,6 +64,7 @@ private:
 
     static std::atomic_bool _rendering;
     static std::atomic_bool _update;
+    static std::atomic_int _scheduledFrames;
     static std::condition_variable _renderNotifier;
     static std::mutex _renderingLock;
     static std::thread _renderThread;
@@ -89,6 +95,12 @@ public:
 
     ResourceManager *getResourceManager();
 
+    //bounding volumes of the current scene, passes cull against them
+    void setSceneBVH(std::shared_ptr<const BVH> bvh);
+    std::shared_ptr<const BVH> getSceneBVH() const;
+
+    //number of frames the cpu may submit before waiting for the gpu
+    static const uint MAX_FRAMES_IN_FLIGHT = 2;
 
 private:
     void init();
@@ -106,6 +118,9 @@ private:
     double renderTime;
 
     std::shared_ptr<Benchmark> _benchmark;
+    //deleted through the resource manager while a context is current
+    std::queue<ResourceHandle<Fence>> _frameFences;
+    std::shared_ptr<const BVH> _sceneBVH;
 };
 
 }
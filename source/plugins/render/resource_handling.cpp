@@ -38,6 +38,18 @@ const std::string Resource<VAO>::s_resource_name("VAO");
 template<>
 const std::string Resource<Renderbuffer>::s_resource_name("Renderbuffer");
 
+template<>
+const std::string Resource<UBO>::s_resource_name("UBO");
+
+template<>
+const std::string Resource<PBO>::s_resource_name("PBO");
+
+template<>
+const std::string Resource<Fence>::s_resource_name("Fence");
+
+template<>
+const std::string Resource<GPUTimer>::s_resource_name("GPUTimer");
+
 ResourceManager::ResourceManager() :
     shaderManager_(std::make_unique<ShaderManager>(this)),
     geometryCache_(std::make_unique<GeometryCache>(this))
@@ -106,7 +118,13 @@ void GeometryCache::uploadData(ObjectData *data, std::string name)
     auto vbo = createVBO(data, name);
 
     vbo->bind();
-    vbo->data(data->getProperty(name).getData<std::shared_ptr<VertexList>>());
+    if(data->getType() == ObjectData::MESH) {
+        auto *mesh = static_cast<MeshData*>(data);
+        vbo->data(mesh->getAttributeSpan<glm::vec3>(MeshData::getAttributeID(name)));
+    }
+    else {
+        vbo->data(data->getProperty(name).getData<std::shared_ptr<VertexList>>());
+    }
     vbo->setPointer();
 }
 
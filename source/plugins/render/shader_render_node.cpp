@@ -51,17 +51,20 @@ void ShaderRenderNode::addRenderer(Renderer *renderer)
     _initialized = false;
 }
 
-void ShaderRenderNode::render(CameraPtr camera, glm::ivec2 resolution, const RenderConfig &config)
+void ShaderRenderNode::render(CameraPtr camera,
+                              glm::ivec2 resolution,
+                              const RenderConfig &config,
+                              const CulledObjects *culled)
 {
     RenderThread::asrt();
     std::lock_guard<std::mutex> lock(_rendersLock);
     if(!_initialized || !_program) return;
 
-    {
-        UniformState us(_program, "resolution", resolution);
-        for(const auto &renderer : _renders) {
-            renderer->render(camera, config, _program);
-        }
+    _program->setUniform("resolution", resolution);
+    for(const auto &renderer : _renders) {
+        if(culled && culled->count(renderer->getCullingObject()))
+            continue;
+        renderer->render(camera, config, _program);
     }
 }
 
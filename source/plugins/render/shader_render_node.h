@@ -7,6 +7,7 @@
 #include "mutex"
 
 #include "../datatypes/Object/object.h"
+#include "culling.h"
 
 namespace MindTree
 {
@@ -23,7 +24,10 @@ public:
     ShaderRenderNode(ShaderProgram *program);
 
     void addRenderer(Renderer *renderer);
-    void render(CameraPtr camera, glm::ivec2 resolution, const RenderConfig &config);
+    void render(CameraPtr camera,
+                glm::ivec2 resolution,
+                const RenderConfig &config,
+                const CulledObjects *culled=nullptr);
     ShaderProgram* program();
     std::vector<Renderer*> renders();
     void setResourceManager(ResourceManager *manager);
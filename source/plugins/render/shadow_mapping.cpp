@@ -66,6 +66,15 @@ void ShadowMappingRenderBlock::addRendererFromObject(std::shared_ptr<GeoObject>
     }
 }
 
+void ShadowMappingRenderBlock::addRendererFromInstancer(std::shared_ptr<Instancer> obj)
+{
+    for(const auto &instanced : getInstancedObjects(obj)) {
+        auto data = instanced.object->getData();
+        if(data->getType() == ObjectData::MESH && data->hasProperty("polygon"))
+            _shadowNode->addRenderer(new PolygonRenderer(instanced.object, instanced.instances));
+    }
+}
+
 std::unordered_map<std::shared_ptr<Light>, RenderPass*> ShadowMappingRenderBlock::getShadowPasses() const
 {
     return _shadowPasses;
@@ -21,6 +21,7 @@ public:
 protected:
     virtual void addRendererFromLight(std::shared_ptr<Light> obj) override;
     void addRendererFromObject(std::shared_ptr<GeoObject> obj) override;
+    void addRendererFromInstancer(std::shared_ptr<Instancer> obj) override;
     virtual RenderPass* createShadowPass(std::shared_ptr<SpotLight> spot);
 
 private:
@@ -29,6 +29,7 @@
 
 #include "iostream"
 #include "ctime"
+#include "chrono"
 
 #include "math.h"
 
@@ -264,12 +265,10 @@ void Viewport::mousePressEvent(QMouseEvent *event)
     _renderConfigurator->setProperty("GL:camera:showcenter", true);
 
     lastpos = event->posF();
-    glm::vec4 center = _renderConfigurator->getPosition(pos);
-    dbout(glm::to_string(center));
-    if(center.a > 0) {
-        activeCamera->setCenter(center.xyz());
-        _renderConfigurator->setProperty("GL:camera:center", center.xyz());
-    }
+    //picked up by the following mouse events once the gpu wrote it,
+    //a new click replaces a pick that is still in flight
+    applyPendingCenter();
+    _pendingCenter = _renderConfigurator->requestPosition(pos);
 
     if(event->modifiers() & Qt::ControlModifier)
         zoom = true;
@@ -279,8 +278,27 @@ void Viewport::mousePressEvent(QMouseEvent *event)
         rotate = true;
 }
 
+void Viewport::applyPendingCenter()
+{
+    if(!_pendingCenter.valid()
+       || _pendingCenter.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    glm::vec4 center = _pendingCenter.get();
+    dbout(glm::to_string(center));
+    if(center.a > 0) {
+        activeCamera->setCenter(center.xyz());
+        _renderConfigurator->setProperty("GL:camera:center", center.xyz());
+    }
+}
+
 void Viewport::mouseReleaseEvent(QMouseEvent *event)
 {
+    //a click without a drag releases before the position was read back,
+    //the pick stays pending and the frame that reads it is still drawn
+    //after rendering pauses
+    applyPendingCenter();
+    if(_pendingCenter.valid()) MindTree::GL::RenderThread::scheduleFrame();
     rotate = false;
     pan = false;
     zoom = false;
@@ -312,6 +330,8 @@ void Viewport::mouseMoveEvent(QMouseEvent *event)
 
     auto viewportSize = glm::ivec2(width(), height());
 
+    applyPendingCenter();
+
     float xdist = lastpos.x()  - event->posF().x();
     float ydist = event->posF().y() - lastpos.y();
     if(rotate)
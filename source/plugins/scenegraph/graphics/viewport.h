@@ -24,6 +24,8 @@
 #include "QTimer"
 #include "QThread"
 
+#include "future"
+
 #include "source/plugins/datatypes/Object/object.h"
 #include "data/nodes/nodetype.h"
 #include "../../render/glwrapper.h"
@@ -92,6 +94,7 @@ protected:
     void panView(float xdist, float ydist);
     void zoomView(float xdist, float ydist);
     void mouseToWorld();
+    void applyPendingCenter();
     void drawFps();
 
 private:
@@ -109,6 +112,7 @@ private:
     QPointF lastpos;
     QPointF winClickPos;
     glm::vec3 mouseDistToObj;
+    std::future<glm::vec4> _pendingCenter;
     bool rotate, pan, zoom;
     bool selectionMode;
     bool _showGrid;
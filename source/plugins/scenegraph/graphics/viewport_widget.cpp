@@ -25,7 +25,7 @@
 #include "../../render/rendertree.h"
 #include "../../render/renderpass.h"
 #include "../../render/render.h"
-#include "../../render/benchmark.h"
+#include "data/benchmark.h"
 #include "data/debuglog.h"
 
 #include "viewport_widget.h"
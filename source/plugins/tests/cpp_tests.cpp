@@ -1,7 +1,16 @@
+#include "algorithm"
+#include "sstream"
+#include "thread"
 #include "mindtree_core.h"
 #include "../datatypes/Object/object.h"
 #include "../datatypes/Object/dcel.h"
+#include "../datatypes/Object/lights.h"
+#include "../datatypes/Object/scatter.h"
+#include "../datatypes/Object/subdivision.h"
 #include "data/cache_main.h"
+#include "data/output_cache.h"
+#include "data/benchmark.h"
+#include "data/profiler.h"
 #include "data/raytracing/ray.h"
 #include "data/io.h"
 
@@ -233,6 +242,811 @@ bool testDCEL()
     return true;
 }
 
+bool testParallelEvaluation()
+{
+    NodePtr addNode = NodeDataBase::createNode("Math.Add");
+    Project::instance()->getRootSpace()->addNode(addNode);
+
+    static const int SIZE = 8;
+    double expected = 0;
+    for(int i = 0; i < SIZE; ++i) {
+        NodePtr valueNode = NodeDataBase::createNode("Values.Float Value");
+        Project::instance()->getRootSpace()->addNode(valueNode);
+        valueNode->getInSockets()[0]->setProperty(double(i));
+        addNode->getInSockets().back()->setCntdSocket(valueNode->getOutSockets()[0]);
+        expected += i;
+    }
+
+    DataCache::setParallelEvaluation(true);
+    DataCache cache(addNode->getOutSockets()[0]);
+    DataCache::setParallelEvaluation(false);
+
+    double result = cache.getOutput().getData<double>();
+    if(result != expected) {
+        std::cout << result << " is supposed to be " << expected << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testMemoization()
+{
+    NodePtr first = NodeDataBase::createNode("Math.Add");
+    NodePtr second = NodeDataBase::createNode("Math.Add");
+    Project::instance()->getRootSpace()->addNode(first);
+    Project::instance()->getRootSpace()->addNode(second);
+
+    for(auto node : {first, second}) {
+        node->getInSockets()[0]->setProperty(2.0);
+        node->getInSockets()[1]->setProperty(3.0);
+    }
+
+    DataCache::clearMemoCache();
+    DataCache::setMemoizable(first->getType());
+    DataCache firstCache(first->getOutSockets()[0]);
+    DataCache secondCache(second->getOutSockets()[0]);
+    DataCache::setMemoizable(first->getType(), false);
+
+    auto stats = DataCache::getMemoStatistics();
+    if(stats.hits != 1 || stats.misses != 1) {
+        std::cout << "memo hits: " << stats.hits
+                  << " misses: " << stats.misses << std::endl;
+        return false;
+    }
+
+    double result = secondCache.getOutput().getData<double>();
+    if(result != 5.0) {
+        std::cout << result << " is supposed to be 5" << std::endl;
+        return false;
+    }
+
+    //results of another node type with the same key and inputs are a
+    //collision, not a hit
+    MemoCache memo;
+    MemoCache::Inputs inputs{Property(2.0)};
+    OutputCache::Outputs outputs{std::make_shared<Property>(5.0)};
+    memo.insert(1, MemoCache::Signature{1, 2}, inputs, outputs);
+    OutputCache::Outputs found;
+    if(memo.find(1, MemoCache::Signature{3, 2}, inputs, found)
+       || memo.getStatistics().collisions != 1
+       || !memo.find(1, MemoCache::Signature{1, 2}, inputs, found)) {
+        std::cout << "memo signature is not compared" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testPolygonBuffer()
+{
+    PolygonBuffer::registerConverters();
+
+    auto polys = std::make_shared<PolygonList>();
+    polys->push_back(Polygon{0, 1, 2, 3});
+    polys->push_back(Polygon{3, 2, 4});
+
+    auto mesh = std::make_shared<MeshData>();
+    mesh->setProperty("polygon", std::make_shared<PolygonBuffer>(*polys));
+
+    auto buffer = mesh->getPolygonBuffer();
+    if(buffer->size() != 2 || buffer->getIndexCount() != 7) {
+        std::cout << "wrong buffer size: " << buffer->size()
+                  << " polygons, " << buffer->getIndexCount() << " indices" << std::endl;
+        return false;
+    }
+
+    if(buffer->triangulate() != std::vector<uint>{0, 1, 2, 0, 2, 3, 3, 2, 4}) {
+        std::cout << "wrong triangulation" << std::endl;
+        return false;
+    }
+
+    auto converted = mesh->getProperty("polygon").getData<PolygonListPtr>();
+    if(!converted || *converted != *polys) {
+        std::cout << "conversion to polygon list failed" << std::endl;
+        return false;
+    }
+    if(mesh->getPolygonCount() != 3) return false;
+
+    //lists are counted without converting them and converted on every
+    //call, changes made through the shared list are seen
+    auto listMesh = std::make_shared<MeshData>();
+    listMesh->setProperty("polygon", polys);
+    if(listMesh->getPolygonCount() != 3) return false;
+
+    polys->push_back(Polygon{0, 1, 2});
+    if(listMesh->getPolygonBuffer()->size() != 3) {
+        std::cout << "stale polygon list conversion" << std::endl;
+        return false;
+    }
+
+    //element wise writes go into the buffer, polygons past the end are
+    //appended after empty ones
+    Property column = std::make_shared<PolygonBuffer>(*polys);
+    Property::setItem(column, 1, Polygon{5, 6, 7});
+    Property::setItem(column, 0, Polygon{1, 2, 3});
+    Property::setItem(column, 2, Polygon{4, 5, 6, 7, 8});
+    Property::setItem(column, 4, Polygon{8, 9});
+    PolygonList expected{Polygon{1, 2, 3}, Polygon{5, 6, 7}, Polygon{4, 5, 6, 7, 8},
+                         Polygon(), Polygon{8, 9}};
+    if(column.getData<PolygonBufferPtr>()->toList() != expected) {
+        std::cout << "wrong polygons after setItem" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testPropertySharing()
+{
+    Property::resetCopyStatistics();
+
+    Property original{std::vector<double>(1000, 1.0)};
+    Property copy = original;
+    PropertyMap map;
+    map["values"] = copy;
+
+    if(Property::getCopyStatistics().copied != 0) {
+        std::cout << "copying a property duplicated its payload" << std::endl;
+        return false;
+    }
+
+    //writing to the copy must not change the original
+    copy.getDataRef<std::vector<double>>()[0] = 2.0;
+    if(Property::getCopyStatistics().copied != 1) {
+        std::cout << "mutable access did not detach the payload" << std::endl;
+        return false;
+    }
+
+    return original.getData<std::vector<double>>()[0] == 1.0
+        && map["values"].getData<std::vector<double>>()[0] == 1.0;
+}
+
+bool testAttributeColumns()
+{
+    auto mesh = std::make_shared<MeshData>();
+    auto points = std::make_shared<VertexList>(4);
+    auto polys = std::make_shared<PolygonList>();
+    polys->push_back(Polygon{0, 1, 2, 3});
+    mesh->setProperty("P", points);
+    mesh->setProperty("polygon", polys);
+    mesh->setProperty("weight", std::vector<double>{0.5});
+
+    auto weight = MeshData::getAttributeID("weight");
+    if(mesh->getAttributeDomain(weight) != MeshData::POLYGON_DOMAIN) {
+        std::cout << "weight is not a polygon attribute" << std::endl;
+        return false;
+    }
+
+    auto span = mesh->getAttributeSpan<double>(weight, MeshData::POLYGON_DOMAIN);
+    if(span.size() != 1 || span[0] != 0.5) {
+        std::cout << "wrong weight column" << std::endl;
+        return false;
+    }
+
+    //the point column is the stored list itself, not a copy
+    return mesh->getAttributeSpan<glm::vec3>(MeshData::POSITION).data() == points->data();
+}
+
+bool testConverterTable()
+{
+    //list types are interned, every call returns the same DataType
+    const DataType &listType = PropertyTypeInfo<std::vector<int>>::getType();
+    if(&listType != &PropertyTypeInfo<std::shared_ptr<std::vector<int>>>::getType()
+       || listType != "LIST:INTEGER") {
+        std::cout << "list type is not interned" << std::endl;
+        return false;
+    }
+
+    //the converters are global, whatever the test changes is undone
+    bool frozen = PropertyConverter::isFrozen();
+    ConverterFunctor previous = PropertyConverter::get("BOOLEAN", "STRING");
+    auto restore = [&] {
+        if(previous) PropertyConverter::registerConverter("BOOLEAN", "STRING", previous);
+        else PropertyConverter::unregisterConverter("BOOLEAN", "STRING");
+        if(!frozen) PropertyConverter::unfreeze();
+    };
+
+    //converters registered after the table was frozen are still found
+    PropertyConverter::freeze();
+    PropertyConverter::registerConverter("BOOLEAN", "STRING", [] (void *from, void *to) {
+        bool value = static_cast<PropertyData<bool>*>(from)->getData();
+        *static_cast<std::string*>(to) = value ? "test" : "";
+    });
+
+    Property prop(true);
+    bool found = PropertyConverter::isFrozen() && prop.getData<std::string>() == "test";
+    bool unknown = !PropertyConverter::find("BOOLEAN", "MAT4");
+    restore();
+
+    if(!found) {
+        std::cout << "converter registered after freeze is missing" << std::endl;
+        return false;
+    }
+
+    if(PropertyConverter::isFrozen() != frozen
+       || bool(PropertyConverter::find("BOOLEAN", "STRING")) != bool(previous)) {
+        std::cout << "converter state was not restored" << std::endl;
+        return false;
+    }
+
+    return unknown;
+}
+
+bool testEvaluationArena()
+{
+    {
+        EvaluationArena::Scope scope;
+        EvaluationArena *arena = EvaluationArena::current();
+        std::vector<double, ArenaAllocator<double>> values{ArenaAllocator<double>(arena)};
+        values.resize(1000, 1.);
+
+        if(!arena || arena->getBytesUsed() < 1000 * sizeof(double)) {
+            std::cout << "values were not allocated from the arena" << std::endl;
+            return false;
+        }
+
+        //loop iterations hand their memory back, the next one reuses it
+        size_t used = arena->getBytesUsed();
+        size_t reserved = 0;
+        for(int i = 0; i < 100; ++i) {
+            EvaluationArena::Rewind rewind;
+            std::vector<double, ArenaAllocator<double>> iteration{ArenaAllocator<double>(arena)};
+            iteration.resize(100000, 1.);
+            if(!i) reserved = arena->getBytesReserved();
+        }
+        if(arena->getBytesUsed() != used || arena->getBytesReserved() != reserved) {
+            std::cout << "iterations grew the arena to "
+                      << arena->getBytesReserved() << " bytes" << std::endl;
+            return false;
+        }
+    }
+
+    //everything was released when the scope closed
+    return !EvaluationArena::current();
+}
+
+bool testEvaluationProfiler()
+{
+    NodePtr valueNode = NodeDataBase::createNode("Values.Float Value");
+    NodePtr addNode = NodeDataBase::createNode("Math.Add");
+    Project::instance()->getRootSpace()->addNode(valueNode);
+    Project::instance()->getRootSpace()->addNode(addNode);
+    valueNode->getInSockets()[0]->setProperty(2.0);
+    addNode->getInSockets()[0]->setCntdSocket(valueNode->getOutSockets()[0]);
+
+    //ids wrap around and are reassigned when loading, nodes sharing one
+    //must still be profiled separately
+    valueNode->setID(addNode->getID());
+
+    EvaluationProfiler::setEnabled(true);
+    DataCache first(addNode->getOutSockets()[0]);
+    DataCache second(addNode->getOutSockets()[0]);
+    EvaluationProfiler::setEnabled(false);
+
+    for(const auto &entry : EvaluationProfiler::getStatistics()) {
+        if(entry.first != addNode->getUniqueID()) continue;
+
+        const auto &stats = entry.second;
+        if(stats.calls != 1 || stats.hits != 1 || stats.misses != 1
+           || stats.inclusiveTime < stats.selfTime
+           || stats.name != addNode->getNodeName()) {
+            std::cout << "calls: " << stats.calls << " hits: " << stats.hits
+                      << " misses: " << stats.misses << std::endl;
+            return false;
+        }
+
+        std::stringstream trace;
+        EvaluationProfiler::writeTrace(trace);
+        return trace.str().find(addNode->getNodeName()) != std::string::npos;
+    }
+
+    std::cout << "add node was not profiled" << std::endl;
+    return false;
+}
+
+bool testBenchmark()
+{
+    auto parent = std::make_shared<Benchmark>("parent");
+    auto child = std::make_shared<Benchmark>("child");
+    parent->addBenchmark(child);
+    child->setSampling(2);
+
+    for(int i = 0; i < 10; ++i)
+        BenchmarkHandler handler(child);
+
+    //the parent is never measured itself and reports its child
+    auto stats = parent->getStatistics();
+    if(stats.calls != 10 || child->getStatistics().samples != 5) {
+        std::cout << "calls: " << stats.calls
+                  << " samples: " << child->getStatistics().samples << std::endl;
+        return false;
+    }
+
+    return stats.total == child->getStatistics().total;
+}
+
+bool testParallelForeach()
+{
+    NodePtr array = NodeDataBase::createNode("General.Array");
+    NodePtr loop = NodeDataBase::createNode("General.Foreach");
+    Project::instance()->getRootSpace()->addNode(array);
+    Project::instance()->getRootSpace()->addNode(loop);
+
+    static const int SIZE = 64;
+    std::vector<double> expected;
+    for(int i = 0; i < SIZE; ++i) {
+        NodePtr valueNode = NodeDataBase::createNode("Values.Float Value");
+        Project::instance()->getRootSpace()->addNode(valueNode);
+        valueNode->getInSockets()[0]->setProperty(double(i));
+        array->getInSockets().back()->setCntdSocket(valueNode->getOutSockets()[0]);
+        expected.push_back(i + 1.);
+    }
+    loop->getInSockets()[0]->setCntdSocket(array->getOutSockets()[0]);
+
+    auto *space = loop->getDerived<ContainerNode>()->getContainerData();
+    NodePtr add = NodeDataBase::createNode("Math.Add");
+    space->addNode(add);
+    auto inner = space->getNodes();
+    add->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    add->getInSockets()[1]->setProperty(1.0);
+    inner[2]->getInSockets()[0]->setCntdSocket(add->getOutSockets()[0]);
+
+    //every element has to see its own item, serial and parallel
+    for(bool parallel : {false, true}) {
+        DataCache::invalidate(array.get());
+        DataCache::setParallelEvaluation(parallel);
+        DataCache cache(loop->getOutSockets()[0]);
+        DataCache::setParallelEvaluation(false);
+
+        auto result = cache.getOutput().getData<std::vector<double>>();
+        if(result != expected) {
+            std::cout << "wrong " << (parallel ? "parallel" : "serial")
+                      << " foreach result with " << result.size()
+                      << " elements" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testForLoopInvariants()
+{
+    NodePtr loop = NodeDataBase::createNode("General.For");
+    Project::instance()->getRootSpace()->addNode(loop);
+    loop->getInSockets()[0]->setProperty(0);
+    loop->getInSockets()[1]->setProperty(100);
+    loop->getInSockets()[2]->setProperty(1);
+
+    //sum += 2 + 3, the inner add doesn't depend on the iteration
+    auto *space = loop->getDerived<ContainerNode>()->getContainerData();
+    NodePtr invariant = NodeDataBase::createNode("Math.Add");
+    NodePtr sum = NodeDataBase::createNode("Math.Add");
+    space->addNode(invariant);
+    space->addNode(sum);
+    invariant->getInSockets()[0]->setProperty(2);
+    invariant->getInSockets()[1]->setProperty(3);
+
+    auto inner = space->getNodes();
+    sum->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    sum->getInSockets()[1]->setCntdSocket(invariant->getOutSockets()[0]);
+    inner[2]->getInSockets()[0]->setCntdSocket(sum->getOutSockets()[0]);
+    loop->getInSockets()[3]->setProperty(1);
+
+    EvaluationProfiler::reset();
+    EvaluationProfiler::setEnabled(true);
+    DataCache cache(loop->getOutSockets()[0]);
+    EvaluationProfiler::setEnabled(false);
+
+    int result = cache.getOutput().getData<int>();
+    if(result != 501) {
+        std::cout << "wrong for loop result: " << result << std::endl;
+        return false;
+    }
+
+    //the invariant add is computed once, the sum in every iteration
+    auto statistics = EvaluationProfiler::getStatistics();
+    for(const auto &expected : {std::make_pair(invariant, 1), std::make_pair(sum, 100)}) {
+        auto id = expected.first->getUniqueID();
+        auto it = std::find_if(begin(statistics), end(statistics),
+                               [id] (const std::pair<EvaluationProfiler::NodeID,
+                                                     EvaluationProfiler::NodeStatistics> &entry) {
+            return entry.first == id;
+        });
+        if(it == statistics.end()) {
+            std::cout << expected.first->getNodeName() << " was not profiled" << std::endl;
+            return false;
+        }
+        if(it->second.misses != uint64_t(expected.second)) {
+            std::cout << it->second.name << " evaluated "
+                      << it->second.misses << " times" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testWhileLoop()
+{
+    NodePtr loop = NodeDataBase::createNode("General.While");
+    Project::instance()->getRootSpace()->addNode(loop);
+
+    //x += x while x < 100
+    auto *space = loop->getDerived<ContainerNode>()->getContainerData();
+    NodePtr add = NodeDataBase::createNode("Math.Add");
+    NodePtr condition = NodeDataBase::createNode("Condition.Less Than");
+    space->addNode(add);
+    space->addNode(condition);
+
+    auto inner = space->getNodes();
+    add->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    add->getInSockets()[1]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    inner[2]->getInSockets()[1]->setCntdSocket(add->getOutSockets()[0]);
+    condition->getInSockets()[0]->setCntdSocket(inner[1]->getOutSockets()[0]);
+    condition->getInSockets()[1]->setProperty(100.);
+    inner[2]->getInSockets()[0]->setCntdSocket(condition->getOutSockets()[0]);
+    loop->getInSockets()[1]->setProperty(1.);
+
+    //stops once the condition fails, or after max iterations
+    for(auto expected : {std::make_pair(1000, 128.), std::make_pair(3, 8.)}) {
+        loop->getInSockets()[0]->setProperty(expected.first);
+        DataCache::invalidate(loop.get());
+        DataCache cache(loop->getOutSockets()[0]);
+        double result = cache.getOutput().getData<double>();
+        if(result != expected.second) {
+            std::cout << "wrong while loop result: " << result << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testInstancer()
+{
+    auto prototype = std::make_shared<GeoObject>();
+    auto transformations = std::make_shared<Instancer::TransformationList>();
+    for(int i = 0; i < 3; ++i) {
+        glm::mat4 trans;
+        trans[3] = glm::vec4(i, 0, 0, 1);
+        transformations->push_back(trans);
+    }
+
+    auto instancer = std::make_shared<Instancer>(prototype, transformations);
+    if(!Instancer::canInstance(prototype)
+       || Instancer::canInstance(std::make_shared<PointLight>(1., glm::vec4(1)))) {
+        std::cout << "wrong instancing support" << std::endl;
+        return false;
+    }
+
+    //instances share the prototype, expanding creates real copies
+    auto copies = instancer->expand();
+    if(instancer->getInstanceCount() != 3 || copies.size() != 3) return false;
+    if(copies[0] == prototype) return false;
+    return copies[2]->getPosition() == glm::vec3(2, 0, 0);
+}
+
+bool testMeshBounds()
+{
+    auto mesh = std::make_shared<MeshData>();
+    mesh->setProperty("P", std::make_shared<VertexList>(VertexList{glm::vec3(0, -1, 0),
+                                                                   glm::vec3(1, 2, 3)}));
+    auto bounds = mesh->getBounds();
+    if(bounds.min != glm::vec3(0, -1, 0) || bounds.max != glm::vec3(1, 2, 3)) {
+        std::cout << "wrong mesh bounds" << std::endl;
+        return false;
+    }
+
+    //the cached bounds are dropped with the attributes
+    mesh->setProperty("P", std::make_shared<VertexList>(VertexList{glm::vec3(-2, 0, 0)}));
+    bounds = mesh->getBounds();
+    if(bounds.min != glm::vec3(-2, 0, 0) || bounds.max != glm::vec3(-2, 0, 0)) {
+        std::cout << "mesh bounds were not updated" << std::endl;
+        return false;
+    }
+
+    //a list grown in place after it was set is noticed by its size
+    auto points = std::make_shared<VertexList>(VertexList{glm::vec3(0)});
+    mesh->setProperty("P", points);
+    mesh->getBounds();
+    points->push_back(glm::vec3(-2, 0, 0));
+    bounds = mesh->getBounds();
+    if(bounds.min != glm::vec3(-2, 0, 0) || bounds.max != glm::vec3(0)) {
+        std::cout << "mesh bounds went stale" << std::endl;
+        return false;
+    }
+
+    glm::mat4 translation;
+    translation[3] = glm::vec4(2, 0, 0, 1);
+    auto moved = bounds.transformed(translation);
+    return moved.min == glm::vec3(0) && !moved.isEmpty() && AABB().isEmpty();
+}
+
+bool testOutputCacheConcurrency()
+{
+    //the cache never dereferences its keys, any distinct address will do
+    static const int NODES = 256;
+    static const int ROUNDS = 200;
+    std::vector<char> keys(NODES * 16);
+    auto key = [&keys] (int i) { return reinterpret_cast<const DNode*>(&keys[i * 16]); };
+
+    OutputCache cache;
+    std::atomic<bool> torn(false);
+
+    //writers bump the generation of their nodes, readers check that the
+    //entry they see belongs to the node they asked for
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for(int round = 1; round <= ROUNDS; ++round)
+                for(int i = t; i < NODES; i += 4)
+                    cache.set(key(i), 0, std::make_shared<Property>(double(round * NODES + i)), round);
+        });
+        threads.emplace_back([&] {
+            for(int round = 0; round < ROUNDS; ++round)
+                for(int i = 0; i < NODES; ++i) {
+                    auto entry = cache.get(key(i));
+                    if(!entry.outputs) continue;
+                    int value = entry.outputs->at(0)->getData<double>();
+                    if(entry.outputs->size() != 1
+                       || value % NODES != i
+                       || uint64_t(value / NODES) != entry.generation)
+                        torn = true;
+                }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    if(torn) {
+        std::cout << "read an inconsistent cache entry" << std::endl;
+        return false;
+    }
+
+    for(int i = 0; i < NODES; ++i) {
+        auto entry = cache.get(key(i));
+        if(entry.generation != ROUNDS
+           || entry.outputs->at(0)->getData<double>() != ROUNDS * NODES + i) {
+            std::cout << "lost the last write to node " << i << std::endl;
+            return false;
+        }
+    }
+
+    auto stats = cache.getStatistics();
+    if(stats.writes != uint64_t(NODES * ROUNDS)
+       || stats.reads != uint64_t(4 * NODES * ROUNDS + NODES)) {
+        std::cout << "wrong statistics: " << stats.reads << " reads, "
+                  << stats.writes << " writes" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//the cube from -1 to 1, polygons are oriented outwards
+MeshDataPtr createCube()
+{
+    auto mesh = std::make_shared<MeshData>();
+    auto verts = std::make_shared<VertexList>();
+    for(int i = 0; i < 8; ++i)
+        verts->push_back(glm::vec3(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1));
+    mesh->setProperty("P", verts);
+    mesh->setProperty("polygon", std::make_shared<PolygonList>(PolygonList{Polygon({0, 2, 3, 1}),
+                                                                           Polygon({4, 5, 7, 6}),
+                                                                           Polygon({0, 1, 5, 4}),
+                                                                           Polygon({1, 3, 7, 5}),
+                                                                           Polygon({3, 2, 6, 7}),
+                                                                           Polygon({2, 0, 4, 6})}));
+    return mesh;
+}
+
+bool testScatterSurface()
+{
+    auto cube = createCube();
+    glm::mat4 translation;
+    translation[3] = glm::vec4(0, 0, 5, 1);
+
+    scatter::Options options;
+    options.count = 6000;
+    options.seed = 7;
+    auto points = scatter::scatterSurface(*cube, translation, options);
+    if(points->size() != options.count) {
+        std::cout << "scattered " << points->size() << " points instead of "
+                  << options.count << std::endl;
+        return false;
+    }
+
+    //every point lies on one of the faces of the moved cube, the faces
+    //have the same area and get about the same share of the points
+    int top = 0;
+    for(const auto &point : *points) {
+        glm::vec3 local = point - glm::vec3(0, 0, 5);
+        float distance = std::max(std::abs(local.x), std::max(std::abs(local.y), std::abs(local.z)));
+        if(std::abs(distance - 1) > 1e-5) {
+            std::cout << "point is not on the surface" << std::endl;
+            return false;
+        }
+        if(local.z > 1 - 1e-5) ++top;
+    }
+    if(top < 800 || top > 1200) {
+        std::cout << top << " points on the top face" << std::endl;
+        return false;
+    }
+
+    //the same seed gives the same points
+    if(*scatter::scatterSurface(*cube, translation, options) != *points) {
+        std::cout << "scattering is not deterministic" << std::endl;
+        return false;
+    }
+
+    options.minDistance = .2;
+    auto spaced = scatter::scatterSurface(*cube, translation, options);
+    if(spaced->empty() || spaced->size() >= options.count) {
+        std::cout << "wrong number of spaced points: " << spaced->size() << std::endl;
+        return false;
+    }
+    for(size_t i = 0; i < spaced->size(); ++i)
+        for(size_t j = i + 1; j < spaced->size(); ++j)
+            if(glm::distance((*spaced)[i], (*spaced)[j]) < options.minDistance) {
+                std::cout << "spaced points are too close" << std::endl;
+                return false;
+            }
+
+    return true;
+}
+
+bool testCatmullClark()
+{
+    auto cube = createCube();
+    auto verts = cube->getProperty("P").getData<VertexListPtr>();
+
+    //8 vertices, 6 face points and 12 edge points, 4 quads per face
+    subdivision::Options options;
+    auto refined = subdivision::subdivide(cube, options);
+    auto points = refined->getProperty("P").getData<VertexListPtr>();
+    auto polygons = refined->getPolygonBuffer();
+    if(points->size() != 26 || polygons->size() != 24) {
+        std::cout << "one level: " << points->size() << " vertices, "
+                  << polygons->size() << " faces" << std::endl;
+        return false;
+    }
+    for(size_t i = 0; i < polygons->size(); ++i)
+        if(polygons->polygonSize(i) != 4) return false;
+
+    //the old vertices come first and are moved to (F + 2R + (n - 3)P) / n
+    for(size_t i = 0; i < verts->size(); ++i)
+        if(glm::distance((*points)[i], (*verts)[i] * (5.f / 9.f)) > 1e-5) {
+            std::cout << "wrong position for vertex " << i << std::endl;
+            return false;
+        }
+
+    options.iterations = 2;
+    refined = subdivision::subdivide(cube, options);
+    if(refined->getProperty("P").getData<VertexListPtr>()->size() != 98
+       || refined->getPolygonBuffer()->size() != 96) {
+        std::cout << "wrong size after two levels" << std::endl;
+        return false;
+    }
+
+    //a triangle becomes three quads
+    auto triangle = subdivision::catmullClark(VertexList{glm::vec3(0), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0)},
+                                              PolygonBuffer(PolygonList{Polygon({0, 1, 2})}));
+    return triangle.points->size() == 7
+        && triangle.polygons->size() == 3
+        && triangle.parentFaces == std::vector<uint32_t>(3, 0);
+}
+
+bool testAdaptiveSubdivision()
+{
+    //a flat 3x3 grid, only the center face is surrounded by regular
+    //vertices
+    auto grid = std::make_shared<MeshData>();
+    auto verts = std::make_shared<VertexList>();
+    auto polys = std::make_shared<PolygonList>();
+    for(uint y = 0; y < 4; ++y)
+        for(uint x = 0; x < 4; ++x)
+            verts->push_back(glm::vec3(x, y, 0));
+    for(uint y = 0; y < 3; ++y)
+        for(uint x = 0; x < 3; ++x)
+            polys->push_back(Polygon({y * 4 + x, y * 4 + x + 1, y * 4 + x + 5, y * 4 + x + 4}));
+    grid->setProperty("P", verts);
+    grid->setProperty("polygon", polys);
+
+    //8 refined faces with 4 quads each and the center face, which picks
+    //up the points of its 4 refined edges
+    subdivision::Options options;
+    options.adaptive = true;
+    auto refined = subdivision::subdivide(grid, options);
+    auto points = refined->getProperty("P").getData<VertexListPtr>();
+    auto polygons = refined->getPolygonBuffer();
+    if(points->size() != 16 + 8 + 24 || polygons->size() != 8 * 4 + 1) {
+        std::cout << "adaptive: " << points->size() << " vertices, "
+                  << polygons->size() << " faces" << std::endl;
+        return false;
+    }
+    int kept = 0;
+    for(size_t i = 0; i < polygons->size(); ++i)
+        kept += polygons->polygonSize(i) == 8;
+    if(kept != 1) {
+        std::cout << "the center face was not kept" << std::endl;
+        return false;
+    }
+
+    //every vertex of the cube is extraordinary
+    auto cube = createCube();
+    if(subdivision::subdivide(cube, options)->getPolygonBuffer()->size() != 24)
+        return false;
+
+    //limit positions of valence 3 vertices on a cube are
+    //(9P + 4 sum(e_i) + sum(f_i)) / 24, the corners end up at half
+    //their distance from the center
+    options.adaptive = false;
+    options.limitSurface = true;
+    auto limit = subdivision::subdivide(cube, options);
+    auto limitPoints = limit->getProperty("P").getData<VertexListPtr>();
+    auto normals = limit->getProperty("N").getData<VertexListPtr>();
+    auto corners = cube->getProperty("P").getData<VertexListPtr>();
+    for(size_t i = 0; i < corners->size(); ++i) {
+        glm::vec3 corner = (*corners)[i];
+        if(glm::distance((*limitPoints)[i], corner * .5f) > 1e-5
+           || std::abs(glm::dot((*normals)[i], glm::normalize(corner)) - 1) > 1e-4) {
+            std::cout << "wrong limit for corner " << i << std::endl;
+            return false;
+        }
+    }
+
+    //empty meshes have no normals to put on the limit surface
+    auto empty = std::make_shared<MeshData>();
+    empty->setProperty("P", std::make_shared<VertexList>());
+    empty->setProperty("polygon", std::make_shared<PolygonBuffer>());
+    return subdivision::subdivide(empty, options)->getVertexCount() == 0;
+}
+
+bool testInvalidation()
+{
+    //(a + 3) + b
+    NodePtr a = NodeDataBase::createNode("Values.Float Value");
+    NodePtr b = NodeDataBase::createNode("Values.Float Value");
+    NodePtr inner = NodeDataBase::createNode("Math.Add");
+    NodePtr outer = NodeDataBase::createNode("Math.Add");
+    for(auto node : {a, b, inner, outer})
+        Project::instance()->getRootSpace()->addNode(node);
+
+    a->getInSockets()[0]->setProperty(2.0);
+    b->getInSockets()[0]->setProperty(10.0);
+    inner->getInSockets()[0]->setCntdSocket(a->getOutSockets()[0]);
+    inner->getInSockets()[1]->setProperty(3.0);
+    outer->getInSockets()[0]->setCntdSocket(inner->getOutSockets()[0]);
+    outer->getInSockets()[1]->setCntdSocket(b->getOutSockets()[0]);
+
+    double result = DataCache(outer->getOutSockets()[0]).getOutput().getData<double>();
+    if(result != 15.0) {
+        std::cout << result << " is supposed to be 15" << std::endl;
+        return false;
+    }
+
+    //only the nodes downstream of the changed one go stale
+    a->getInSockets()[0]->setProperty(5.0);
+    DataCache::invalidate(a.get());
+    if(DataCache::isCached(a.get())
+       || DataCache::isCached(inner.get())
+       || DataCache::isCached(outer.get())
+       || !DataCache::isCached(b.get())) {
+        std::cout << "wrong nodes were invalidated" << std::endl;
+        return false;
+    }
+
+    result = DataCache(outer->getOutSockets()[0]).getOutput().getData<double>();
+    if(result != 18.0) {
+        std::cout << "stale result " << result << ", should be 18" << std::endl;
+        return false;
+    }
+
+    return DataCache::isCached(inner.get()) && DataCache::isCached(outer.get());
+}
+
 BOOST_PYTHON_MODULE(cpp_tests)
 {
     BPy::def("testSocketPropertiesCPP", testSocketProperties);    
@@ -244,4 +1058,23 @@ BOOST_PYTHON_MODULE(cpp_tests)
     BPy::def("testSaveLoadPropertiesCPP", testSaveLoadProperties);
     BPy::def("testCreateListCPP", testCreateList);
     BPy::def("testDCELCPP", testDCEL);
+    BPy::def("testParallelEvaluationCPP", testParallelEvaluation);
+    BPy::def("testMemoizationCPP", testMemoization);
+    BPy::def("testPolygonBufferCPP", testPolygonBuffer);
+    BPy::def("testPropertySharingCPP", testPropertySharing);
+    BPy::def("testAttributeColumnsCPP", testAttributeColumns);
+    BPy::def("testConverterTableCPP", testConverterTable);
+    BPy::def("testEvaluationArenaCPP", testEvaluationArena);
+    BPy::def("testEvaluationProfilerCPP", testEvaluationProfiler);
+    BPy::def("testBenchmarkCPP", testBenchmark);
+    BPy::def("testParallelForeachCPP", testParallelForeach);
+    BPy::def("testForLoopInvariantsCPP", testForLoopInvariants);
+    BPy::def("testWhileLoopCPP", testWhileLoop);
+    BPy::def("testInstancerCPP", testInstancer);
+    BPy::def("testMeshBoundsCPP", testMeshBounds);
+    BPy::def("testOutputCacheConcurrencyCPP", testOutputCacheConcurrency);
+    BPy::def("testScatterSurfaceCPP", testScatterSurface);
+    BPy::def("testCatmullClarkCPP", testCatmullClark);
+    BPy::def("testAdaptiveSubdivisionCPP", testAdaptiveSubdivision);
+    BPy::def("testInvalidationCPP", testInvalidation);
 }
@@ -159,3 +159,30 @@ def testForeachLoopCache():
     test.equal(len(output), 10)
     test.equal(cache.getOutput(), [14.5] * 10) 
     return test.exit()
+
+def testCacheBudget():
+    '''Evicting cached outputs over budget and recomputing them on demand'''
+    add = MT.createNode("Math.Add")
+    valuenode = MT.createNode("Values.Float Value")
+    MT.project.root.addNode(add)
+    MT.project.root.addNode(valuenode)
+
+    valuenode.insockets[0].value = 4.
+    add.insockets[0].connected = valuenode.outsockets[0]
+    add.insockets[1].value = 3.
+
+    DataCache = MT.cache.DataCache
+    budget = DataCache.getCacheBudget()
+
+    test = TestCase()
+    test.equal(DataCache(add.outsockets[0]).getOutput(), 7.)
+    usage = [entry["node"] for entry in DataCache.getCacheUsage()]
+    test.contains(valuenode.name, usage)
+    test.contains(add.name, usage)
+
+    DataCache.setCacheBudget(1)
+    test.equal(DataCache.evictCache() > 0, True)
+    DataCache.setCacheBudget(budget)
+
+    test.equal(DataCache(add.outsockets[0]).getOutput(), 7.)
+    return test.exit()
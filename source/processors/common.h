@@ -9,10 +9,7 @@ std::shared_ptr<MeshData> createCylinder(unsigned sides, bool cap)
 {
     auto mesh = std::make_shared<MeshData>();
     auto verts = std::make_shared<VertexList>();
-    auto polys = std::make_shared<PolygonList>();
-
-    mesh->setProperty("P", verts);
-    mesh->setProperty("polygon", polys);
+    auto polys = std::make_shared<PolygonBuffer>();
 
     double pi = acos(-1);
 
@@ -28,19 +25,18 @@ std::shared_ptr<MeshData> createCylinder(unsigned sides, bool cap)
     if(cap) verts->emplace_back(0, 1, 0);
     if(cap) verts->emplace_back(0, 0, 0);
 
+    polys->reserve(cap ? 3 * sides : sides, cap ? 10 * sides : 4 * sides);
     for (unsigned int i = 0; i < sides; ++i) {
-        Polygon p{(i+1) % sides, i, sides + i, sides + ((i+1) % sides)};
-        polys->push_back(p);
+        polys->addPolygon({(i+1) % sides, i, sides + i, sides + ((i+1) % sides)});
 
         if(cap) {
-            Polygon p1{i, (i+1) % sides, 2*sides};
-            polys->push_back(p1);
-
-            Polygon p2{sides + ((i+1) % sides), sides + i, 2*sides + 1};
-            polys->push_back(p2);
+            polys->addPolygon({i, (i+1) % sides, 2*sides});
+            polys->addPolygon({sides + ((i+1) % sides), sides + i, 2*sides + 1});
         }
     }
 
+    mesh->setProperty("P", verts);
+    mesh->setProperty("polygon", polys);
     return mesh;
 }
 
@@ -24,11 +24,12 @@ void copy(DataCache* cache)
     if(use_normal && mesh->hasProperty("N"))
         normals = mesh->getProperty("N").getData<std::shared_ptr<VertexList>>();
 
-    auto empty = std::make_shared<Empty>();
+    auto transformations = std::make_shared<Instancer::TransformationList>();
+    transformations->reserve(points->size());
 
     int i{0};
     for(const auto &p : *points) {
-        auto copy = obj->clone();
+        auto trans = obj->getTransformation();
         if(normals) {
             auto n = glm::normalize((*normals)[i]);
             auto x = glm::cross(n, glm::normalize(upvector));
@@ -39,13 +40,26 @@ void copy(DataCache* cache)
                           glm::vec4(z, 0),
                           glm::vec4(0, 0, 0, 1));
 
-            copy->setTransformation(copy->getTransformation() * rot);
+            trans = trans * rot;
         }
-        copy->setPosition(p);
-        empty->addChild(copy);
+        trans[3] = glm::vec4(p, 1);
+        transformations->push_back(trans);
         ++i;
     }
 
+    //the copies share the object, its own transformation is part of
+    //every instance transformation
+    auto prototype = obj->clone();
+    prototype->setTransformation(glm::mat4());
+    auto instancer = std::make_shared<Instancer>(prototype, transformations);
+
+    if(Instancer::canInstance(obj)) {
+        cache->pushData(instancer);
+        return;
+    }
+
+    auto empty = std::make_shared<Empty>();
+    empty->addChildren(instancer->expand());
     cache->pushData(empty);
 }
 
@@ -13,7 +13,7 @@ void createdisc(DataCache* cache)
     double pi = std::acos(-1);
     auto mesh = std::make_shared<MeshData>();
     auto points = std::make_shared<VertexList>();
-    auto polys = std::make_shared<PolygonList>();
+    auto polys = std::make_shared<PolygonBuffer>();
     mesh->setProperty("P", points);
     mesh->setProperty("polygon", polys);
 
@@ -1,6 +1,4 @@
 #define GLM_SWIZZLE
-#include <unordered_map>
-
 #include "../plugins/datatypes/Object/object.h"
 #include "data/reloadable_plugin.h"
 
@@ -13,38 +11,37 @@ void filter(DataCache* cache)
     auto upper_limit = cache->getData(2).getData<double>();
     auto lower_limit = cache->getData(3).getData<double>();
 
-    if(input
-       && !input->hasProperty("P")
-       && !input->hasProperty("polygon")
-       &&!input->hasProperty(name))
-        return;
+    if(!input) return;
 
-    auto input_points = input->getProperty("P").getData<std::shared_ptr<VertexList>>();
-    auto input_polys = input->getProperty("polygon").getData<std::shared_ptr<PolygonList>>();
-    auto prop = input->getProperty(name).getData<std::vector<double>>();
-    if(prop.size() != input_polys->size()) {
+    //typed columns of the input, read in place
+    auto input_points = input->getAttributeSpan<glm::vec3>(MeshData::POSITION);
+    auto input_polys = input->getPolygonBuffer();
+    auto prop = input->getAttributeSpan<double>(MeshData::getAttributeID(name),
+                                                MeshData::POLYGON_DOMAIN);
+    if(!input_points || !input_polys || !prop) {
         cache->pushData(input);
         return;
     }
 
     auto points = std::make_shared<VertexList>();
-    auto polygons = std::make_shared<PolygonList>();
+    auto polygons = std::make_shared<PolygonBuffer>();
 
-    std::unordered_map<uint, uint> vertex_mapping;
+    const uint UNMAPPED = uint(-1);
+    std::vector<uint> vertex_mapping(input_points.size(), UNMAPPED);
+    std::vector<uint> poly;
 
     for(uint i = 0; i < input_polys->size(); ++i) {
         auto value = prop[i];
         if( value > lower_limit && value < upper_limit) {
-            Polygon poly;
-            const auto &old_poly = (*input_polys)[i];
-            for(int j = 0; j < old_poly.size(); ++j) {
-                if(vertex_mapping.find(old_poly[j]) == vertex_mapping.end()) {
-                    vertex_mapping[old_poly[j]] = points->size();
-                    points->push_back((*input_points)[old_poly[j]]);
+            poly.clear();
+            for(auto it = input_polys->polygonBegin(i); it != input_polys->polygonEnd(i); ++it) {
+                if(vertex_mapping[*it] == UNMAPPED) {
+                    vertex_mapping[*it] = points->size();
+                    points->push_back(input_points[*it]);
                 }
-                poly.push_back(vertex_mapping[old_poly[j]]);
+                poly.push_back(vertex_mapping[*it]);
             }
-            polygons->push_back(poly);
+            polygons->addPolygon(begin(poly), end(poly));
         }
     }
 
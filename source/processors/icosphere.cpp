@@ -9,7 +9,6 @@ void runIcosphere(DataCache* cache)
     auto mesh = std::make_shared<MeshData>();
     auto verts = std::make_shared<VertexList>();
     auto base_polys = PolygonList();
-    auto polys = std::make_shared<PolygonList>();
 
     verts->push_back(glm::normalize(glm::vec3(2, 1, 0)));
     verts->push_back(glm::normalize(glm::vec3(0, 2, 1)));
@@ -73,7 +72,10 @@ void runIcosphere(DataCache* cache)
         }
         base_polys = new_polys;
     }
-    *polys = base_polys;
+    auto polys = std::make_shared<PolygonBuffer>();
+    polys->reserve(base_polys.size(), 3 * base_polys.size());
+    for(const auto &p : base_polys)
+        polys->addPolygon(begin(p), end(p));
 
     mesh->setProperty("P", verts);
     mesh->setProperty("polygon", polys);
@@ -33,10 +33,8 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
 
     auto mesh = std::make_shared<MeshData>();
     auto points = std::make_shared<VertexList>();
-    auto polys = std::make_shared<PolygonList>();
+    auto polys = std::make_shared<PolygonBuffer>();
     PropertyMap attributes;
-    mesh->setProperty("P", points);
-    mesh->setProperty("polygon", polys);
 
     while(!stack.empty()) {
         auto *joint = stack.top();
@@ -83,7 +81,7 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
                         p.push_back(i);
                     }
                     inheritAttributes(&attributes, j, polys->size());
-                    polys->push_back(p);
+                    polys->addPolygon(begin(p), end(p));
                 }
 
                 for(int i = points->size() - sides; i < points->size(); i++) {
@@ -96,7 +94,7 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
                         Polygon p{ring[i].v1(), ring[i].v0(),
                                 lastring[i].v0(), lastring[i].v1()};
                         inheritAttributes(&attributes, j, polys->size());
-                        polys->push_back(p);
+                        polys->addPolygon(begin(p), end(p));
                     }
                 }
                 lastring = ring;
@@ -132,7 +130,7 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
             }
 
             inheritAttributes(&attributes, joint, polys->size());
-            polys->push_back(p);
+            polys->addPolygon(begin(p), end(p));
         }
     }
 
@@ -204,7 +202,7 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
                     }
 
                     inheritAttributes(&attributes, joints.first, polys->size());
-                    polys->push_back(poly);
+                    polys->addPolygon(begin(poly), end(poly));
                 }
                 else {
                     processed_edges.insert(edge_map.begin()->first);
@@ -230,6 +228,8 @@ std::shared_ptr<MeshData> meshJoint(JointPtr root, uint sides, bool merge_joints
         }
     }
        
+    mesh->setProperty("P", points);
+    mesh->setProperty("polygon", polys);
     for(const auto &p : attributes)
         mesh->setProperty(p.first, p.second);
 
@@ -248,7 +248,7 @@ std::shared_ptr<MeshData> meshJointsDCEL(JointPtr root)
 
     auto mesh = std::make_shared<MeshData>();
     auto points = std::make_shared<VertexList>();
-    auto polys = std::make_shared<PolygonList>();
+    auto polys = std::make_shared<PolygonBuffer>();
     mesh->setProperty("P", points);
     mesh->setProperty("polygon", polys);
     dcel::Adapter adapter(mesh);
@@ -326,6 +326,7 @@ CacheProcessorInfo load()
     CacheProcessorInfo info;
     info.socket_type = "OBJECTDATA";
     info.node_type = "MESHING";
+    DataCache::setMemoizable(NodeType(info.node_type));
     info.cache_proc = meshing;
     return info;
 }
@@ -8,7 +8,7 @@ void cylinder(DataCache* cache)
 {
     auto mesh = std::make_shared<MeshData>();
     auto verts = std::make_shared<VertexList>();
-    auto polys = std::make_shared<PolygonList>();
+    auto polys = std::make_shared<PolygonBuffer>();
 
     int sides = std::max(3, cache->getData(0).getData<int>());
     bool cap = cache->getData(1).getData<bool>();